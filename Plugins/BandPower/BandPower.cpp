@@ -0,0 +1,506 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BandPower.h"
+#include "BandPowerEditor.h"
+
+namespace
+{
+    /** Oversampling of the upper band edge after decimation*/
+    const float DECIMATED_OVERSAMPLING = 4.0f;
+
+    /** Maximum number of analyzed channels per stream (one TTL line each)*/
+    const int MAX_CHANNELS = 64;
+}
+
+BandPowerSettings::BandPowerSettings() :
+    outputStream(nullptr),
+    eventChannel(nullptr),
+    threshold(0.0f),
+    droppedSamples(0),
+    decimatedRate(0.0f),
+    lowCut(0.0f),
+    highCut(0.0f),
+    decimationFactor(1),
+    samplesInAccumulator(0),
+    windowLength(0),
+    hopLength(1),
+    samplesInWindow(0)
+{
+
+}
+
+void BandPowerSettings::prepare(float sampleRate, float lowCut_, float highCut_, float windowMs)
+{
+    const int numChannels = inputChannels.size();
+
+    lowCut = lowCut_;
+    highCut = highCut_;
+
+    decimationFactor = jmax(1, int(sampleRate / (DECIMATED_OVERSAMPLING * highCut)));
+    decimatedRate = sampleRate / decimationFactor;
+
+    windowLength = jmax(16, roundToInt(decimatedRate * windowMs / 1000.0f));
+    hopLength = jmax(1, windowLength / 4);
+
+    // segments of half the window, overlapping by 50%
+    int segmentLength = 8;
+
+    while (segmentLength * 2 <= windowLength / 2)
+        segmentLength *= 2;
+
+    // room for two windows of backlog before samples are dropped
+    fifo = std::make_unique<AbstractFifo>(2 * windowLength + hopLength);
+    fifoBuffer.setSize(jmax(1, numChannels), fifo->getTotalSize());
+    window.setSize(jmax(1, numChannels), windowLength);
+    accumulator.calloc(jmax(1, numChannels));
+
+    estimators.clear();
+
+    for (int i = 0; i < numChannels; i++)
+    {
+        estimators.add(new Dsp::Welch());
+        estimators.getLast()->setup(segmentLength, 0.5f);
+    }
+
+    bandPower.reset(new std::atomic<float>[jmax(1, numChannels)]);
+
+    isAboveThreshold.clearQuick();
+    isAboveThreshold.insertMultiple(0, false, numChannels);
+
+    reset();
+}
+
+void BandPowerSettings::reset()
+{
+    if (fifo != nullptr)
+        fifo->reset();
+
+    fifoBuffer.clear();
+    window.clear();
+
+    samplesInAccumulator = 0;
+    samplesInWindow = 0;
+    droppedSamples = 0;
+
+    for (int i = 0; i < inputChannels.size(); i++)
+    {
+        accumulator[i] = 0.0f;
+        bandPower[i].store(0.0f);
+        isAboveThreshold.set(i, false);
+    }
+}
+
+void BandPowerSettings::pushSamples(const AudioBuffer<float>& buffer, int numSamples)
+{
+    const int numChannels = inputChannels.size();
+
+    if (numChannels == 0 || fifo == nullptr)
+        return;
+
+    const int numOutputs = (samplesInAccumulator + numSamples) / decimationFactor;
+
+    int start1, size1, start2, size2;
+    fifo->prepareToWrite(numOutputs, start1, size1, start2, size2);
+
+    if (size1 + size2 < numOutputs)
+        droppedSamples += numOutputs - (size1 + size2);
+
+    const float scale = 1.0f / decimationFactor;
+
+    for (int c = 0; c < numChannels; c++)
+    {
+        const float* input = buffer.getReadPointer(inputChannels.getUnchecked(c));
+        float* first = fifoBuffer.getWritePointer(c, start1);
+        float* second = fifoBuffer.getWritePointer(c, start2);
+
+        float sum = accumulator[c];
+        int count = samplesInAccumulator;
+        int output = 0;
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            sum += input[i];
+
+            if (++count == decimationFactor)
+            {
+                if (output < size1)
+                    first[output] = sum * scale;
+                else if (output < size1 + size2)
+                    second[output - size1] = sum * scale;
+
+                output++;
+                sum = 0.0f;
+                count = 0;
+            }
+        }
+
+        accumulator[c] = sum;
+    }
+
+    samplesInAccumulator = (samplesInAccumulator + numSamples) % decimationFactor;
+
+    fifo->finishedWrite(size1 + size2);
+}
+
+bool BandPowerSettings::readHop()
+{
+    if (inputChannels.size() == 0 || fifo == nullptr)
+        return false;
+
+    const int numReady = fifo->getNumReady();
+
+    if (numReady < hopLength)
+        return false;
+
+    // skip stale hops, so the analysis never lags by more than one window
+    const int numStale = jmax(0, numReady - windowLength) / hopLength * hopLength;
+
+    if (numStale > 0)
+        fifo->finishedRead(numStale);
+
+    int start1, size1, start2, size2;
+    fifo->prepareToRead(hopLength, start1, size1, start2, size2);
+
+    const int numToKeep = windowLength - hopLength;
+
+    for (int c = 0; c < inputChannels.size(); c++)
+    {
+        float* data = window.getWritePointer(c);
+
+        memmove(data, data + hopLength, numToKeep * sizeof(float));
+
+        FloatVectorOperations::copy(data + numToKeep, fifoBuffer.getReadPointer(c, start1), size1);
+
+        if (size2 > 0)
+            FloatVectorOperations::copy(data + numToKeep + size1, fifoBuffer.getReadPointer(c, start2), size2);
+    }
+
+    fifo->finishedRead(size1 + size2);
+
+    samplesInWindow = jmin(windowLength, samplesInWindow + hopLength);
+
+    return true;
+}
+
+void BandPowerSettings::computeBandPower(int firstChannel, int lastChannel)
+{
+    for (int c = firstChannel; c < lastChannel; c++)
+    {
+        const float* data = window.getReadPointer(c, windowLength - samplesInWindow);
+
+        bandPower[c].store(estimators[c]->bandPower(data, samplesInWindow, decimatedRate, lowCut, highCut));
+    }
+}
+
+
+BandPower::BandPower()
+    : GenericProcessor("Band Power"),
+      Thread("Band Power"),
+      workerPool(jlimit(1, 4, SystemStats::getNumCpus() - 1)),
+      pendingJobs(0)
+{
+
+    addFloatParameter(Parameter::STREAM_SCOPE, "low_cut", "Lower edge of the frequency band (Hz)", 4, 0.1, 10000, 0.1, true);
+    addFloatParameter(Parameter::STREAM_SCOPE, "high_cut", "Upper edge of the frequency band (Hz)", 12, 0.1, 10000, 0.1, true);
+    addFloatParameter(Parameter::STREAM_SCOPE, "window_ms", "Length of the analysis window (ms)", 1000, 50, 10000, 10, true);
+    addFloatParameter(Parameter::STREAM_SCOPE, "threshold", "Band power threshold for TTL events (input units squared)", 100, 0, 1e9, 1);
+    addSelectedChannelsParameter(Parameter::STREAM_SCOPE, "Channels", "Channels to analyze for this stream", MAX_CHANNELS, true);
+
+}
+
+BandPower::~BandPower()
+{
+    stopThread(1000);
+}
+
+AudioProcessorEditor* BandPower::createEditor()
+{
+    editor = std::make_unique<BandPowerEditor> (this);
+
+    return editor.get();
+}
+
+void BandPower::updateSettings()
+{
+    // remove the streams and channels created during the previous update
+    for (int i = continuousChannels.size() - 1; i >= 0; i--)
+    {
+        if (continuousChannels[i]->isLocal())
+            continuousChannels.remove(i);
+    }
+
+    for (int i = eventChannels.size() - 1; i >= 0; i--)
+    {
+        if (eventChannels[i]->isLocal())
+            eventChannels.remove(i);
+    }
+
+    for (int i = dataStreams.size() - 1; i >= 0; i--)
+    {
+        if (dataStreams[i]->isLocal())
+            dataStreams.remove(i);
+    }
+
+    settings.update(getDataStreams());
+
+    inputStreamIds.clear();
+
+    for (auto stream : getDataStreams())
+    {
+        const uint16 streamId = stream->getStreamId();
+        BandPowerSettings* module = settings[streamId];
+
+        inputStreamIds.add(streamId);
+
+        module->inputChannels.clear();
+        module->outputChannels.clear();
+        module->outputStream = nullptr;
+        module->threshold = (*stream)["threshold"];
+
+        Array<var>* selectedChannels = (*stream)["Channels"].getArray();
+
+        if (selectedChannels->size() > 0)
+        {
+            DataStream::Settings streamSettings{
+                stream->getName() + "-power",
+                "Band power of the selected channels",
+                "dataderived.bandpower",
+                stream->getSampleRate()
+            };
+
+            dataStreams.add(new DataStream(streamSettings));
+            dataStreams.getLast()->addProcessor(processorInfo.get());
+            module->outputStream = dataStreams.getLast();
+
+            for (int i = 0; i < selectedChannels->size(); i++)
+            {
+                int localIndex = (*selectedChannels)[i];
+                const ContinuousChannel* input = stream->getContinuousChannels()[localIndex];
+
+                module->inputChannels.add(input->getGlobalIndex());
+
+                ContinuousChannel::Settings channelSettings{
+                    ContinuousChannel::Type::AUX,
+                    input->getName() + "-power",
+                    "Power in the selected frequency band",
+                    "dataderived.bandpower",
+                    1.0f,
+                    module->outputStream
+                };
+
+                continuousChannels.add(new ContinuousChannel(channelSettings));
+                continuousChannels.getLast()->addProcessor(processorInfo.get());
+                continuousChannels.getLast()->setUnits(input->getUnits() + "^2");
+
+                module->outputChannels.add(continuousChannels.size() - 1);
+            }
+
+            // update() has already added parameters to the input streams
+            addStreamParameters(module->outputStream);
+        }
+
+        EventChannel::Settings eventSettings{
+            EventChannel::Type::TTL,
+            "Band power threshold crossings",
+            "One line per analyzed channel, high while band power exceeds the threshold",
+            "dataderived.bandpower.threshold",
+            getDataStream(streamId),
+            MAX_CHANNELS
+        };
+
+        eventChannels.add(new EventChannel(eventSettings));
+        eventChannels.getLast()->addProcessor(processorInfo.get());
+        module->eventChannel = eventChannels.getLast();
+
+        prepareStream(stream);
+    }
+}
+
+void BandPower::prepareStream(const DataStream* stream)
+{
+    settings[stream->getStreamId()]->prepare(stream->getSampleRate(),
+                                             (*stream)["low_cut"],
+                                             (*stream)["high_cut"],
+                                             (*stream)["window_ms"]);
+}
+
+void BandPower::parameterValueChanged(Parameter* param)
+{
+    const uint16 streamId = param->getStreamId();
+    const DataStream* stream = getDataStream(streamId);
+
+    // band power streams carry the same parameters, but are not analyzed
+    if (settings[streamId] == nullptr)
+        return;
+
+    if (param->getName().equalsIgnoreCase("low_cut")
+        || param->getName().equalsIgnoreCase("high_cut"))
+    {
+        if ((float) (*stream)["low_cut"] >= (float) (*stream)["high_cut"])
+        {
+            param->restorePreviousValue();
+            return;
+        }
+
+        prepareStream(stream);
+    }
+    else if (param->getName().equalsIgnoreCase("window_ms"))
+    {
+        prepareStream(stream);
+    }
+    else if (param->getName().equalsIgnoreCase("threshold"))
+    {
+        settings[streamId]->threshold = (float) param->getValue();
+    }
+    else if (param->getName().equalsIgnoreCase("Channels"))
+    {
+        // adds or removes band power channels
+        CoreServices::updateSignalChain(getEditor());
+    }
+}
+
+bool BandPower::startAcquisition()
+{
+    for (auto streamId : inputStreamIds)
+        settings[streamId]->reset();
+
+    pendingJobs = 0;
+    jobsFinished.reset();
+
+    startThread();
+
+    return true;
+}
+
+bool BandPower::stopAcquisition()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(1000);
+
+    // prepare() frees the buffers that running jobs use, so they must finish first
+    workerPool.removeAllJobs(false, -1);
+
+    for (auto streamId : inputStreamIds)
+    {
+        BandPowerSettings* module = settings[streamId];
+
+        if (module->droppedSamples > 0)
+            LOGC("Band Power dropped ", module->droppedSamples.load(), " decimated samples on stream ", streamId);
+    }
+
+    return true;
+}
+
+void BandPower::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(100);
+
+        for (auto streamId : inputStreamIds)
+        {
+            BandPowerSettings* module = settings[streamId];
+
+            while (!threadShouldExit() && module->readHop())
+            {
+                const int numChannels = module->inputChannels.size();
+                const int numJobs = jmin(numChannels, workerPool.getNumThreads());
+
+                pendingJobs = numJobs;
+
+                for (int job = 0; job < numJobs; job++)
+                {
+                    const int firstChannel = job * numChannels / numJobs;
+                    const int lastChannel = (job + 1) * numChannels / numJobs;
+
+                    workerPool.addJob([this, module, firstChannel, lastChannel]
+                    {
+                        module->computeBandPower(firstChannel, lastChannel);
+
+                        if (--pendingJobs == 0)
+                            jobsFinished.signal();
+                    });
+                }
+
+                // a stuck job must not block stopAcquisition()
+                while (!jobsFinished.wait(100))
+                {
+                    if (threadShouldExit())
+                        return;
+                }
+            }
+        }
+    }
+}
+
+void BandPower::process(AudioBuffer<float>& buffer)
+{
+
+    for (auto streamId : inputStreamIds)
+    {
+        BandPowerSettings* module = settings[streamId];
+
+        if (module->outputStream == nullptr)
+            continue;
+
+        const int64 firstSampleInBlock = getFirstSampleNumberForBlock(streamId);
+        const int numSamples = getNumSamplesInBlock(streamId);
+
+        // the band power stream is sample-aligned with its input stream
+        setTimestampAndSamples(firstSampleInBlock,
+                               getFirstTimestampForBlock(streamId),
+                               numSamples,
+                               module->outputStream->getStreamId());
+
+        if ((*getDataStream(streamId))["enable_stream"])
+            module->pushSamples(buffer, numSamples);
+
+        for (int c = 0; c < module->outputChannels.size(); c++)
+        {
+            const float power = module->bandPower[c].load();
+
+            FloatVectorOperations::fill(buffer.getWritePointer(module->outputChannels.getUnchecked(c)),
+                                        power,
+                                        numSamples);
+
+            const bool isAbove = power > module->threshold;
+
+            if (isAbove != module->isAboveThreshold[c])
+            {
+                TTLEventPtr event = TTLEvent::createTTLEvent(module->eventChannel,
+                                                             firstSampleInBlock,
+                                                             c,
+                                                             isAbove);
+
+                addEvent(event, 0);
+
+                module->isAboveThreshold.set(c, isAbove);
+            }
+        }
+    }
+
+    notify();
+
+}
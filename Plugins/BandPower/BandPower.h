@@ -0,0 +1,174 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __BANDPOWER_H_8A0F63C1__
+#define __BANDPOWER_H_8A0F63C1__
+
+#include <ProcessorHeaders.h>
+
+#include <DspLib.h>
+
+#include <atomic>
+
+/** Holds settings and analysis state for one stream's band power*/
+
+class BandPowerSettings
+{
+public:
+
+    /** Constructor -- sets default values*/
+    BandPowerSettings();
+
+    /** Destructor*/
+    ~BandPowerSettings() { }
+
+    /** Allocates buffers and spectral estimators for the current channels (message thread)*/
+    void prepare(float sampleRate, float lowCut, float highCut, float windowMs);
+
+    /** Clears all buffered samples and results*/
+    void reset();
+
+    /** Decimates one block of the input channels into the FIFO (audio thread)*/
+    void pushSamples(const AudioBuffer<float>& buffer, int numSamples);
+
+    /** Moves the next hop of samples into the analysis window (worker thread).
+        Returns false if not enough samples are waiting.*/
+    bool readHop();
+
+    /** Computes band power for channels [firstChannel, lastChannel) (worker pool)*/
+    void computeBandPower(int firstChannel, int lastChannel);
+
+    /** Global indices of the analyzed channels*/
+    Array<int> inputChannels;
+
+    /** Global indices of the band power output channels*/
+    Array<int> outputChannels;
+
+    /** Stream holding the band power channels*/
+    DataStream* outputStream;
+
+    /** Channel for threshold-crossing events*/
+    EventChannel* eventChannel;
+
+    /** Threshold (in input units squared) for TTL events*/
+    float threshold;
+
+    /** Latest band power of each channel, published by the worker pool*/
+    std::unique_ptr<std::atomic<float>[]> bandPower;
+
+    /** Threshold state of each channel, as last seen by the audio thread*/
+    Array<bool> isAboveThreshold;
+
+    /** Number of input samples dropped because the worker fell behind*/
+    std::atomic<int64> droppedSamples;
+
+private:
+
+    float decimatedRate;
+    float lowCut;
+    float highCut;
+
+    int decimationFactor;
+    int samplesInAccumulator;
+    int windowLength;
+    int hopLength;
+    int samplesInWindow;
+
+    HeapBlock<float> accumulator;
+
+    std::unique_ptr<AbstractFifo> fifo;
+    AudioBuffer<float> fifoBuffer;
+
+    /** Most recent windowLength decimated samples of each channel, oldest first*/
+    AudioBuffer<float> window;
+
+    OwnedArray<Dsp::Welch> estimators;
+};
+
+/**
+    Estimates the power in a frequency band for a set of channels, 
+    using Welch's method on a sliding window.
+
+    Spectral estimates run on a pool of worker threads, so the audio
+    thread only decimates the input into a FIFO and publishes the most
+    recent results. If the workers fall behind, stale data are skipped,
+    which bounds the latency to one analysis window.
+
+    Band power is added to the signal chain as a new continuous stream 
+    (one channel per analyzed channel), and a TTL line per channel 
+    follows whether band power is above the threshold.
+
+    @see GenericProcessor, BandPowerEditor, Dsp::Welch
+*/
+class BandPower : public GenericProcessor,
+                  private Thread
+{
+public:
+
+    /** Constructor */
+    BandPower();
+
+    /** Destructor */
+    ~BandPower();
+
+    /** Creates the BandPowerEditor. */
+    AudioProcessorEditor* createEditor() override;
+
+    /** Publishes band power and threshold crossings for the current block */
+    void process(AudioBuffer<float>& buffer) override;
+
+    /** Creates the band power streams and event channels */
+    void updateSettings() override;
+
+    /** Called when a parameter is updated */
+    void parameterValueChanged(Parameter* param) override;
+
+    /** Starts the worker threads */
+    bool startAcquisition() override;
+
+    /** Stops the worker threads */
+    bool stopAcquisition() override;
+
+private:
+
+    /** Dispatches analysis windows to the worker pool */
+    void run() override;
+
+    /** Re-creates the analysis buffers for one input stream */
+    void prepareStream(const DataStream* stream);
+
+    /** Maps input stream IDs to their settings */
+    StreamSettings<BandPowerSettings> settings;
+
+    /** Input streams, in the order they were received */
+    Array<uint16> inputStreamIds;
+
+    ThreadPool workerPool;
+    WaitableEvent jobsFinished;
+    std::atomic<int> pendingJobs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BandPower);
+
+};
+
+#endif  // __BANDPOWER_H_8A0F63C1__
@@ -0,0 +1,255 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SpikeDensity.h"
+
+#include "SpikePlots.h"
+
+#include <cmath>
+
+namespace
+{
+    /** Time for the counts to fall to 1/e of their value*/
+    const float DECAY_TIME_S = 2.0f;
+
+    /** Time for the normalization peak to fall to 1/e of its value (slower than the counts,
+        so that decaying traces fade instead of being rescaled to full opacity)*/
+    const float PEAK_DECAY_TIME_S = 20.0f;
+
+    /** Counts below this are cleared, so that idle histograms cost nothing*/
+    const float MIN_COUNT = 0.05f;
+
+    /** Interval between updates of the histograms*/
+    const int UPDATE_INTERVAL_MS = 40;
+
+    /** Compression of the opacity curve (higher values emphasize rare traces)*/
+    const float OPACITY_COMPRESSION = 16.0f;
+}
+
+DensityHistogram::DensityHistogram(int width_, int height_) :
+    width(width_),
+    height(height_),
+    peakCount(0.0f),
+    isEmpty(true),
+    countsChanged(false),
+    imageChanged(false)
+{
+    counts.calloc(width * height);
+    colourIndices.calloc(width * height);
+
+    // logarithmic, so that single traces remain visible next to dense clusters
+    for (int i = 0; i < 256; i++)
+    {
+        const float level = float(i) / 255.0f;
+
+        opacity[i] = uint8(255.0f * std::log1p(OPACITY_COMPRESSION * level)
+                                   / std::log1p(OPACITY_COMPRESSION));
+    }
+
+    image = Image(Image::ARGB, width, height, true, SoftwareImageType());
+}
+
+void DensityHistogram::clear()
+{
+    FloatVectorOperations::clear(counts.getData(), width * height);
+
+    image.clear(image.getBounds());
+
+    peakCount = 0.0f;
+    isEmpty = true;
+    countsChanged = false;
+    imageChanged = true;
+}
+
+void DensityHistogram::addPoint(int x, int y, uint8 colourIndex)
+{
+    if (x < 0 || x >= width || y < 0 || y >= height)
+        return;
+
+    const int bin = y * width + x;
+
+    counts[bin] += 1.0f;
+    colourIndices[bin] = colourIndex;
+
+    isEmpty = false;
+    countsChanged = true;
+}
+
+void DensityHistogram::addSpan(int x, int y0, int y1, uint8 colourIndex)
+{
+    if (x < 0 || x >= width)
+        return;
+
+    if (y0 > y1)
+        std::swap(y0, y1);
+
+    y0 = jmax(y0, 0);
+    y1 = jmin(y1, height - 1);
+
+    for (int y = y0; y <= y1; y++)
+    {
+        const int bin = y * width + x;
+
+        counts[bin] += 1.0f;
+        colourIndices[bin] = colourIndex;
+    }
+
+    if (y0 <= y1)
+    {
+        isEmpty = false;
+        countsChanged = true;
+    }
+}
+
+void DensityHistogram::decay(float factor)
+{
+    if (isEmpty)
+        return;
+
+    FloatVectorOperations::multiply(counts.getData(), factor, width * height);
+
+    peakCount *= std::pow(factor, DECAY_TIME_S / PEAK_DECAY_TIME_S);
+
+    countsChanged = true;
+}
+
+void DensityHistogram::render(const Array<Colour>& palette)
+{
+    if (!countsChanged)
+        return;
+
+    countsChanged = false;
+    imageChanged = true;
+
+    const float maxCount = FloatVectorOperations::findMaximum(counts.getData(), width * height);
+
+    if (maxCount < MIN_COUNT)
+    {
+        clear();
+        return;
+    }
+
+    PixelARGB colours[256];
+    colours[0] = Colours::white.getPixelARGB();
+
+    for (int i = 1; i < 256; i++)
+        colours[i] = palette[(i - 1) % palette.size()].getPixelARGB();
+
+    // normalized against a slowly decaying peak, so that the image fades along with the counts
+    peakCount = jmax(peakCount, maxCount);
+
+    const float scale = 255.0f / peakCount;
+
+    Image::BitmapData bitmap(image, Image::BitmapData::writeOnly);
+
+    for (int y = 0; y < height; y++)
+    {
+        const float* row = counts + y * width;
+        const uint8* rowColours = colourIndices + y * width;
+        PixelARGB* pixel = reinterpret_cast<PixelARGB*>(bitmap.getLinePointer(y));
+
+        for (int x = 0; x < width; x++)
+        {
+            const int level = int(row[x] * scale);
+
+            if (level == 0)
+            {
+                pixel[x].setARGB(0, 0, 0, 0);
+                continue;
+            }
+
+            const PixelARGB& c = colours[rowColours[x]];
+            const uint8 alpha = opacity[level];
+
+            pixel[x].setARGB(alpha, c.getRed(), c.getGreen(), c.getBlue());
+            pixel[x].premultiply();
+        }
+    }
+}
+
+void DensityHistogram::draw(Graphics& g, Rectangle<float> destArea, Rectangle<int> sourceArea) const
+{
+    if (isEmpty)
+        return;
+
+    g.drawImage(image,
+                int(destArea.getX()), int(destArea.getY()), int(destArea.getWidth()), int(destArea.getHeight()),
+                sourceArea.getX(), sourceArea.getY(), sourceArea.getWidth(), sourceArea.getHeight());
+}
+
+bool DensityHistogram::checkForNewImage()
+{
+    const bool changed = imageChanged;
+    imageChanged = false;
+    return changed;
+}
+
+// --------------------------------------------------
+
+SpikeDensityRenderer::SpikeDensityRenderer() : Thread("Spike Density")
+{
+
+}
+
+SpikeDensityRenderer::~SpikeDensityRenderer()
+{
+    stopThread(1000);
+}
+
+void SpikeDensityRenderer::addPlot(SpikePlot* plot)
+{
+    const ScopedLock lock(plotLock);
+
+    plots.addIfNotAlreadyThere(plot);
+}
+
+void SpikeDensityRenderer::removePlot(SpikePlot* plot)
+{
+    const ScopedLock lock(plotLock);
+
+    plots.removeFirstMatchingValue(plot);
+}
+
+void SpikeDensityRenderer::run()
+{
+    double lastUpdate = Time::getMillisecondCounterHiRes();
+
+    while (!threadShouldExit())
+    {
+        wait(UPDATE_INTERVAL_MS);
+
+        const double now = Time::getMillisecondCounterHiRes();
+        const float decayFactor = std::exp(-float(now - lastUpdate) / 1000.0f / DECAY_TIME_S);
+        lastUpdate = now;
+
+        const ScopedLock lock(plotLock);
+
+        for (auto plot : plots)
+        {
+            if (threadShouldExit())
+                return;
+
+            plot->updateDensity(decayFactor);
+        }
+    }
+}
@@ -0,0 +1,143 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SPIKEDENSITY_H_
+#define SPIKEDENSITY_H_
+
+#include <VisualizerWindowHeaders.h>
+
+class SpikePlot;
+
+/**
+
+  Accumulates spikes into a 2-D histogram whose counts decay over time,
+  and renders it into an image that can simply be blitted on paint.
+
+  Each bin also remembers the colour (sorted unit) of the last spike that
+  reached it. None of the methods lock; callers hold getLock() while
+  adding, decaying, rendering or drawing.
+
+  @see SpikeDensityRenderer
+
+*/
+
+class DensityHistogram
+{
+public:
+
+    /** Constructor*/
+    DensityHistogram(int width, int height);
+
+    /** Destructor*/
+    ~DensityHistogram() { }
+
+    /** Removes all counts and empties the image*/
+    void clear();
+
+    /** Adds a count to a single bin (ignored if out of range)*/
+    void addPoint(int x, int y, uint8 colourIndex);
+
+    /** Adds a count to every bin of column x between rows y0 and y1 (inclusive)*/
+    void addSpan(int x, int y0, int y1, uint8 colourIndex);
+
+    /** Multiplies all counts by factor, and lowers the normalization peak more slowly*/
+    void decay(float factor);
+
+    /** Writes the histogram into the image. Colour index 0 is drawn in white,
+        index n in palette[n - 1]. Does nothing if the counts have not changed.*/
+    void render(const Array<Colour>& palette);
+
+    /** Draws the source area of the image (in bins) into the destination area*/
+    void draw(Graphics& g, Rectangle<float> destArea, Rectangle<int> sourceArea) const;
+
+    /** Returns true if the image changed since the last call*/
+    bool checkForNewImage();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    CriticalSection& getLock() { return lock; }
+
+private:
+
+    int width;
+    int height;
+
+    HeapBlock<float> counts;
+    HeapBlock<uint8> colourIndices;
+
+    /** Count that is drawn at full opacity; decays more slowly than the counts*/
+    float peakCount;
+
+    /** Maps the normalized count (0-255) to the opacity of a bin*/
+    uint8 opacity[256];
+
+    Image image;
+
+    bool isEmpty;
+    bool countsChanged;
+    bool imageChanged;
+
+    CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DensityHistogram);
+};
+
+/**
+
+  Worker thread that moves queued spikes into the density histograms of
+  every registered SpikePlot, applies the decay and renders the images,
+  so the message thread only has to blit them.
+
+  @see SpikePlot, DensityHistogram
+
+*/
+
+class SpikeDensityRenderer : public Thread
+{
+public:
+
+    /** Constructor*/
+    SpikeDensityRenderer();
+
+    /** Destructor*/
+    ~SpikeDensityRenderer();
+
+    /** Adds a plot to be updated*/
+    void addPlot(SpikePlot* plot);
+
+    /** Removes a plot (waits for the current update to finish)*/
+    void removePlot(SpikePlot* plot);
+
+    /** Updates all plots at a fixed interval*/
+    void run() override;
+
+private:
+
+    CriticalSection plotLock;
+    Array<SpikePlot*> plots;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpikeDensityRenderer);
+};
+
+#endif  // SPIKEDENSITY_H_
@@ -76,6 +76,8 @@ SpikeDisplayCanvas::SpikeDisplayCanvas(SpikeDisplayNode* processor_) :
 
     refreshRate = 10; // Hz
 
+    densityRenderer = std::make_unique<SpikeDensityRenderer>();
+
     viewport = std::make_unique<Viewport>();
     spikeDisplay = std::make_unique<SpikeDisplay>(this, viewport.get());
 
@@ -110,6 +112,13 @@ SpikeDisplayCanvas::SpikeDisplayCanvas(SpikeDisplayNode* processor_) :
     update();
 
     cache = std::make_unique<SpikeDisplayCache>();
+
+    densityRenderer->startThread();
+}
+
+SpikeDisplayCanvas::~SpikeDisplayCanvas()
+{
+    densityRenderer->stopThread(1000);
 }
 
 void SpikeDisplayCanvas::applyCachedDisplaySettings(int plotIdx, std::string key)
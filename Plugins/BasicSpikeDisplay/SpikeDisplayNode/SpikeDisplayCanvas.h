@@ -184,7 +184,7 @@ public:
     SpikeDisplayCanvas(SpikeDisplayNode* n);
 
     /** Destructor */
-    ~SpikeDisplayCanvas() { }
+    ~SpikeDisplayCanvas();
 
     /** Render black background */
     void paint(Graphics& g);
@@ -225,6 +225,9 @@ public:
     /** Manages connections from SpikeChannels to SpikePlots */
     std::unique_ptr<SpikeDisplayCache> cache;
 
+    /** Updates the density histograms of all plots (must outlive the plots)*/
+    std::unique_ptr<SpikeDensityRenderer> densityRenderer;
+
 private:
 
     std::unique_ptr<SpikeDisplay> spikeDisplay;
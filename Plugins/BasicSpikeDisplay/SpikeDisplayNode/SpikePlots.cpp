@@ -27,6 +27,25 @@
 #include "SpikeDisplayCanvas.h"
 #include "SpikeDisplayNode.h"
 
+namespace
+{
+    /** Size of the waveform density histograms (columns x rows)*/
+    const int WAVE_DENSITY_WIDTH = 128;
+    const int WAVE_DENSITY_HEIGHT = 128;
+
+    /** Size of the projection density histograms, and the amplitude covered by each bin*/
+    const int PROJECTION_DENSITY_BINS = 200;
+    const float PROJECTION_BIN_UV = 2.5f;
+
+    uint8 getColourIndex(const Spike* s)
+    {
+        if (s->getSortedId() > 0)
+            return uint8((s->getSortedId() - 1) % 8 + 1);
+
+        return 0;
+    }
+}
+
 SpikePlot::SpikePlot(SpikeDisplayCanvas* sdc, 
                      int elecNum, 
                      int p, 
@@ -35,6 +54,7 @@ SpikePlot::SpikePlot(SpikeDisplayCanvas* sdc,
     canvas(sdc), 
     electrodeNumber(elecNum),
     plotType(p),
+    spikesInBuffer(0),
     limitsChanged(true), 
     name(name_),
     identifier(identifier_)
@@ -93,11 +113,16 @@ SpikePlot::SpikePlot(SpikeDisplayCanvas* sdc,
     addAndMakeVisible(monitorButton.get());
 
     mostRecentSpikes.ensureStorageAllocated(bufferSize);
+    spikesToProcess.ensureStorageAllocated(bufferSize);
+
+    canvas->densityRenderer->addPlot(this);
 
 }
 
 SpikePlot::~SpikePlot()
 {
+    canvas->densityRenderer->removePlot(this);
+
     if (thresholdCoordinator)
     {
         thresholdCoordinator->deregisterSpikePlot(this);
@@ -122,20 +147,40 @@ void SpikePlot::paint(Graphics& g)
 
 void SpikePlot::refresh()
 {
+    for (auto ax : waveAxes)
+    {
+        if (ax->checkForNewImage())
+            ax->repaint();
+    }
 
+    for (auto ax : projectionAxes)
     {
-        const ScopedLock myScopedLock(spikeArrayLock);
+        if (ax->checkForNewImage())
+            ax->repaint();
+    }
+}
 
-        for (auto spike : mostRecentSpikes)
-        {
-            processSpikeObject(spike);
-        }
+void SpikePlot::updateDensity(float decayFactor)
+{
+    {
+        const ScopedLock myScopedLock(spikeArrayLock);
 
-        mostRecentSpikes.clearQuick(true);
+        spikesToProcess.swapWith(mostRecentSpikes);
         spikesInBuffer = 0;
     }
-    
-    repaint();
+
+    for (auto spike : spikesToProcess)
+    {
+        processSpikeObject(spike);
+    }
+
+    spikesToProcess.clearQuick(true);
+
+    for (auto ax : waveAxes)
+        ax->updateDensity(decayFactor);
+
+    for (auto ax : projectionAxes)
+        ax->updateDensity(decayFactor);
 }
 
 void SpikePlot::processSpikeObject(const Spike* s)
@@ -541,15 +586,27 @@ double GenericAxes::ad16ToUv(int x, int gain)
     return result;
 }
 
+void GenericAxes::updateDensity(float decayFactor)
+{
+    const ScopedLock lock(density->getLock());
+
+    density->decay(decayFactor);
+    density->render(colours);
+}
+
+bool GenericAxes::checkForNewImage()
+{
+    const ScopedLock lock(density->getLock());
+
+    return density->checkForNewImage();
+}
+
 
 WaveAxes::WaveAxes(SpikeDisplayCanvas* canvas, int electrodeIndex, int channel_, std::string identifier_) : GenericAxes(canvas, WAVE_AXES),
     electrodeIndex(electrodeIndex),
     drawGrid(true),
     displayThresholdLevel(0.0f),
     detectorThresholdLevel(0.0f),
-    spikesReceivedSinceLastRedraw(0),
-    spikeIndex(0),
-    bufferSize(5),
     range(250.0f),
     isOverThresholdSlider(false),
     isDraggingThresholdSlider(false),
@@ -564,15 +621,32 @@ WaveAxes::WaveAxes(SpikeDisplayCanvas* canvas, int electrodeIndex, int channel_,
 
     font = Font("Small Text",10,Font::plain);
 
-    for (int n = 0; n < bufferSize; n++)
+    density = std::make_unique<DensityHistogram>(WAVE_DENSITY_WIDTH, WAVE_DENSITY_HEIGHT);
+}
+
+void WaveAxes::setRange(float r)
+{
+    if (r != range)
     {
-        spikeBuffer.add(nullptr);
+        // the histogram is binned for the old range, so start over
+        const ScopedLock lock(density->getLock());
+
+        range = r;
+        density->clear();
     }
+
+    repaint();
 }
 
-void WaveAxes::setRange(float r)
+void WaveAxes::invertSpikes(bool shouldInvert)
 {
-    range = r;
+    if (shouldInvert != spikesInverted)
+    {
+        const ScopedLock lock(density->getLock());
+
+        spikesInverted = shouldInvert;
+        density->clear();
+    }
 
     repaint();
 }
@@ -589,96 +663,10 @@ void WaveAxes::paint(Graphics& g)
     // draw the threshold line and labels
     drawThresholdSlider(g);
 
-    // if no spikes have been received then don't plot anything
-    if (!gotFirstSpike)
-    {
-        return;
-    }
-
-    for (int spikeNum = 0; spikeNum < bufferSize; spikeNum++)
-    {
-
-        if (spikeNum != spikeIndex)
-        {
-            plotSpike(spikeBuffer[spikeNum], g);
-        }
-
-    }
-
-    plotSpike(spikeBuffer[spikeIndex], g);
-    
-    spikesReceivedSinceLastRedraw = 0;
-
-}
-
-void WaveAxes::plotSpike(const Spike* s, Graphics& g)
-{
-	if (!s) return;
-
-    float h = getHeight();
-
-    const SpikeChannel* sc = s->getChannelInfo();
-
-    if (sc == nullptr)
-        return;
-
-    //compute the spatial width for each waveform sample
-	int nSamples = sc->getTotalSamples();
-	float dx = getWidth() / float(nSamples);
-
-    if (s->getSortedId() > 0)
-        g.setColour(colours[(s->getSortedId() - 1) % 8]);
-    else
-       g.setColour(Colours::white);
-
-    // type corresponds to channel so we need to calculate the starting
-    // sample based upon which channel is getting plotted
-    int sampIdx = nSamples * channel; 
-    
-    int dataSize =s->getChannelInfo()->getDataSize();
-    
-    // prevent crashes when acquisition is not active,
-    // or immediately after acquisition starts
-    //if (   (dataSize < 1)
-    //    || (dataSize > 640)
-    //    || (sampIdx + nSamples > dataSize)
-    //    || (nSamples < 0))
-    //{
-    //    return;
-    //}
-        
-    int dSamples = 1;
-
-    float x = 0.0f;
-	const float* data = s->getDataPointer();
-
-	for (int i = 0; i < nSamples - 1; i++)
-	{
-		//std::cout << s.data[sampIdx] << std::endl;
-
-		float s1, s2;
-
-		if (spikesInverted)
-		{
-			s1 = h / 2 + data[sampIdx] / range * h;
-			s2 = h / 2 + data[sampIdx + 1] / range * h;
-		}
-		else
-		{
-			s1 = h / 2 - data[sampIdx] / range * h;
-			s2 = h / 2 - data[sampIdx + 1] / range * h;
-
-		}
-		
-        g.drawLine(x,
-			s1,
-			x + dx,
-			s2);
-
-		sampIdx += dSamples;
-		x += dx;
-	}
+    const ScopedLock lock(density->getLock());
 
+    density->draw(g, getLocalBounds().toFloat(),
+                  Rectangle<int>(0, 0, density->getWidth(), density->getHeight()));
 }
 
 void WaveAxes::drawThresholdSlider(Graphics& g)
@@ -733,18 +721,42 @@ bool WaveAxes::updateSpikeData(const Spike* s)
         gotFirstSpike = true;
     }
 
-    if (spikesReceivedSinceLastRedraw < bufferSize)
-    {
+    const SpikeChannel* sc = s->getChannelInfo();
+
+    if (sc == nullptr)
+        return false;
+
+    int nSamples = sc->getTotalSamples();
+
+    if (nSamples < 2)
+        return false;
+
+    // type corresponds to channel so we need to calculate the starting
+    // sample based upon which channel is getting plotted
+    const float* data = s->getDataPointer() + nSamples * channel;
+    const uint8 colourIndex = getColourIndex(s);
 
-        Spike* newSpike = new Spike(*s);
+    const ScopedLock lock(density->getLock());
 
-        spikeIndex++;
-        spikeIndex %= bufferSize;
+    const int width = density->getWidth();
+    const float height = float(density->getHeight());
+    const float direction = spikesInverted ? 1.0f : -1.0f;
+    const float samplesPerColumn = float(nSamples - 1) / float(width - 1);
 
-        spikeBuffer.set(spikeIndex, newSpike);
+    int previousRow = int((0.5f + direction * data[0] / range) * height);
+
+    // each column covers the trace from the previous column, so steep edges stay connected
+    for (int x = 0; x < width; x++)
+    {
+        const float position = x * samplesPerColumn;
+        const int i = jmin(int(position), nSamples - 2);
+        const float value = data[i] + (position - i) * (data[i + 1] - data[i]);
 
-        spikesReceivedSinceLastRedraw++;
+        const int row = int((0.5f + direction * value / range) * height);
 
+        density->addSpan(x, previousRow, row, colourIndex);
+
+        previousRow = row;
     }
 
     return true;
@@ -774,13 +786,10 @@ bool WaveAxes::checkThreshold(const Spike* s)
 
 void WaveAxes::clear()
 {
-
-    spikeBuffer.clear();
-    spikeIndex = 0;
-
-    for (int n = 0; n < bufferSize; n++)
     {
-        spikeBuffer.add(nullptr);
+        const ScopedLock lock(density->getLock());
+
+        density->clear();
     }
 
     repaint();
@@ -895,10 +904,10 @@ void WaveAxes::setDisplayThreshold(float threshold)
 
 // --------------------------------------------------
 
-ProjectionAxes::ProjectionAxes(SpikeDisplayCanvas* canvas, Projection proj_) : GenericAxes(canvas, PROJECTION_AXES), imageDim(500),
-    rangeX(250), rangeY(250), spikesReceivedSinceLastRedraw(0), proj(proj_)
+ProjectionAxes::ProjectionAxes(SpikeDisplayCanvas* canvas, Projection proj_) : GenericAxes(canvas, PROJECTION_AXES),
+    proj(proj_), rangeX(250), rangeY(250)
 {
-    projectionImage = Image(Image::RGB, imageDim, imageDim, true);
+    density = std::make_unique<DensityHistogram>(PROJECTION_DENSITY_BINS, PROJECTION_DENSITY_BINS);
 
     clear();
 
@@ -916,9 +925,15 @@ void ProjectionAxes::setRange(float x, float y)
 
 void ProjectionAxes::paint(Graphics& g)
 {
-    g.drawImage(projectionImage,
-                0, 0, getWidth(), getHeight(),
-                0, imageDim-rangeY, rangeX, rangeY);
+    g.fillAll(Colours::black);
+
+    const int binsX = jmin(PROJECTION_DENSITY_BINS, roundToInt(rangeX / PROJECTION_BIN_UV));
+    const int binsY = jmin(PROJECTION_DENSITY_BINS, roundToInt(rangeY / PROJECTION_BIN_UV));
+
+    const ScopedLock lock(density->getLock());
+
+    density->draw(g, getLocalBounds().toFloat(),
+                  Rectangle<int>(0, PROJECTION_DENSITY_BINS - binsY, binsX, binsY));
 }
 
 bool ProjectionAxes::updateSpikeData(const Spike* s)
@@ -931,33 +946,17 @@ bool ProjectionAxes::updateSpikeData(const Spike* s)
     int idx1, idx2;
     calcWaveformPeakIdx(s, ampDim1, ampDim2, &idx1, &idx2);
 
-    // add peaks to image
-    Colour col;
-
-    if (s->getSortedId() > 0)
-        col = colours[(s->getSortedId() - 1) % 8];
-    else
-        col = Colours::white;
-
+    // add peaks to the histogram (in microvolts)
 	const float* data = s->getDataPointer();
-    updateProjectionImage(data[idx1], data[idx2], 1, col);
 
-    return true;
-}
-
-void ProjectionAxes::updateProjectionImage(float x, float y, float gain, Colour col)
-{
-    Graphics g(projectionImage);
+    const int x = int(std::floor(data[idx1] / PROJECTION_BIN_UV));
+    const int y = PROJECTION_DENSITY_BINS - 1 - int(std::floor(data[idx2] / PROJECTION_BIN_UV));
 
-    if (gain != 0)
-    {
-		float xf = x;
-        float yf = float(imageDim) - y; // in microvolts
+    const ScopedLock lock(density->getLock());
 
-        g.setColour(col);
-        g.fillEllipse(xf,yf,2.0f,2.0f);
-    }
+    density->addPoint(x, y, getColourIndex(s));
 
+    return true;
 }
 
 void ProjectionAxes::calcWaveformPeakIdx(const Spike* s, int d1, int d2, int* idx1, int* idx2)
@@ -968,6 +967,9 @@ void ProjectionAxes::calcWaveformPeakIdx(const Spike* s, int d1, int d2, int* id
 	int nSamples = s->getChannelInfo()->getTotalSamples();
 	const float* data = s->getDataPointer();
 
+    *idx1 = d1*nSamples;
+    *idx2 = d2*nSamples;
+
     for (int i = 0; i < nSamples; i++)
     {
         if (data[d1*nSamples + i] > max1)
@@ -987,8 +989,11 @@ void ProjectionAxes::calcWaveformPeakIdx(const Spike* s, int d1, int d2, int* id
 
 void ProjectionAxes::clear()
 {
-    projectionImage.clear(Rectangle<int>(0, 0, projectionImage.getWidth(), projectionImage.getHeight()),
-                          Colours::black);
+    {
+        const ScopedLock lock(density->getLock());
+
+        density->clear();
+    }
 
     repaint();
 }
@@ -27,6 +27,8 @@
 
 #include <VisualizerWindowHeaders.h>
 
+#include "SpikeDensity.h"
+
 class SpikeDisplayCanvas;
 class SpikeThresholdCoordinator;
 
@@ -64,6 +66,9 @@ enum SpikePlotType {
 
   Class for drawing the waveforms and projections of incoming spikes
 
+  Spikes are queued by the processor and moved into the density
+  histograms of the axes by the SpikeDensityRenderer thread.
+
 */
 
 class SpikePlot : public Component, 
@@ -90,9 +95,13 @@ public:
     /** Sets bounds of sub-axes*/
     void resized();
 
-    /** Plots latest spikes in buffer*/
+    /** Repaints the axes whose density images have changed*/
     void refresh();
 
+    /** Processes queued spikes and decays the density histograms
+        (called by the SpikeDensityRenderer thread)*/
+    void updateDensity(float decayFactor);
+
     /** Handles an incoming spike*/
     void processSpikeObject(const Spike* s);
 
@@ -157,10 +166,11 @@ private:
     int nWaveAx;
     int nProjAx;
 
-    const int bufferSize = 5;
+    const int bufferSize = 256;
     int spikesInBuffer;
 
     OwnedArray<Spike> mostRecentSpikes;
+    OwnedArray<Spike> spikesToProcess;
 
     bool limitsChanged;
 
@@ -208,6 +218,12 @@ public:
     /** Called when a new spike is received*/
     virtual bool updateSpikeData(const Spike* s) = 0;
 
+    /** Decays and renders the density histogram*/
+    void updateDensity(float decayFactor);
+
+    /** Returns true if the density image changed since the last call*/
+    bool checkForNewImage();
+
     /** Get/set X and Y limits*/
     void setXLims(double xmin, double xmax);
     void getXLims(double* xmin, double* xmax);
@@ -236,6 +252,8 @@ protected:
 
     double ad16ToUv(int x, int gain);
 
+    std::unique_ptr<DensityHistogram> density;
+
 };
 
 
@@ -261,12 +279,9 @@ public:
     /** Checks whether a spike is above threshold*/
     bool checkThreshold(const Spike* spike);
 
-    /** Draws the component (calls plotSpike)*/
+    /** Draws the grid, thresholds and density image*/
     void paint(Graphics& g);
 
-    /** Draws a single spike */
-    void plotSpike(const Spike* s, Graphics& g);
-
     /** Removes spikes that have been previously drawn*/
     void clear();
 
@@ -288,11 +303,7 @@ public:
     void registerThresholdCoordinator(SpikeThresholdCoordinator* stc);
     void setDisplayThreshold(float threshold);
 
-    void invertSpikes(bool shouldInvert)
-    {
-        spikesInverted = shouldInvert;
-        repaint();
-    }
+    void invertSpikes(bool shouldInvert);
 
 private:
 
@@ -307,22 +318,16 @@ private:
 
     bool drawGrid;
 
-    float displayThresholdLevel;
-    float detectorThresholdLevel;
+    std::atomic<float> displayThresholdLevel;
+    std::atomic<float> detectorThresholdLevel;
 
     void drawWaveformGrid(Graphics& g);
 
     void drawThresholdSlider(Graphics& g);
 
-    int spikesReceivedSinceLastRedraw;
-
     Font font;
 
-   OwnedArray<Spike> spikeBuffer;
-
-    int spikeIndex;
-    int bufferSize;
-
+    /** Written with the density lock held, so the renderer sees consistent values*/
     float range;
 
     bool isOverThresholdSlider;
@@ -371,24 +376,16 @@ private:
 
     Projection proj;
 
-    void updateProjectionImage(float, float, float, Colour);
-
     void calcWaveformPeakIdx(const Spike*, int, int, int*, int*);
 
     int ampDim1, ampDim2;
 
-    Image projectionImage;
-
     Colour pointColour;
     Colour gridColour;
 
-    int imageDim;
-
     int rangeX;
     int rangeY;
 
-    int spikesReceivedSinceLastRedraw;
-
 };
 
 
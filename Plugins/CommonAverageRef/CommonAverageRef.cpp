@@ -27,9 +27,123 @@
 #include "CommonAverageRefEditor.h"
 
 
+namespace
+{
+    /** Number of samples processed per tile*/
+    const int TILE_SIZE = 64;
+
+    /** Largest reference group sorted with a network; larger ones use selection*/
+    const int MAX_NETWORK_SIZE = 64;
+
+    /** Builds Batcher's odd-even merge sort network for size (a power of 2)*/
+    void createSortingNetwork(int size, Array<std::pair<int, int>>& network)
+    {
+        network.clear();
+
+        for (int p = 1; p < size; p += p)
+        {
+            for (int k = p; k >= 1; k /= 2)
+            {
+                for (int j = k % p; j + k < size; j += 2 * k)
+                {
+                    for (int i = 0; i < jmin(k, size - j - k); i++)
+                    {
+                        if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+                            network.add(std::make_pair(i + j, i + j + k));
+                    }
+                }
+            }
+        }
+    }
+
+    /** Orders two rows sample-by-sample, so that a holds the minimum and b the maximum*/
+    inline void compareExchange(float* a, float* b, int numSamples)
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            const float lo = a[i] < b[i] ? a[i] : b[i];
+            const float hi = a[i] < b[i] ? b[i] : a[i];
+
+            a[i] = lo;
+            b[i] = hi;
+        }
+    }
+}
+
 CARSettings::CARSettings()
 {
-    m_avgBuffer = AudioBuffer<float>(1, 10000); // 1-dimensional buffer to hold the average
+    m_avgBuffer = AudioBuffer<float>(1, TILE_SIZE); // 1-dimensional buffer to hold the reference
+}
+
+void CARSettings::updateGroups(const DataStream* stream, int numGroups)
+{
+    OwnedArray<ReferenceGroup> newGroups;
+
+    const int numChannels = stream->getChannelCount();
+
+    numGroups = jlimit(1, jmax(1, numChannels), numGroups);
+
+    for (int i = 0; i < numGroups; i++)
+        newGroups.add(new ReferenceGroup());
+
+    Array<var>* referenceChannels = (*stream)["Reference"].getArray();
+    Array<var>* affectedChannels = (*stream)["Affected"].getArray();
+
+    for (int i = 0; i < referenceChannels->size(); i++)
+    {
+        int localIndex = (*referenceChannels)[i];
+        int globalIndex = stream->getContinuousChannels()[localIndex]->getGlobalIndex();
+        newGroups[localIndex * numGroups / numChannels]->referenceChannels.add(globalIndex);
+    }
+
+    for (int i = 0; i < affectedChannels->size(); i++)
+    {
+        int localIndex = (*affectedChannels)[i];
+        int globalIndex = stream->getContinuousChannels()[localIndex]->getGlobalIndex();
+        newGroups[localIndex * numGroups / numChannels]->affectedChannels.add(globalIndex);
+    }
+
+    int maxNetworkSize = 0;
+    int maxReferenceChannels = 0;
+
+    for (auto group : newGroups)
+    {
+        const int numReferenceChannels = group->referenceChannels.size();
+
+        maxReferenceChannels = jmax(maxReferenceChannels, numReferenceChannels);
+
+        if (numReferenceChannels > 1 && numReferenceChannels <= MAX_NETWORK_SIZE)
+        {
+            group->networkSize = nextPowerOfTwo(numReferenceChannels);
+            createSortingNetwork(group->networkSize, group->network);
+            maxNetworkSize = jmax(maxNetworkSize, group->networkSize);
+        }
+    }
+
+    // allocate outside the lock, swap inside; groups that were replaced are freed here, not on the audio thread
+    AudioSampleBuffer newMedianBuffer(jmax(1, maxNetworkSize), TILE_SIZE);
+    HeapBlock<float> newSelectionBuffer(jmax(1, maxReferenceChannels));
+
+    const ScopedLock lock(groupLock);
+
+    pendingGroups.swapWith(newGroups);
+    std::swap(pendingMedianBuffer, newMedianBuffer);
+    std::swap(pendingSelectionBuffer, newSelectionBuffer);
+    hasPendingGroups = true;
+}
+
+void CARSettings::applyPendingGroups()
+{
+    const ScopedTryLock lock(groupLock);
+
+    if (!lock.isLocked() || !hasPendingGroups)
+        return;
+
+    // the previous groups are kept as pending until the next update frees them
+    groups.swapWith(pendingGroups);
+    std::swap(m_medianBuffer, pendingMedianBuffer);
+    std::swap(m_selectionBuffer, pendingSelectionBuffer);
+    hasPendingGroups = false;
 }
 
 CommonAverageRef::CommonAverageRef()
@@ -50,6 +164,19 @@ CommonAverageRef::CommonAverageRef()
                       0.0f,
                       100.0f,
                       1.0f);
+
+    addIntParameter(Parameter::STREAM_SCOPE,
+                    "groups",
+                    "Number of contiguous channel groups with independent references",
+                    1,
+                    1,
+                    16);
+
+    addCategoricalParameter(Parameter::STREAM_SCOPE,
+                            "method",
+                            "Statistic used to compute the reference",
+                            { "MEAN", "MEDIAN" },
+                            0);
 }
 
 
@@ -68,9 +195,107 @@ AudioProcessorEditor* CommonAverageRef::createEditor()
 void CommonAverageRef::updateSettings()
 {
     settings.update(getDataStreams());
+
+    for (auto stream : getDataStreams())
+    {
+        settings[stream->getStreamId()]->updateGroups(stream, (*stream)["groups"]);
+    }
     
 }
 
+
+void CommonAverageRef::parameterValueChanged(Parameter* param)
+{
+    if (param->getName().equalsIgnoreCase("Reference")
+        || param->getName().equalsIgnoreCase("Affected")
+        || param->getName().equalsIgnoreCase("groups"))
+    {
+        const DataStream* stream = getDataStream(param->getStreamId());
+
+        settings[stream->getStreamId()]->updateGroups(stream, (*stream)["groups"]);
+    }
+}
+
+
+void CommonAverageRef::computeMeanReference(const ReferenceGroup* group,
+                                            const AudioBuffer<float>& buffer,
+                                            int startSample,
+                                            int numSamples,
+                                            float* reference)
+{
+    const int numReferenceChannels = group->referenceChannels.size();
+
+    FloatVectorOperations::copy(reference,
+                                buffer.getReadPointer(group->referenceChannels.getUnchecked(0), startSample),
+                                numSamples);
+
+    for (int i = 1; i < numReferenceChannels; ++i)
+    {
+        FloatVectorOperations::add(reference,
+                                   buffer.getReadPointer(group->referenceChannels.getUnchecked(i), startSample),
+                                   numSamples);
+    }
+
+    FloatVectorOperations::multiply(reference, 1.0f / float(numReferenceChannels), numSamples);
+}
+
+
+void CommonAverageRef::computeMedianReference(CARSettings* settings_,
+                                              const ReferenceGroup* group,
+                                              const AudioBuffer<float>& buffer,
+                                              int startSample,
+                                              int numSamples,
+                                              float* reference)
+{
+    const int numReferenceChannels = group->referenceChannels.size();
+    const int lower = (numReferenceChannels - 1) / 2;
+    const int upper = numReferenceChannels / 2;
+
+    if (numReferenceChannels == 1)
+    {
+        FloatVectorOperations::copy(reference,
+                                    buffer.getReadPointer(group->referenceChannels.getUnchecked(0), startSample),
+                                    numSamples);
+    }
+    else if (group->networkSize > 0)
+    {
+        // sort all samples of the tile at once; each compare-exchange is a pair of vector min/max
+        AudioSampleBuffer& rows = settings_->m_medianBuffer;
+
+        for (int i = 0; i < group->networkSize; ++i)
+        {
+            if (i < numReferenceChannels)
+                rows.copyFrom(i, 0, buffer, group->referenceChannels.getUnchecked(i), startSample, numSamples);
+            else
+                FloatVectorOperations::fill(rows.getWritePointer(i), std::numeric_limits<float>::max(), numSamples);
+        }
+
+        for (const auto& pair : group->network)
+            compareExchange(rows.getWritePointer(pair.first), rows.getWritePointer(pair.second), numSamples);
+
+        FloatVectorOperations::add(reference, rows.getReadPointer(lower), rows.getReadPointer(upper), numSamples);
+        FloatVectorOperations::multiply(reference, 0.5f, numSamples);
+    }
+    else
+    {
+        float* values = settings_->m_selectionBuffer.getData();
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            for (int i = 0; i < numReferenceChannels; ++i)
+                values[i] = buffer.getSample(group->referenceChannels.getUnchecked(i), startSample + n);
+
+            std::nth_element(values, values + upper, values + numReferenceChannels);
+
+            const float upperValue = values[upper];
+            const float lowerValue = (lower == upper) ? upperValue : *std::max_element(values, values + upper);
+
+            reference[n] = 0.5f * (lowerValue + upperValue);
+        }
+    }
+}
+
+
 void CommonAverageRef::process (AudioBuffer<float>& buffer)
 {
 
@@ -82,48 +307,40 @@ void CommonAverageRef::process (AudioBuffer<float>& buffer)
             CARSettings* settings_ = settings[stream->getStreamId()];
 
             const int numSamples = getNumSamplesInBlock(stream->getStreamId());
-            const int numReferenceChannels = (*stream)["Reference"].getArray()->size();
-            const int numAffectedChannels = (*stream)["Affected"].getArray()->size();
-
-            // There is no need to do any processing if either number of reference or affected channels is zero.
-            if (!numReferenceChannels
-                || !numAffectedChannels)
-            {
-                return;
-            }
-
-            settings_->m_avgBuffer.clear();
-
-            for (int i = 0; i < numReferenceChannels; ++i)
-            {
-                int localIndex = (*stream)["Reference"][i];
-                int globalIndex = stream->getContinuousChannels()[localIndex]->getGlobalIndex();
-
-                settings_->m_avgBuffer.addFrom(0,       // destChannel
-                    0,                                  // destStartSample
-                    buffer,                             // source
-                    globalIndex,                        // sourceChannel
-                    0,                                  // sourceStartSample
-                    numSamples,                         // numSamples
-                    1.0f);                              // gain to apply
-            }
+            const float gain = -1.0f * float((*stream)["gain_level"]) / 100.f;
+            const bool useMedian = int((*stream)["method"]) == MEDIAN_REFERENCE;
 
-            settings_->m_avgBuffer.applyGain(1.0f / float(numReferenceChannels));
+            // never waits for the message thread; a regrouping in progress is picked up next block
+            settings_->applyPendingGroups();
 
-            const float gain = -1.0f * float((*stream)["gain_level"]) / 100.f;
+            float* reference = settings_->m_avgBuffer.getWritePointer(0);
 
-            for (int i = 0; i < numAffectedChannels; ++i)
+            for (int startSample = 0; startSample < numSamples; startSample += TILE_SIZE)
             {
-                int localIndex = (*stream)["Affected"][i];
-                int globalIndex = stream->getContinuousChannels()[localIndex]->getGlobalIndex();
-
-                buffer.addFrom(globalIndex,                // destChannel
-                    0,                                     // destStartSample
-                    settings_->m_avgBuffer,                // source
-                    0,                                     // sourceChannel
-                    0,                                     // sourceStartSample
-                    numSamples,                            // numSamples
-                    gain);                                 // gain to apply
+                const int tileSize = jmin(TILE_SIZE, numSamples - startSample);
+
+                for (auto group : settings_->groups)
+                {
+                    // There is no need to do any processing if either number of reference or affected channels is zero.
+                    if (group->referenceChannels.isEmpty()
+                        || group->affectedChannels.isEmpty())
+                    {
+                        continue;
+                    }
+
+                    if (useMedian)
+                        computeMedianReference(settings_, group, buffer, startSample, tileSize, reference);
+                    else
+                        computeMeanReference(group, buffer, startSample, tileSize, reference);
+
+                    for (int globalIndex : group->affectedChannels)
+                    {
+                        FloatVectorOperations::addWithMultiply(buffer.getWritePointer(globalIndex, startSample),
+                                                               reference,
+                                                               gain,
+                                                               tileSize);
+                    }
+                }
             }
         }
 
@@ -132,4 +349,3 @@ void CommonAverageRef::process (AudioBuffer<float>& buffer)
 
    
 }
-
@@ -26,6 +26,28 @@
 
 #include <ProcessorHeaders.h>
 
+/** Reference computation methods*/
+enum ReferenceMethod
+{
+    MEAN_REFERENCE = 0, MEDIAN_REFERENCE
+};
+
+/** Reference and affected channels that share a common reference (e.g. one shank)*/
+struct ReferenceGroup
+{
+    /** Global indices of the channels used to build the reference*/
+    Array<int> referenceChannels;
+
+    /** Global indices of the channels from which the reference is subtracted*/
+    Array<int> affectedChannels;
+
+    /** Compare-exchange pairs of the median sorting network (empty if too large)*/
+    Array<std::pair<int, int>> network;
+
+    /** Number of rows sorted by the network (power of 2)*/
+    int networkSize = 0;
+};
+
 /** Holds settings for one stream's CAR*/
 
 class CARSettings
@@ -39,9 +61,36 @@ public:
     /** Destructor */
     ~CARSettings() {}
 
-    /** Buffer to hold average */
+    /** Splits the selected channels into contiguous groups, which are used from the next block on */
+    void updateGroups(const DataStream* stream, int numGroups);
+
+    /** Starts using the groups built by the last call to updateGroups(). Called from the audio thread;
+        if the groups are being published, the previous ones are kept for this block. */
+    void applyPendingGroups();
+
+    /** Buffer to hold the reference for one tile of samples */
     AudioSampleBuffer m_avgBuffer;
 
+    /** Rows sorted by the median network */
+    AudioSampleBuffer m_medianBuffer;
+
+    /** Scratch space for median selection when no network is available*/
+    HeapBlock<float> m_selectionBuffer;
+
+    /** Reference groups for this stream (only used by the audio thread) */
+    OwnedArray<ReferenceGroup> groups;
+
+private:
+
+    /** Groups and scratch buffers waiting to be picked up by the audio thread */
+    OwnedArray<ReferenceGroup> pendingGroups;
+    AudioSampleBuffer pendingMedianBuffer;
+    HeapBlock<float> pendingSelectionBuffer;
+    bool hasPendingGroups = false;
+
+    /** Guards the pending groups */
+    CriticalSection groupLock;
+
 };
 
 
@@ -49,6 +98,11 @@ public:
     This is a simple filter that subtracts the average of a subset of channels from 
     another subset of channels. The gain parameter allows you to subtract a percentage of the total avg.
 
+    The channels of a stream can be split into contiguous groups (e.g. one per shank),
+    each with its own reference, and the per-sample median can be used instead of the mean.
+    The reference is built and subtracted one tile of samples at a time, so each tile
+    stays in cache while all channels of a group are updated.
+
     See Ludwig et al. 2009 Using a common average reference to improve cortical
     neuron recordings from microelectrode arrays. J. Neurophys, 2009 for a detailed
     discussion
@@ -68,6 +122,9 @@ public:
     /** Called when upstream settings are changed.*/
     void updateSettings() override;
 
+    /** Called when a parameter is updated*/
+    void parameterValueChanged(Parameter* param) override;
+
     /** Returns the current gain level that is set in the processor */
     float getGainLevel(uint16 streamId);
 
@@ -79,6 +136,14 @@ public:
 
 private:
 
+    /** Writes the mean of a group's reference channels for one tile into reference*/
+    void computeMeanReference(const ReferenceGroup* group, const AudioBuffer<float>& buffer,
+                              int startSample, int numSamples, float* reference);
+
+    /** Writes the median of a group's reference channels for one tile into reference*/
+    void computeMedianReference(CARSettings* settings_, const ReferenceGroup* group, const AudioBuffer<float>& buffer,
+                                int startSample, int numSamples, float* reference);
+
     StreamSettings<CARSettings> settings;
 
     // ==================================================================
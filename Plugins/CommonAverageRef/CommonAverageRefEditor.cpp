@@ -27,10 +27,12 @@ CommonAverageRefEditor::CommonAverageRefEditor (GenericProcessor* parentProcesso
     : GenericEditor (parentProcessor)
 {
     
-    setDesiredWidth (205);
+    setDesiredWidth (295);
 
     addSelectedChannelsParameterEditor("Affected", 20, 45);
     addSelectedChannelsParameterEditor("Reference", 20, 85);
     addSliderParameterEditor("gain_level", 115, 45);
+    addComboBoxParameterEditor("method", 200, 85);
+    addComboBoxParameterEditor("groups", 200, 45);
     
 }
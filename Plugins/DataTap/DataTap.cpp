@@ -0,0 +1,345 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "DataTap.h"
+#include "DataTapEditor.h"
+
+#if ! JUCE_WINDOWS
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+#endif
+
+/** Number of records in the event ring */
+#define TAP_EVENT_CAPACITY 65536
+
+/** Smallest sample ring, regardless of buffer_seconds */
+#define TAP_MIN_RING_SAMPLES 8192
+
+/** Largest number of notification subscribers */
+#define TAP_MAX_SUBSCRIBERS 16
+
+#if ! JUCE_WINDOWS
+namespace
+{
+    /** Returns true if a socket is still bound to this address by a running process */
+    bool isSocketInUse(const sockaddr_un& address)
+    {
+        const int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+        if (fd < 0)
+            return false;
+
+        // a stale socket file refuses connections once its owner has exited
+        const bool inUse = connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+
+        close(fd);
+
+        return inUse;
+    }
+}
+#endif
+
+
+DataTap::DataTap()
+    : GenericProcessor("Data Tap"),
+      Thread("Data Tap notifications"),
+      blocksWritten(0)
+{
+
+    addStringParameter(Parameter::GLOBAL_SCOPE, "shm_name", "Name of the shared memory segment (/name)", "/open-ephys-tap", true);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "buffer_seconds", "Length of each stream's sample ring (s)", 2, 0.1, 60, 0.1, true);
+    addBooleanParameter(Parameter::GLOBAL_SCOPE, "notify_socket", "Notify subscribers to a Unix socket after every block", false, true);
+
+}
+
+DataTap::~DataTap()
+{
+    stopThread(1000);
+}
+
+AudioProcessorEditor* DataTap::createEditor()
+{
+    editor = std::make_unique<DataTapEditor> (this);
+
+    return editor.get();
+}
+
+void DataTap::updateSettings()
+{
+    createSegment();
+}
+
+void DataTap::parameterValueChanged(Parameter* param)
+{
+    if (param->getName().equalsIgnoreCase("shm_name")
+        || param->getName().equalsIgnoreCase("buffer_seconds")
+        || param->getName().equalsIgnoreCase("enable_stream"))
+    {
+        createSegment();
+    }
+}
+
+void DataTap::createSegment()
+{
+    tappedStreams.clear();
+
+    Array<TapSegment::StreamSpec> specs;
+
+    const float bufferSeconds = getParameter("buffer_seconds")->getValue();
+
+    for (auto stream : dataStreams)
+    {
+        if (!(*stream)["enable_stream"])
+            continue;
+
+        if (tappedStreams.size() == TapLayout::MAX_STREAMS)
+            break;
+
+        TappedStream tapped;
+        tapped.streamId = stream->getStreamId();
+
+        for (auto channel : stream->getContinuousChannels())
+            tapped.channels.add(channel->getGlobalIndex());
+
+        TapSegment::StreamSpec spec;
+        spec.name = stream->getName();
+        spec.streamId = stream->getStreamId();
+        spec.numChannels = tapped.channels.size();
+        spec.sampleRate = stream->getSampleRate();
+        spec.capacity = jmax(TAP_MIN_RING_SAMPLES, int(bufferSeconds * stream->getSampleRate()));
+
+        tappedStreams.add(tapped);
+        specs.add(spec);
+    }
+
+    const String name = getParameter("shm_name")->getValue().toString();
+
+    if (!segment.create(name, specs, TAP_EVENT_CAPACITY))
+        tappedStreams.clear();
+}
+
+bool DataTap::startAcquisition()
+{
+    blocksWritten = 0;
+
+    if (segment.isOpen() && (bool) getParameter("notify_socket")->getValue())
+        startThread();
+
+    return true;
+}
+
+bool DataTap::stopAcquisition()
+{
+    stopThread(1000);
+
+    return true;
+}
+
+void DataTap::process(AudioBuffer<float>& buffer)
+{
+
+    if (!segment.isOpen())
+        return;
+
+    checkForEvents(true);
+
+    for (int i = 0; i < tappedStreams.size(); i++)
+    {
+        const TappedStream& stream = tappedStreams.getReference(i);
+
+        const int numSamples = getNumSamplesInBlock(stream.streamId);
+
+        segment.beginBlock(i);
+
+        for (int c = 0; c < stream.channels.size(); c++)
+            segment.writeChannel(i, c, buffer.getReadPointer(stream.channels[c]), numSamples);
+
+        segment.endBlock(i,
+                         numSamples,
+                         getFirstSampleNumberForBlock(stream.streamId),
+                         getFirstTimestampForBlock(stream.streamId));
+    }
+
+    blocksWritten.store(segment.finishBlock(), std::memory_order_release);
+
+    if (isThreadRunning())
+        notify();
+
+}
+
+void DataTap::handleTTLEvent(TTLEventPtr event)
+{
+    if (!segment.isOpen())
+        return;
+
+    TapLayout::EventRecord record {};
+    record.type = TapLayout::TTL_EVENT;
+    record.streamId = event->getStreamId();
+    record.channel = event->getLine();
+    record.state = event->getState() ? 1 : 0;
+    record.sampleNumber = event->getSampleNumber();
+    record.timestamp = event->getTimestampInSeconds();
+
+    segment.writeEvent(record);
+}
+
+void DataTap::handleSpike(SpikePtr spike)
+{
+    if (!segment.isOpen())
+        return;
+
+    TapLayout::EventRecord record {};
+    record.type = TapLayout::SPIKE_EVENT;
+    record.streamId = spike->getStreamId();
+    record.channel = spike->getChannelInfo()->getLocalIndex();
+    record.sortedId = spike->getSortedId();
+    record.sampleNumber = spike->getSampleNumber();
+    record.timestamp = spike->getTimestampInSeconds();
+
+    segment.writeEvent(record);
+}
+
+void DataTap::handleBroadcastMessage(String msg)
+{
+    if (!segment.isOpen())
+        return;
+
+    TapLayout::EventRecord record {};
+    record.type = TapLayout::TEXT_EVENT;
+    record.sampleNumber = -1;
+    record.timestamp = -1.0;
+    msg.copyToUTF8(record.text, TapLayout::EVENT_TEXT_LENGTH);
+
+    segment.writeEvent(record);
+}
+
+String DataTap::getSocketPath()
+{
+    const String name = getParameter("shm_name")->getValue().toString();
+
+    return "/tmp/" + name.trimCharactersAtStart("/") + ".sock";
+}
+
+void DataTap::run()
+{
+#if ! JUCE_WINDOWS
+    const String path = getSocketPath();
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    if (path.getNumBytesAsUTF8() >= sizeof(address.sun_path))
+    {
+        LOGE("Data Tap: socket path ", path, " is too long.");
+        return;
+    }
+
+    path.copyToUTF8(address.sun_path, sizeof(address.sun_path));
+
+    // only a socket left behind by a crashed session is replaced
+    if (isSocketInUse(address))
+    {
+        LOGE("Data Tap: notification socket ", path, " is in use by another process.");
+        return;
+    }
+
+    unlink(address.sun_path);
+
+    const int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        LOGE("Data Tap: unable to open notification socket ", path, ": ", strerror(errno));
+
+        if (fd >= 0)
+            close(fd);
+
+        return;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    LOGC("Data Tap: sending notifications to subscribers of ", path);
+
+    std::vector<sockaddr_un> subscribers;
+    uint64 lastNotified = blocksWritten.load();
+
+    while (!threadShouldExit())
+    {
+        // woken by process() after every block
+        wait(100);
+
+        /* Any datagram from a bound socket subscribes its sender */
+        while (true)
+        {
+            sockaddr_un sender {};
+            socklen_t senderLength = sizeof(sender);
+            char message[64];
+
+            if (recvfrom(fd, message, sizeof(message), 0, reinterpret_cast<sockaddr*>(&sender), &senderLength) < 0)
+                break;
+
+            if (senderLength <= sizeof(sa_family_t) || sender.sun_path[0] == 0)
+                continue; // unnamed socket: nowhere to send notifications
+
+            bool isSubscribed = false;
+
+            for (const auto& subscriber : subscribers)
+                isSubscribed = isSubscribed || strcmp(subscriber.sun_path, sender.sun_path) == 0;
+
+            if (!isSubscribed && subscribers.size() < TAP_MAX_SUBSCRIBERS)
+            {
+                LOGD("Data Tap: new subscriber ", sender.sun_path);
+                subscribers.push_back(sender);
+            }
+        }
+
+        const uint64 blocks = blocksWritten.load(std::memory_order_acquire);
+
+        if (blocks == lastNotified)
+            continue;
+
+        lastNotified = blocks;
+
+        for (auto it = subscribers.begin(); it != subscribers.end();)
+        {
+            const bool failed = sendto(fd, &blocks, sizeof(blocks), MSG_DONTWAIT,
+                                       reinterpret_cast<const sockaddr*>(&*it), sizeof(sockaddr_un)) < 0;
+
+            // a full socket only loses this notification; a closed one is unsubscribed
+            if (failed && (errno == ECONNREFUSED || errno == ENOENT))
+                it = subscribers.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    close(fd);
+    unlink(address.sun_path);
+#endif
+}
@@ -0,0 +1,116 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __DATATAP_H_E4A7C2B5__
+#define __DATATAP_H_E4A7C2B5__
+
+#include <ProcessorHeaders.h>
+
+#include "TapSegment.h"
+
+#include <atomic>
+
+/**
+    Publishes live data to other programs on the same computer.
+
+    The continuous data of every enabled stream, along with TTL events,
+    spikes and broadcast messages, are written to a POSIX shared-memory
+    segment (see DataTapLayout.h), which consumers can map and read
+    without copying. The audio thread never waits for a consumer: each
+    stream's ring is simply overwritten once it is full.
+
+    Optionally, subscribers to a Unix datagram socket are notified after
+    every block, from a separate thread.
+
+    @see GenericProcessor, DataTapEditor, TapSegment
+*/
+class DataTap : public GenericProcessor,
+                private Thread
+{
+public:
+
+    /** Constructor */
+    DataTap();
+
+    /** Destructor */
+    ~DataTap();
+
+    /** Creates the DataTapEditor. */
+    AudioProcessorEditor* createEditor() override;
+
+    /** Writes the current block and its events to shared memory */
+    void process(AudioBuffer<float>& buffer) override;
+
+    /** Re-creates the shared-memory segment for the enabled streams */
+    void updateSettings() override;
+
+    /** Called when a parameter is updated */
+    void parameterValueChanged(Parameter* param) override;
+
+    /** Starts the notification thread, if enabled */
+    bool startAcquisition() override;
+
+    /** Stops the notification thread */
+    bool stopAcquisition() override;
+
+private:
+
+    /** Adds TTL events to the event ring */
+    void handleTTLEvent(TTLEventPtr event) override;
+
+    /** Adds spikes to the event ring */
+    void handleSpike(SpikePtr spike) override;
+
+    /** Adds broadcast messages to the event ring */
+    void handleBroadcastMessage(String msg) override;
+
+    /** Handles subscriptions and sends notifications */
+    void run() override;
+
+    /** Creates the segment from the current parameters */
+    void createSegment();
+
+    /** Returns the path of the notification socket */
+    String getSocketPath();
+
+    /** A stream published to the segment */
+    struct TappedStream
+    {
+        uint16 streamId;
+
+        /** Global indices of the stream's continuous channels */
+        Array<int> channels;
+    };
+
+    Array<TappedStream> tappedStreams;
+
+    TapSegment segment;
+
+    /** Number of blocks written, as last published to subscribers */
+    std::atomic<uint64> blocksWritten;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DataTap);
+
+};
+
+#endif  // __DATATAP_H_E4A7C2B5__
@@ -0,0 +1,192 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __DATATAPLAYOUT_H_3C9E1F0A__
+#define __DATATAPLAYOUT_H_3C9E1F0A__
+
+#include <atomic>
+#include <cstdint>
+
+/**
+
+    Layout of the shared-memory segment written by the Data Tap.
+
+    This header does not depend on JUCE, so that consumers can include it
+    directly. The segment (shm_open name set in the Data Tap editor, e.g.
+    "/open-ephys-tap") starts with a SegmentHeader, followed by the sample
+    ring of each stream and by the event ring. All offsets are in bytes from
+    the start of the segment, and every region is 64-byte aligned.
+
+    Continuous data
+    ---------------
+    Each stream's ring holds float32[numChannels][capacity] (channel-major,
+    in the same units as the signal chain). The sample with absolute index i
+    (counting from the start of acquisition) is at ring position
+    i % capacity. Sample numbers are found from the most recent block:
+    index i has sample number blockSampleNumber + (i - blockStart).
+
+    The writer updates a stream as a seqlock: StreamHeader::sequence is odd
+    while a block is being written, and is incremented again once
+    samplesWritten and the block fields are up to date. To take a consistent
+    copy, a reader:
+
+        1. loads sequence (acquire) and retries while it is odd
+        2. loads samplesWritten and the block fields, and copies any samples
+           with index in [samplesWritten - capacity, samplesWritten)
+        3. loads sequence again; if it changed, the copy is retried
+
+    Readers that use the ring in place, without copying, can rely on the
+    samples older than samplesWritten - capacity + maxBlockSamples being
+    overwritten first; everything newer stays valid until the next block.
+    A reader never blocks the writer, which simply overwrites data that has
+    not been read in time.
+
+    Events
+    ------
+    TTL events, spikes (time, electrode and sorted ID, without waveforms)
+    and broadcast messages are stored as fixed-size EventRecords in a single
+    ring of eventCapacity records. Record k is at eventOffset
+    + (k % eventCapacity) * sizeof (EventRecord), and is complete once
+    eventsWritten (acquire) is greater than k. The writer overwrites the
+    slot of record k while eventsWritten equals k + eventCapacity, so a
+    reader copies the record, issues an acquire fence, loads eventsWritten
+    again, and only keeps the copy if eventsWritten - k < eventCapacity.
+
+    Lifetime
+    --------
+    The segment is re-created whenever the signal chain changes. The old
+    segment's state is set to CLOSED first, so readers know to re-open it
+    by name; its contents stay readable until they unmap it.
+
+    A segment name can only be used by one writer at a time. An existing
+    segment is only replaced if it is CLOSED or its ownerPid has exited
+    (i.e. it was left behind by a crashed session); otherwise the Data Tap
+    reports an error and does not publish anything.
+
+    Notifications
+    -------------
+    If enabled, the Data Tap also listens on a Unix datagram socket at
+    /tmp/<name>.sock (the segment name without the leading '/'). Any
+    datagram sent to it from a bound socket subscribes its sender, which
+    then receives an 8-byte datagram with the current blocksWritten after
+    each block. Notifications are dropped for subscribers whose socket is
+    full, and subscribers whose socket has gone away are removed.
+
+*/
+namespace TapLayout
+{
+    /** Written at the start of every segment */
+    static const char MAGIC[8] = { 'O', 'E', 'D', 'A', 'T', 'A', 'T', 'P' };
+
+    /** Incremented whenever this layout changes */
+    static const uint32_t LAYOUT_VERSION = 1;
+
+    static const int MAX_STREAMS = 32;
+    static const int MAX_NAME_LENGTH = 64;
+    static const int EVENT_TEXT_LENGTH = 96;
+
+    enum SegmentState : uint32_t
+    {
+        CONFIGURING = 0,
+        ACTIVE = 1,
+        CLOSED = 2
+    };
+
+    enum EventType : uint16_t
+    {
+        TTL_EVENT = 1,
+        SPIKE_EVENT = 2,
+        TEXT_EVENT = 3
+    };
+
+    /** Describes one stream and its sample ring */
+    struct alignas(64) StreamHeader
+    {
+        char name[MAX_NAME_LENGTH]; // null-terminated
+        uint32_t streamId;
+        uint32_t numChannels;
+        float sampleRate;
+        uint32_t capacity;          // samples per channel
+        uint64_t dataOffset;        // float32[numChannels][capacity]
+        uint32_t maxBlockSamples;   // largest block written so far
+        uint32_t reserved;
+
+        /** Seqlock counter: odd while a block is being written */
+        std::atomic<uint64_t> sequence;
+
+        /** Total number of samples written per channel */
+        std::atomic<uint64_t> samplesWritten;
+
+        /** Absolute index, sample number, timestamp (in seconds, or -1) and length of the most recent block */
+        uint64_t blockStart;
+        int64_t blockSampleNumber;
+        double blockTimestamp;
+        uint32_t blockSamples;
+    };
+
+    /** One TTL event, spike or broadcast message */
+    struct EventRecord
+    {
+        uint16_t type;          // EventType
+        uint16_t streamId;      // 0 for broadcast messages
+        uint16_t channel;       // TTL line, or local index of the spike channel
+        uint16_t state;         // TTL state
+        uint32_t sortedId;      // spike sorted ID
+        uint32_t reserved;
+        int64_t sampleNumber;   // -1 for broadcast messages
+        double timestamp;       // seconds, or -1 if not available
+        char text[EVENT_TEXT_LENGTH]; // null-terminated (broadcast messages only)
+    };
+
+    /** Start of the segment */
+    struct alignas(64) SegmentHeader
+    {
+        char magic[8];
+        uint32_t version;
+
+        /** SegmentState */
+        std::atomic<uint32_t> state;
+
+        uint64_t segmentSize;
+        uint32_t numStreams;
+        uint32_t eventCapacity;
+        uint64_t eventOffset;
+
+        /** Process ID of the writer */
+        uint32_t ownerPid;
+        uint32_t reserved;
+
+        /** Total number of events written */
+        std::atomic<uint64_t> eventsWritten;
+
+        /** Total number of blocks processed */
+        std::atomic<uint64_t> blocksWritten;
+
+        StreamHeader streams[MAX_STREAMS];
+    };
+
+    static_assert (sizeof (EventRecord) == 128, "EventRecord must stay 128 bytes");
+    static_assert (std::atomic<uint64_t>::is_always_lock_free, "Shared counters must be lock-free");
+}
+
+#endif  // __DATATAPLAYOUT_H_3C9E1F0A__
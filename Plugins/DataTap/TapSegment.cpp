@@ -0,0 +1,291 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "TapSegment.h"
+
+#if ! JUCE_WINDOWS
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /** Rounds a size up to the 64-byte alignment of every region */
+    uint64 align64(uint64 size)
+    {
+        return (size + 63) & ~uint64(63);
+    }
+
+#if ! JUCE_WINDOWS
+    /** Returns true if a segment with this name exists and is still published by a running process */
+    bool isSegmentInUse(const String& name)
+    {
+        const int fd = shm_open(name.toRawUTF8(), O_RDONLY, 0);
+
+        if (fd < 0)
+            return errno == EACCES; // owned by another user, so it can't be replaced anyway
+
+        bool inUse = false;
+        struct stat info;
+
+        if (fstat(fd, &info) == 0 && info.st_size >= (off_t) sizeof(TapLayout::SegmentHeader))
+        {
+            void* mapping = mmap(nullptr, sizeof(TapLayout::SegmentHeader), PROT_READ, MAP_SHARED, fd, 0);
+
+            if (mapping != MAP_FAILED)
+            {
+                const TapLayout::SegmentHeader* existing = static_cast<const TapLayout::SegmentHeader*>(mapping);
+
+                inUse = memcmp(existing->magic, TapLayout::MAGIC, sizeof(existing->magic)) == 0
+                        && existing->version == TapLayout::LAYOUT_VERSION
+                        && existing->state.load(std::memory_order_acquire) != TapLayout::CLOSED
+                        && existing->ownerPid != 0
+                        && (kill((pid_t) existing->ownerPid, 0) == 0 || errno == EPERM);
+
+                munmap(mapping, sizeof(TapLayout::SegmentHeader));
+            }
+        }
+
+        ::close(fd);
+
+        return inUse;
+    }
+#endif
+}
+
+TapSegment::TapSegment()
+    : data(nullptr),
+      size(0),
+      header(nullptr)
+{
+
+}
+
+TapSegment::~TapSegment()
+{
+    close();
+}
+
+bool TapSegment::create(const String& name, const Array<StreamSpec>& streams, int eventCapacity)
+{
+    close();
+
+#if JUCE_WINDOWS
+    LOGE("Data Tap: shared memory is not supported on this platform.");
+    return false;
+#else
+
+    if (! name.startsWithChar('/') || name.length() < 2 || name.substring(1).containsChar('/'))
+    {
+        LOGE("Data Tap: invalid shared memory name ", name, " (must be /name).");
+        return false;
+    }
+
+    const int numStreams = jmin(streams.size(), TapLayout::MAX_STREAMS);
+
+    if (numStreams < streams.size())
+        LOGE("Data Tap: only the first ", TapLayout::MAX_STREAMS, " streams are published.");
+
+    /* Header, then each stream's ring, then the event ring */
+    uint64 offset = align64(sizeof(TapLayout::SegmentHeader));
+    Array<uint64> dataOffsets;
+
+    for (int i = 0; i < numStreams; i++)
+    {
+        dataOffsets.add(offset);
+        offset += align64(uint64(streams[i].numChannels) * streams[i].capacity * sizeof(float));
+    }
+
+    const uint64 eventOffset = offset;
+    offset += uint64(eventCapacity) * sizeof(TapLayout::EventRecord);
+
+    if (isSegmentInUse(name))
+    {
+        LOGE("Data Tap: shared memory ", name, " is in use by another running instance; choose a unique name in the Data Tap editor.");
+        return false;
+    }
+
+    /* A segment left behind by a previous session is replaced */
+    shm_unlink(name.toRawUTF8());
+
+    const int fd = shm_open(name.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (fd < 0)
+    {
+        LOGE("Data Tap: unable to create shared memory ", name, ": ", strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(fd, (off_t) offset) != 0)
+    {
+        LOGE("Data Tap: unable to allocate ", offset, " bytes of shared memory: ", strerror(errno));
+        ::close(fd);
+        shm_unlink(name.toRawUTF8());
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, (size_t) offset, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        LOGE("Data Tap: unable to map shared memory: ", strerror(errno));
+        shm_unlink(name.toRawUTF8());
+        return false;
+    }
+
+    data = mapping;
+    size = (size_t) offset;
+    segmentName = name;
+
+    /* The new segment is zero-filled, so only the non-zero fields need to be set */
+    header = new (data) TapLayout::SegmentHeader();
+
+    memcpy(header->magic, TapLayout::MAGIC, sizeof(header->magic));
+    header->version = TapLayout::LAYOUT_VERSION;
+    header->segmentSize = size;
+    header->numStreams = numStreams;
+    header->eventCapacity = eventCapacity;
+    header->eventOffset = eventOffset;
+    header->ownerPid = (uint32) getpid();
+
+    for (int i = 0; i < numStreams; i++)
+    {
+        TapLayout::StreamHeader& stream = header->streams[i];
+
+        streams[i].name.copyToUTF8(stream.name, TapLayout::MAX_NAME_LENGTH);
+        stream.streamId = streams[i].streamId;
+        stream.numChannels = streams[i].numChannels;
+        stream.sampleRate = streams[i].sampleRate;
+        stream.capacity = streams[i].capacity;
+        stream.dataOffset = dataOffsets[i];
+        stream.blockTimestamp = -1.0;
+    }
+
+    header->state.store(TapLayout::ACTIVE, std::memory_order_release);
+
+    LOGC("Data Tap: publishing ", numStreams, " streams to shared memory ", name, " (", size / (1024 * 1024), " MB).");
+
+    return true;
+#endif
+}
+
+void TapSegment::close()
+{
+    if (header == nullptr)
+        return;
+
+#if ! JUCE_WINDOWS
+    header->state.store(TapLayout::CLOSED, std::memory_order_release);
+
+    munmap(data, size);
+    shm_unlink(segmentName.toRawUTF8());
+#endif
+
+    header = nullptr;
+    data = nullptr;
+    size = 0;
+}
+
+void TapSegment::beginBlock(int streamIndex)
+{
+    std::atomic<uint64_t>& sequence = header->streams[streamIndex].sequence;
+
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void TapSegment::writeChannel(int streamIndex, int channel, const float* samples, int numSamples)
+{
+    const TapLayout::StreamHeader& stream = header->streams[streamIndex];
+
+    float* ring = reinterpret_cast<float*>(static_cast<char*>(data) + stream.dataOffset)
+                  + uint64(channel) * stream.capacity;
+
+    uint64 first = stream.samplesWritten.load(std::memory_order_relaxed);
+
+    /* Blocks longer than the ring only keep their most recent samples,
+       which still go to position index % capacity */
+    if (numSamples > (int) stream.capacity)
+    {
+        const int skipped = numSamples - (int) stream.capacity;
+
+        samples += skipped;
+        numSamples -= skipped;
+        first += skipped;
+    }
+
+    const uint64 position = first % stream.capacity;
+
+    const int firstPart = (int) jmin(uint64(numSamples), stream.capacity - position);
+
+    memcpy(ring + position, samples, firstPart * sizeof(float));
+    memcpy(ring, samples + firstPart, (numSamples - firstPart) * sizeof(float));
+}
+
+void TapSegment::endBlock(int streamIndex, int numSamples, int64 sampleNumber, double timestamp)
+{
+    TapLayout::StreamHeader& stream = header->streams[streamIndex];
+
+    const uint64 blockStart = stream.samplesWritten.load(std::memory_order_relaxed);
+
+    stream.blockStart = blockStart;
+    stream.blockSampleNumber = sampleNumber;
+    stream.blockTimestamp = timestamp;
+    stream.blockSamples = numSamples;
+    stream.maxBlockSamples = jmax(stream.maxBlockSamples, uint32(numSamples));
+
+    stream.samplesWritten.store(blockStart + numSamples, std::memory_order_release);
+    stream.sequence.store(stream.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void TapSegment::writeEvent(const TapLayout::EventRecord& record)
+{
+    if (header->eventCapacity == 0)
+        return;
+
+    const uint64 index = header->eventsWritten.load(std::memory_order_relaxed);
+
+    TapLayout::EventRecord* records = reinterpret_cast<TapLayout::EventRecord*>(static_cast<char*>(data) + header->eventOffset);
+
+    // readers must see the previous count before the oldest record is overwritten
+    std::atomic_thread_fence(std::memory_order_release);
+
+    records[index % header->eventCapacity] = record;
+
+    header->eventsWritten.store(index + 1, std::memory_order_release);
+}
+
+uint64 TapSegment::finishBlock()
+{
+    const uint64 blocks = header->blocksWritten.load(std::memory_order_relaxed) + 1;
+
+    header->blocksWritten.store(blocks, std::memory_order_release);
+
+    return blocks;
+}
@@ -0,0 +1,95 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __TAPSEGMENT_H_7B2D4E91__
+#define __TAPSEGMENT_H_7B2D4E91__
+
+#include <ProcessorHeaders.h>
+
+#include "DataTapLayout.h"
+
+/**
+
+    Creates and writes the shared-memory segment described in DataTapLayout.h.
+
+    Only one thread (the audio thread) may write to an open segment; create()
+    and close() are called from the message thread while it is not writing.
+    Shared memory is only available on Linux and macOS.
+
+*/
+class TapSegment
+{
+public:
+
+    /** Describes one stream to be published */
+    struct StreamSpec
+    {
+        String name;
+        uint16 streamId;
+        int numChannels;
+        float sampleRate;
+        int capacity;
+    };
+
+    /** Constructor */
+    TapSegment();
+
+    /** Destructor -- closes the segment */
+    ~TapSegment();
+
+    /** Closes any open segment and creates a new one; returns false if that fails */
+    bool create(const String& name, const Array<StreamSpec>& streams, int eventCapacity);
+
+    /** Marks the segment as closed and removes it */
+    void close();
+
+    /** Returns true if a segment is open */
+    bool isOpen() const { return header != nullptr; }
+
+    /** Starts writing a block to a stream's ring */
+    void beginBlock(int streamIndex);
+
+    /** Copies numSamples samples of one channel after the last complete block */
+    void writeChannel(int streamIndex, int channel, const float* samples, int numSamples);
+
+    /** Publishes a block whose channels have all been written */
+    void endBlock(int streamIndex, int numSamples, int64 sampleNumber, double timestamp);
+
+    /** Appends an event to the event ring */
+    void writeEvent(const TapLayout::EventRecord& record);
+
+    /** Counts a processed block; returns the new total */
+    uint64 finishBlock();
+
+private:
+
+    String segmentName;
+    void* data;
+    size_t size;
+
+    TapLayout::SegmentHeader* header;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TapSegment);
+};
+
+#endif  // __TAPSEGMENT_H_7B2D4E91__
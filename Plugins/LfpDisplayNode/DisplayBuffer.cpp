@@ -27,32 +27,59 @@ namespace LfpViewer {
 
 #define BUFFER_LENGTH_S 1.0f
 
+/** Bin size of the finest pyramid level, and the factor between levels */
+#define PYRAMID_BASE_BIN 16
+#define PYRAMID_FACTOR 4
+#define PYRAMID_LEVELS 4
+
+/** Duration of the decimated history kept for scrolling back while paused */
+#define HISTORY_LENGTH_S 600.0f
+
+namespace
+{
+    inline float sumOf(const float* data, int numSamples)
+    {
+        float total = 0.0f;
+
+        for (int i = 0; i < numSamples; i++)
+            total += data[i];
+
+        return total;
+    }
+}
+
 DisplayBuffer::DisplayBuffer(int id_, String name_, float sampleRate_) : 
-    id(id_), name(name_), sampleRate(sampleRate_), isNeeded(true)
+    id(id_), name(name_), sampleRate(sampleRate_), isNeeded(true),
+    samplesWritten(0), blockStartSample(0), blockStartIndex(0),
+    history(nullptr), numHistoryBins(0), historyBinsWritten(0)
 {
     previousSize = 0;
     numChannels = 0;
 
-    const int heapSize = 5000;
-    arrayOfOnes = new float[heapSize];
-    for (int n = 0; n < heapSize; ++n)
+    ttlState = 0;
+
+    int binSize = PYRAMID_BASE_BIN;
+
+    for (int level = 0; level < PYRAMID_LEVELS; level++)
     {
-        arrayOfOnes[n] = 1;
-    }
+        PyramidLevel* pyramidLevel = new PyramidLevel();
+        pyramidLevel->binSize = binSize;
+        pyramid.add(pyramidLevel);
 
-    ttlState = 0;
+        binSize *= PYRAMID_FACTOR;
+    }
 }
 
 DisplayBuffer::~DisplayBuffer()
 {
-    delete[] arrayOfOnes;
+    releaseHistory();
 }
 
 void DisplayBuffer::prepareToUpdate()
 {
     previousSize = numChannels;
     channelMetadata.clear();
-    channelMap.clear();
+    channelIndices.clear();
     numChannels = 0;
 
     isNeeded = false;
@@ -79,7 +106,12 @@ void DisplayBuffer::addChannel(
     metadata.description = description;
 
     channelMetadata.add(metadata);
-    channelMap[channelNum] = numChannels;
+
+    if (channelNum >= int(channelIndices.size()))
+        channelIndices.resize(channelNum + 1, -1);
+
+    channelIndices[channelNum] = numChannels;
+
     numChannels++;
 
     isNeeded = true;
@@ -90,21 +122,192 @@ void DisplayBuffer::addChannel(
 void DisplayBuffer::update()
 {
             
-    if (numChannels != previousSize)
-        setSize(numChannels + 1, int(sampleRate * BUFFER_LENGTH_S));
+    // round up to a whole number of the largest bins, so that no bin wraps
+    const int largestBin = pyramid.getLast()->binSize;
+    const int bufferSize = (int(sampleRate * BUFFER_LENGTH_S) + largestBin - 1) / largestBin * largestBin;
 
-    clear();
+    if (numChannels != previousSize || bufferSize != getNumSamples())
+    {
+        setSize(numChannels + 1, bufferSize);
+
+        for (auto level : pyramid)
+        {
+            level->minimum.setSize(numChannels + 1, bufferSize / level->binSize);
+            level->maximum.setSize(numChannels + 1, bufferSize / level->binSize);
+            level->sum.setSize(numChannels + 1, bufferSize / level->binSize);
+        }
+    }
 
-    displayBufferIndices.clear();
+    allocateHistory();
 
-    for (int i = 0; i <= numChannels; i++)
-        displayBufferIndices.set(i, 0);
+    clear();
+
+    resetIndices();
 }
 
 void DisplayBuffer::resetIndices()
 {
-    for (int i = 0; i <= numChannels; i++)
-        displayBufferIndices.set(i, 0);
+    // the buffer index is derived from the sample count, so bins stay aligned with the history
+    blockStartSample = 0;
+    blockStartIndex = 0;
+
+    samplesWritten.store(0, std::memory_order_release);
+
+    historyBinsWritten = 0;
+}
+
+void DisplayBuffer::allocateHistory()
+{
+    const int binSize = pyramid.getLast()->binSize;
+    const int bins = jmax(1, int(std::ceil(sampleRate * HISTORY_LENGTH_S / binSize)));
+
+    const size_t numValues = size_t(numChannels + 1) * size_t(bins) * 2;
+    const size_t numBytes = numValues * sizeof(float);
+
+    if (history != nullptr
+        && bins == numHistoryBins
+        && (historyMapping != nullptr ? historyMapping->getSize() == numBytes : historyFallback != nullptr))
+        return;
+
+    releaseHistory();
+
+    numHistoryBins = bins;
+
+    historyFile = File::getSpecialLocation(File::tempDirectory)
+                      .getNonexistentChildFile("lfp-history-" + String(id), ".bin", false);
+
+    bool fileCreated = false;
+
+    {
+        // extending the file leaves it sparse, so no disk space is used until the history fills up
+        FileOutputStream output(historyFile);
+
+        if (output.openedOk() && output.setPosition(int64(numBytes) - 1))
+            fileCreated = output.writeByte(0);
+    }
+
+    if (fileCreated)
+    {
+        historyMapping = std::make_unique<MemoryMappedFile>(historyFile, MemoryMappedFile::readWrite);
+
+        if (historyMapping->getData() != nullptr && historyMapping->getSize() == numBytes)
+            history = static_cast<float*>(historyMapping->getData());
+        else
+            historyMapping.reset();
+    }
+
+    if (history == nullptr)
+    {
+        LOGD("Unable to map LFP history file for ", name, "; keeping history in memory");
+
+        historyFile.deleteFile();
+        historyFallback.calloc(numValues);
+        history = historyFallback.getData();
+    }
+}
+
+void DisplayBuffer::releaseHistory()
+{
+    history = nullptr;
+    numHistoryBins = 0;
+
+    // the mapping has to be closed before the file can be deleted
+    historyMapping.reset();
+    historyFallback.free();
+
+    if (historyFile != File())
+    {
+        historyFile.deleteFile();
+        historyFile = File();
+    }
+}
+
+void DisplayBuffer::updateHistory()
+{
+    const PyramidLevel* coarsest = pyramid.getLast();
+    const int numBins = coarsest->minimum.getNumSamples();
+
+    if (history == nullptr || numBins == 0)
+        return;
+
+    const int64 completedBins = getSamplesWritten() / coarsest->binSize;
+
+    if (completedBins <= historyBinsWritten)
+        return;
+
+    // the oldest bins of the pyramid may already be overwritten by the block being written
+    // (which is much shorter than the display buffer), so only the newest half is copied;
+    // bins that were not copied in time are marked as missing
+    const int64 firstCopiedBin = jmax(historyBinsWritten, completedBins - numBins / 2);
+    const int64 firstBin = jmax(historyBinsWritten, completedBins - numHistoryBins);
+
+    for (int channelIndex = 0; channelIndex <= numChannels; channelIndex++)
+    {
+        float* row = history + size_t(channelIndex) * size_t(numHistoryBins) * 2;
+
+        const float* minimum = coarsest->minimum.getReadPointer(channelIndex);
+        const float* maximum = coarsest->maximum.getReadPointer(channelIndex);
+
+        for (int64 bin = firstBin; bin < completedBins; bin++)
+        {
+            float* entry = row + (bin % numHistoryBins) * 2;
+
+            if (bin < firstCopiedBin)
+            {
+                entry[0] = std::numeric_limits<float>::quiet_NaN();
+                entry[1] = std::numeric_limits<float>::quiet_NaN();
+            }
+            else
+            {
+                entry[0] = minimum[bin % numBins];
+                entry[1] = maximum[bin % numBins];
+            }
+        }
+    }
+
+    historyBinsWritten = completedBins;
+}
+
+int64 DisplayBuffer::getHistoryLength() const
+{
+    return int64(numHistoryBins) * pyramid.getLast()->binSize;
+}
+
+bool DisplayBuffer::getHistoryRange(int channelIndex, int64 startSample, int64 endSample,
+                                    float& minimum, float& maximum) const
+{
+    if (history == nullptr || channelIndex < 0 || channelIndex > numChannels)
+        return false;
+
+    const int binSize = pyramid.getLast()->binSize;
+    const int64 oldestBin = jmax(int64(0), historyBinsWritten - numHistoryBins);
+
+    const int64 firstBin = jmax(oldestBin, startSample >= 0 ? startSample / binSize : int64(0));
+    const int64 lastBin = jmin(historyBinsWritten, endSample > 0 ? (endSample + binSize - 1) / binSize : int64(0));
+
+    if (firstBin >= lastBin)
+        return false;
+
+    const float* row = history + size_t(channelIndex) * size_t(numHistoryBins) * 2;
+
+    minimum = std::numeric_limits<float>::max();
+    maximum = std::numeric_limits<float>::lowest();
+
+    bool found = false;
+
+    for (int64 bin = firstBin; bin < lastBin; bin++)
+    {
+        const float* entry = row + (bin % numHistoryBins) * 2;
+
+        if (! (entry[0] <= entry[1]))
+            continue; // missing (NaN) bin
+
+        minimum = jmin(minimum, entry[0]);
+        maximum = jmax(maximum, entry[1]);
+        found = true;
+    }
+
+    return found;
 }
 
 void DisplayBuffer::addDisplay(int splitID)
@@ -125,36 +328,15 @@ void DisplayBuffer::removeDisplay(int splitID)
 
 void DisplayBuffer::initializeEventChannel(int nSamples)
 {
+    // every row of this block is written from the published position onwards,
+    // but none of it becomes visible to the display until publish() is called
+    blockStartSample = samplesWritten.load(std::memory_order_relaxed);
+    blockStartIndex = getNumSamples() > 0 ? int(blockStartSample % getNumSamples()) : 0;
+
     if (displays.size() == 0)
         return;
 
-    const int samplesLeft = getNumSamples() - displayBufferIndices[numChannels];
-
-    if (nSamples < samplesLeft)
-    {
-
-        copyFrom(numChannels,                   // destChannel
-            displayBufferIndices[numChannels],  // destStartSample
-            arrayOfOnes,                        // source
-            nSamples,                           // numSamples
-            float(ttlState));                   // gain
-    }
-    else
-    {
-        int extraSamples = nSamples - samplesLeft;
-
-        copyFrom(numChannels,                   // destChannel
-            displayBufferIndices[numChannels],  // destStartSample
-            arrayOfOnes,                        // source
-            samplesLeft,                        // numSamples
-            float(ttlState));                   // gain
-
-        copyFrom(numChannels,                   // destChannel
-            0,                                  // destStartSample
-            arrayOfOnes,                        // source
-            extraSamples,                       // numSamples
-            float(ttlState));                   // gain
-    }
+    fillEventChannel(blockStartIndex, nSamples);
 }
 
 void DisplayBuffer::finalizeEventChannel(int nSamples)
@@ -163,21 +345,15 @@ void DisplayBuffer::finalizeEventChannel(int nSamples)
     if (displays.size() == 0)
         return;
 
-    const int index = displayBufferIndices[numChannels];
-    const int samplesLeft = getNumSamples() - index;
-   
-    int newIdx = 0;
+    updatePyramidForBlock(numChannels, nSamples);
+}
 
-    if (nSamples < samplesLeft)
-    {
-        newIdx = displayBufferIndices[numChannels] + nSamples;
-    }
-    else
-    {
-        newIdx = nSamples - samplesLeft;
-    }
-        
-    displayBufferIndices.set(numChannels, newIdx);
+void DisplayBuffer::publish(int nSamples)
+{
+    if (displays.size() == 0)
+        return;
+
+    samplesWritten.store(blockStartSample + nSamples, std::memory_order_release);
 }
 
 void DisplayBuffer::addEvent(int eventTime, int eventChannel, int eventId, int numSourceSamples)
@@ -189,10 +365,6 @@ void DisplayBuffer::addEvent(int eventTime, int eventChannel, int eventId, int n
     if (eventTime > numSourceSamples)
         eventTime = numSourceSamples;
 
-    const int index = (displayBufferIndices[numChannels] + eventTime) % getNumSamples();
-    const int samplesLeft = getNumSamples() - index;
-    const int nSamples = numSourceSamples - eventTime;
-
     if (eventId == 1)
     {
         ttlState |= (1LL << eventChannel);
@@ -201,81 +373,171 @@ void DisplayBuffer::addEvent(int eventTime, int eventChannel, int eventId, int n
         ttlState &= ~(1LL << eventChannel);
     }
 
-    if (nSamples < samplesLeft)
+    // the new state holds until the end of the block
+    fillEventChannel((blockStartIndex + eventTime) % getNumSamples(), numSourceSamples - eventTime);
+}
+
+void DisplayBuffer::fillEventChannel(int startSample, int nSamples)
+{
+    const int firstPart = jmin(nSamples, getNumSamples() - startSample);
+
+    FloatVectorOperations::fill(getWritePointer(numChannels, startSample), float(ttlState), firstPart);
+
+    if (nSamples > firstPart)
+        FloatVectorOperations::fill(getWritePointer(numChannels, 0), float(ttlState), nSamples - firstPart);
+}
+
+void DisplayBuffer::addData(AudioBuffer<float>& buffer, int chan, int nSamples)
+{
+    if (displays.size() == 0 || chan >= int(channelIndices.size()))
+        return;
+
+    const int channelIndex = channelIndices[chan];
+
+    if (channelIndex < 0)
+        return;
+
+    const float* source = buffer.getReadPointer(chan);
+    const int firstPart = jmin(nSamples, getNumSamples() - blockStartIndex);
+
+    // one copy per channel, or two if the block wraps around the end of the buffer
+    FloatVectorOperations::copy(getWritePointer(channelIndex, blockStartIndex), source, firstPart);
+
+    if (nSamples > firstPart)
+        FloatVectorOperations::copy(getWritePointer(channelIndex, 0), source + firstPart, nSamples - firstPart);
+
+    updatePyramidForBlock(channelIndex, nSamples);
+}
+
+void DisplayBuffer::updatePyramidForBlock(int channelIndex, int nSamples)
+{
+    const int firstPart = jmin(nSamples, getNumSamples() - blockStartIndex);
+
+    updatePyramid(channelIndex, blockStartIndex, firstPart);
+    updatePyramid(channelIndex, 0, nSamples - firstPart);
+}
+
+void DisplayBuffer::updatePyramid(int channelIndex, int startSample, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    const int endSample = startSample + numSamples;
+
+    for (int level = 0; level < pyramid.size(); level++)
+    {
+        PyramidLevel* current = pyramid[level];
+
+        // bins whose last sample was written by this call
+        const int firstBin = startSample / current->binSize;
+        const int lastBin = endSample / current->binSize;
+
+        if (firstBin >= lastBin)
+            return; // no coarser bin can have been completed either
+
+        float* minimum = current->minimum.getWritePointer(channelIndex);
+        float* maximum = current->maximum.getWritePointer(channelIndex);
+        float* sum = current->sum.getWritePointer(channelIndex);
+
+        if (level == 0)
+        {
+            for (int bin = firstBin; bin < lastBin; bin++)
+            {
+                const float* samples = getReadPointer(channelIndex, bin * current->binSize);
+                const Range<float> range = FloatVectorOperations::findMinAndMax(samples, current->binSize);
+
+                minimum[bin] = range.getStart();
+                maximum[bin] = range.getEnd();
+                sum[bin] = sumOf(samples, current->binSize);
+            }
+        }
+        else
+        {
+            const PyramidLevel* previous = pyramid[level - 1];
+            const int factor = current->binSize / previous->binSize;
+
+            for (int bin = firstBin; bin < lastBin; bin++)
+            {
+                const int child = bin * factor;
+
+                minimum[bin] = FloatVectorOperations::findMinimum(previous->minimum.getReadPointer(channelIndex, child), factor);
+                maximum[bin] = FloatVectorOperations::findMaximum(previous->maximum.getReadPointer(channelIndex, child), factor);
+                sum[bin] = sumOf(previous->sum.getReadPointer(channelIndex, child), factor);
+            }
+        }
+    }
+}
+
+void DisplayBuffer::summarize(int channelIndex, int level, int startSample, int endSample,
+                              float& minimum, float& maximum, float& sum) const
+{
+    if (endSample <= startSample)
+        return;
+
+    if (level < 0)
     {
-        copyFrom(numChannels,                     // destChannel
-            index,                                // destStartSample
-            arrayOfOnes,                          // source
-            nSamples,                             // numSamples
-            float(ttlState));                     // gain
+        const float* samples = getReadPointer(channelIndex, startSample);
+        const Range<float> range = FloatVectorOperations::findMinAndMax(samples, endSample - startSample);
+
+        minimum = jmin(minimum, range.getStart());
+        maximum = jmax(maximum, range.getEnd());
+        sum += sumOf(samples, endSample - startSample);
+
+        return;
     }
-    else
+
+    const PyramidLevel* current = pyramid[level];
+
+    const int firstBin = (startSample + current->binSize - 1) / current->binSize;
+    const int lastBin = endSample / current->binSize;
+
+    if (firstBin >= lastBin)
     {
-        int extraSamples = nSamples - samplesLeft;
-
-        copyFrom(numChannels,                     // destChannel
-            index,                                // destStartSample
-            arrayOfOnes,                          // source
-            samplesLeft,                          // numSamples
-            float(ttlState));                     // gain
-
-        copyFrom(numChannels,                     // destChannel
-            0,                                    // destStartSample
-            arrayOfOnes,                          // source
-            extraSamples,                         // numSamples
-            float(ttlState));                     // gain
+        summarize(channelIndex, level - 1, startSample, endSample, minimum, maximum, sum);
+        return;
     }
+
+    // partial bins at either end are handled by the finer levels
+    summarize(channelIndex, level - 1, startSample, firstBin * current->binSize, minimum, maximum, sum);
+
+    const int numBins = lastBin - firstBin;
+
+    minimum = jmin(minimum, FloatVectorOperations::findMinimum(current->minimum.getReadPointer(channelIndex, firstBin), numBins));
+    maximum = jmax(maximum, FloatVectorOperations::findMaximum(current->maximum.getReadPointer(channelIndex, firstBin), numBins));
+    sum += sumOf(current->sum.getReadPointer(channelIndex, firstBin), numBins);
+
+    summarize(channelIndex, level - 1, lastBin * current->binSize, endSample, minimum, maximum, sum);
 }
 
-void DisplayBuffer::addData(AudioBuffer<float>& buffer, int chan, int nSamples)
+void DisplayBuffer::getRangeSummary(int channelIndex, int startSample, int numSamples,
+                                    float& minimum, float& maximum, float& sum) const
 {
-    if (displays.size() == 0)
+    minimum = std::numeric_limits<float>::max();
+    maximum = std::numeric_limits<float>::lowest();
+    sum = 0.0f;
+
+    numSamples = jmin(numSamples, getNumSamples());
+
+    if (numSamples <= 0)
         return;
 
-    int previousIndex = displayBufferIndices[channelMap[chan]];
-    int channelIndex = channelMap[chan];
+    // start at the coarsest level whose bins fit in the range
+    int level = pyramid.size() - 1;
 
-    const int samplesLeft = getNumSamples() - displayBufferIndices[channelMap[chan]];
-    
-    int newIndex;
-        
-    if (nSamples < samplesLeft)
-    {
-        copyFrom(channelMap[chan],                   // destChannel
-            displayBufferIndices[channelMap[chan]],  // destStartSample
-            buffer,                                  // source
-            chan,                                    // source channel
-            0,                                       // source start sample
-            nSamples);                               // numSamples
+    while (level >= 0 && pyramid[level]->binSize > numSamples)
+        level--;
 
-        int lastIndex = displayBufferIndices[channelMap[chan]];
+    const int samplesLeft = getNumSamples() - startSample;
 
-        newIndex = lastIndex + nSamples;
-            
+    if (numSamples <= samplesLeft)
+    {
+        summarize(channelIndex, level, startSample, startSample + numSamples, minimum, maximum, sum);
     }
     else
     {
-        const int extraSamples = nSamples - samplesLeft;
-
-        copyFrom(channelMap[chan],                   // destChannel
-            displayBufferIndices[channelMap[chan]],  // destStartSample
-            buffer,                                  // source
-            chan,                                    // source channel
-            0,                                       // source start sample
-            samplesLeft);                            // numSamples
-
-        copyFrom(channelMap[chan],                   // destChannel
-            0,                                       // destStartSample
-            buffer,                                  // source
-            chan,                                    // source channel
-            samplesLeft,                             // source start sample
-            extraSamples);                           // numSamples
-
-        newIndex = extraSamples;
+        summarize(channelIndex, level, startSample, getNumSamples(), minimum, maximum, sum);
+        summarize(channelIndex, level, 0, numSamples - samplesLeft, minimum, maximum, sum);
     }
-
-    displayBufferIndices.set(channelMap[chan], newIndex);
-
 }
 
 };
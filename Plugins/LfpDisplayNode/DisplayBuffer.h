@@ -25,7 +25,8 @@
 
 #include <ProcessorHeaders.h>
 
-#include <map>
+#include <atomic>
+#include <vector>
 
 namespace LfpViewer {
 #pragma  mark - LfpDisplay -
@@ -37,6 +38,11 @@ namespace LfpViewer {
         Data is transferred from the displayBuffer to the screenBuffer, 
         after which it is drawn.
 
+        The buffer is a single-producer, single-consumer ring: the audio thread
+        writes every row of a block at the same position, then publishes the new
+        sample count with one atomic store. The display only reads samples up to
+        the published position, so all rows it sees belong to complete blocks.
+
     */
     class DisplayBuffer : public AudioBuffer<float>
     {
@@ -70,6 +76,10 @@ namespace LfpViewer {
         /** Cleans up the event channel at the end of each buffer*/
         void finalizeEventChannel(int nSamples);
 
+        /** Makes the block written since initializeEventChannel() visible to the display.
+            Called once per block, after the data for all channels has been added. */
+        void publish(int nSamples);
+
         /** Sets buffer indices to zero */
         void resetIndices();
 
@@ -79,7 +89,37 @@ namespace LfpViewer {
         /** Adds continuous data*/
         void addData(AudioBuffer<float>& buffer, int chan, int nSamples);
 
-        CriticalSection* getMutex() { return &displayMutex; }
+        /** Computes the minimum, maximum, and sum of numSamples values of one buffer channel,
+            starting at startSample and wrapping around the end of the buffer.
+            Cost is proportional to the number of pyramid levels, not the number of samples. */
+        void getRangeSummary(int channelIndex, int startSample, int numSamples,
+                             float& minimum, float& maximum, float& sum) const;
+
+        /** Returns the number of samples published since the indices were last reset.
+            Every row of the buffer holds the same samples. */
+        int64 getSamplesWritten() const { return samplesWritten.load(std::memory_order_acquire); }
+
+        /** Returns the buffer index that follows the newest published sample */
+        int getWriteIndex() const { return getNumSamples() > 0 ? int(getSamplesWritten() % getNumSamples()) : 0; }
+
+        /** Returns the buffer index at which the current block is being written (audio thread only) */
+        int getBlockStartIndex() const { return blockStartIndex; }
+
+        /** Returns the sample number of the first sample of the current block (audio thread only) */
+        int64 getBlockStartSample() const { return blockStartSample; }
+
+        /** Appends the coarsest pyramid bins published since the last call to the long-term history.
+            Called regularly from the message thread, so the audio thread never touches the history file. */
+        void updateHistory();
+
+        /** Returns the number of samples covered by the long-term history */
+        int64 getHistoryLength() const;
+
+        /** Computes the minimum and maximum of a buffer channel between two sample numbers
+            (as counted by getSamplesWritten()), using the long-term history. Resolution is one
+            coarsest pyramid bin. Returns false if no part of the range is held any more. */
+        bool getHistoryRange(int channelIndex, int64 startSample, int64 endSample,
+                             float& minimum, float& maximum) const;
 
         struct ChannelMetadata {
             String name = "";
@@ -97,14 +137,9 @@ namespace LfpViewer {
         int id;
 
         int64 bufferIndex;
-        std::map<int, int> channelMap;
-
-        Array<int> displayBufferIndices;
 
         int numChannels;
 
-        float* arrayOfOnes;
-
         int previousSize;
 
         float sampleRate;
@@ -116,8 +151,6 @@ namespace LfpViewer {
         int latestTriggerTime;
         int latestCurrentTriggerTime;
 
-        CriticalSection displayMutex;
-
         bool isNeeded;
 
         void addDisplay(int splitID);
@@ -126,6 +159,63 @@ namespace LfpViewer {
 
         Array<int> displays;
 
+    private:
+
+        /** Summary of consecutive, non-overlapping bins of samples.
+            Bins are aligned to the start of the buffer, so they never wrap. */
+        struct PyramidLevel
+        {
+            int binSize;
+            AudioBuffer<float> minimum;
+            AudioBuffer<float> maximum;
+            AudioBuffer<float> sum;
+        };
+
+        /** Levels of increasing bin size (each a multiple of the previous one) */
+        OwnedArray<PyramidLevel> pyramid;
+
+        /** Summarizes any bins that were completed by writing [startSample, startSample + numSamples) */
+        void updatePyramid(int channelIndex, int startSample, int numSamples);
+
+        /** Updates the pyramid of one row after writing the current block */
+        void updatePyramidForBlock(int channelIndex, int nSamples);
+
+        /** Writes the current TTL state to the event channel, wrapping around the end of the buffer */
+        void fillEventChannel(int startSample, int nSamples);
+
+        /** Accumulates the summary of [startSample, endSample) using the given level and those below it */
+        void summarize(int channelIndex, int level, int startSample, int endSample,
+                       float& minimum, float& maximum, float& sum) const;
+
+        /** (Re)allocates the history for the current number of channels and sample rate */
+        void allocateHistory();
+
+        /** Unmaps and deletes the file backing the history */
+        void releaseHistory();
+
+        /** Buffer channel for each input channel of the node (-1 for channels of other streams) */
+        std::vector<int> channelIndices;
+
+        /** Published sample count (written by the audio thread, read by the display) */
+        std::atomic<int64> samplesWritten;
+
+        /** Position of the block currently being written (audio thread only) */
+        int64 blockStartSample;
+        int blockStartIndex;
+
+        /** Ring of (minimum, maximum) pairs, one per coarsest pyramid bin, for the last
+            HISTORY_LENGTH_S seconds of each buffer channel. Kept in a memory-mapped
+            temporary file, as it can be much larger than the display buffer itself.
+            Only updated on the message thread. */
+        std::unique_ptr<MemoryMappedFile> historyMapping;
+        File historyFile;
+        HeapBlock<float> historyFallback;
+        float* history;
+        int numHistoryBins;
+
+        /** Number of coarsest bins appended to the history since the indices were last reset */
+        int64 historyBinsWritten;
+
     };
 };
 
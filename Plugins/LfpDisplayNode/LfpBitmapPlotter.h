@@ -48,6 +48,26 @@ public:
     
     /** Plots one subsample of data from a single channel to the bitmap provided */
     virtual void plot(Image::BitmapData &bitmapData, LfpBitmapPlotterInfo &plotterInfo) = 0;
+
+    /** Sets every yStep-th pixel of column x between yFrom and yTo (inclusive) by writing
+        directly into the bitmap's memory. The bitmap must use the ARGB format. */
+    static void fillColumn(const Image::BitmapData& bitmapData, int x, int yFrom, int yTo,
+                           PixelARGB colour, int yStep = 1)
+    {
+        jassert(bitmapData.pixelFormat == Image::ARGB);
+
+        yFrom = jmax(yFrom, 0);
+        yTo = jmin(yTo, bitmapData.height - 1);
+
+        if (x < 0 || x >= bitmapData.width || yFrom > yTo)
+            return;
+
+        uint8* pixel = bitmapData.getPixelPointer(x, yFrom);
+        const int stride = bitmapData.lineStride * yStep;
+
+        for (int y = yFrom; y <= yTo; y += yStep, pixel += stride)
+            *reinterpret_cast<PixelARGB*>(pixel) = colour;
+    }
     
 protected:
     LfpDisplay * display;
@@ -114,53 +114,49 @@ void LfpChannelDisplay::setHidden(bool isHidden_)
     isHidden = isHidden_;
 }
 
-void LfpChannelDisplay::pxPaint()
+LfpChannelDisplay::ColumnBounds LfpChannelDisplay::getColumnBounds(int bitmapHeight)
+{
+    ColumnBounds bounds;
+
+    bounds.centre = getY() + getHeight() / 2;
+
+    // max and min of channel in absolute px coords for event displays etc - actual data might be drawn outside of this range
+    bounds.top = (int) (bounds.centre - channelHeight / 2) + 1;
+    bounds.bottom = (int) (bounds.centre + channelHeight / 2);
+
+    // max and min of channel, this is the range where actual data is drawn
+    bounds.clipTop = (int) (bounds.centre - (channelHeight) * canvasSplit->channelOverlapFactor) + 1;
+    bounds.clipBottom = (int) (bounds.centre + (channelHeight) * canvasSplit->channelOverlapFactor);
+
+    if (bounds.top < 0) { bounds.top = 0; };
+    if (bounds.bottom >= bitmapHeight) { bounds.bottom = bitmapHeight - 1; };
+
+    // the median offset is constant across columns, so it is only computed once per paint
+    bounds.offset = display->getMedianOffsetPlotting()
+                  ? canvasSplit->getMean(chan) / range * channelHeightFloat
+                  : 0.0;
+
+    return bounds;
+}
+
+void LfpChannelDisplay::pxPaint(Image::BitmapData& bitmapData)
 {
     if (!isEnabled || isHidden || getWidth() == 0)
     {
         return; // return early if THIS display is not enabled
     }
 
-    Image::BitmapData bdLfpChannelBitmap(display->lfpChannelBitmap, 0,0, display->lfpChannelBitmap.getWidth(), display->lfpChannelBitmap.getHeight());
-    
-    int center = getHeight()/2;
+    const ColumnBounds bounds = getColumnBounds(bitmapData.height);
 
-    //int ifrom = canvasSplit->lastScreenBufferIndex[0]; // base everything on the first channel
-    //int ito = screenBufferIndex;
-    
-    // max and min of channel in absolute px coords for event displays etc - actual data might be drawn outside of this range
-    int jfrom_wholechannel= (int) (getY()+center-channelHeight/2)+1 +0 ;
-    int jto_wholechannel= (int) (getY()+center+channelHeight/2) -0;
-    
-    // max and min of channel, this is the range where actual data is drawn
-    int jfrom_wholechannel_clip= (int) (getY()+center-(channelHeight)*canvasSplit->channelOverlapFactor) + 1;
-    int jto_wholechannel_clip  = (int) (getY()+center+(channelHeight)*canvasSplit->channelOverlapFactor) - 0;
-    
-    if (jfrom_wholechannel<0) {jfrom_wholechannel=0;};
-    if (jto_wholechannel >= display->lfpChannelBitmap.getHeight()) {jto_wholechannel=display->lfpChannelBitmap.getHeight()-1;};
-    
     // draw most recent drawn sample position
-    if (ito_local < display->lfpChannelBitmap.getWidth() - 1)
+    if (ito_local < bitmapData.width - 1)
     {
-        for (int k = jfrom_wholechannel; k <= jto_wholechannel; k += 2) // draw line
-        {
-            bdLfpChannelBitmap.setPixelColour(ito_local + 1, k, Colours::yellow);
-        }
-            
+        LfpBitmapPlotter::fillColumn(bitmapData, ito_local + 1, bounds.top, bounds.bottom,
+                                     Colours::yellow.getPixelARGB(), 2);
     }
-    
-    bool clipWarningHi = false; // keep track if something clipped in the display, so we can draw warnings after the data pixels are done
-    bool clipWarningLo = false;
-    
-    bool saturateWarningHi = false; // similar, but for saturating the amplifier, not just the display - make this warning very visible
-    bool saturateWarningLo = false;
-     
-    int stepSize = 1;
-    int from = 0;
-    int to = 0;
+
     int endIndex;
     
-    
     if (ito < ifrom)
         endIndex = ito + canvasSplit->screenBufferWidth;
     else
@@ -176,459 +172,223 @@ void LfpChannelDisplay::pxPaint()
         fullredraw = false;
     }
 
-    //if (chan == 0)
-	//{
-	//	std::cout << "Channel 0 drawing from " << ifrom_local << " to " << ito_local << std::endl;
-	//}
-    
-    bool drawWithOffsetCorrection = display->getMedianOffsetPlotting();
-    
-    LfpBitmapPlotterInfo plotterInfo; // hold and pass plotting info for each plotting method class
-    
     for (int ii = ifrom; ii <= endIndex; ii++)
     {
-
         int i = (ifrom_local + ii - ifrom) % getWidth();
         int index = ii % canvasSplit->screenBufferWidth;
 
-        //draw zero line
-        int m = getY() + center;
-            
-        if (m > 0 && m < display->lfpChannelBitmap.getHeight())
-        {
-            bdLfpChannelBitmap.setPixelColour(i,m,Colour(50,50,50));
-            
-        }
-            
-        //draw range markers
-        if (isSelected)
-        {
-            int start = getY()+center -channelHeight/2;
-            int jump = channelHeight/4;
-                
-            for (m = start; m <= start + jump*4; m += jump)
-            {
-                if (m > 0 && m < display->lfpChannelBitmap.getHeight())
-                {
-                    //if ( bdLfpChannelBitmap.getPixelColour(i,m).isTransparent()) // make sure we're not drawing over an existing plot from another channel
-                        bdLfpChannelBitmap.setPixelColour(i, m, Colour(80,80,80));
-                }
-            }
-        }
-        
-        // draw event markers
-        const int rawEventState = canvasSplit->getEventState(index); // get event state
-            
-        for (int ev_ch = 0; ev_ch < 8; ev_ch++) // for all event channels
-        {
-            if (display->getEventDisplayState(ev_ch))  // check if plotting for this channel is enabled
-            {
-                if (rawEventState & (1 << ev_ch))    // events are  represented by a bit code, so we have to extract the individual bits with a mask
-                {
-                    //                        std::cout << "Drawing event." << std::endl;
-                    const Colour currentcolor = display->channelColours[ev_ch * 2];
-
-                    for (int k = jfrom_wholechannel; k <= jto_wholechannel; k++) // draw line
-                    {
-                        bdLfpChannelBitmap.setPixelColour(i,
-                                              k,
-                                              bdLfpChannelBitmap.getPixelColour(i, k).interpolatedWith(currentcolor, 0.3f));
-                    }
-                        
-                }
-            }
-        }
-            
-        // set max-min range for plotting
-        double a = (canvasSplit->getYCoordMax(chan, index)/range*channelHeightFloat);
-        double b = (canvasSplit->getYCoordMin(chan, index)/range*channelHeightFloat);
-            
-        double mean = (canvasSplit->getMean(chan)/range*channelHeightFloat);
-            
-        if (drawWithOffsetCorrection)
-        {
-            a -= mean;
-            b -= mean;
-        }
-            
-        double a_raw = canvasSplit->getYCoordMax(chan, index);
-        double b_raw = canvasSplit->getYCoordMin(chan, index);
-        double from_raw = 0; double to_raw = 0;
-            
-        if (a < b)
-        {
-            from = (a); to = (b);
-            from_raw = (a_raw); to_raw = (b_raw);
-                
-        }
-        else
-        {
-            from = (b); to = (a);
-            from_raw = (b_raw); to_raw = (a_raw);
-        }
-            
-        // start by clipping so that we're not populating pixels that we dont want to plot
-        int lm= channelHeightFloat*canvasSplit->channelOverlapFactor;
-        if (lm>0)
-            lm=-lm;
-            
-        if (from > -lm) {from = -lm; clipWarningHi=true;};
-        if (to > -lm) {to = -lm; clipWarningHi=true;};
-        if (from < lm) {from = lm; clipWarningLo=true;};
-        if (to < lm) {to = lm; clipWarningLo=true;};
-            
-        // test if raw data is clipped for displaying saturation warning
-        if (from_raw > options->selectedSaturationValueFloat) { saturateWarningHi=true;};
-        if (to_raw > options->selectedSaturationValueFloat) { saturateWarningHi=true;};
-        if (from_raw < -options->selectedSaturationValueFloat) { saturateWarningLo=true;};
-        if (to_raw < -options->selectedSaturationValueFloat) { saturateWarningLo=true;};
-            
-        bool spikeFlag = display->getSpikeRasterPlotting()
-            && (from_raw - canvasSplit->getYCoordMean(chan, index) < display->getSpikeRasterThreshold()
-                    || to_raw - canvasSplit->getYCoordMean(chan, index) < display->getSpikeRasterThreshold());
-  
-        from = from + getHeight()/2;       // so the plot is centered in the channeldisplay
-        to = to + getHeight()/2;
-            
-        int samplerange = to - from;
-            
-        plotterInfo.channelID = chan;
-        plotterInfo.y = getY();
-        plotterInfo.from = from;
-        plotterInfo.to = to;
-        plotterInfo.samp = i;
-        plotterInfo.lineColour = lineColour;
-                
-        // Do the actual plotting for the selected plotting method
-        if (!display->getSpikeRasterPlotting())
-            display->getPlotterPtr()->plot(bdLfpChannelBitmap, plotterInfo);
-            
-        // now draw warnings, if needed
-        if (canvasSplit->drawClipWarning) // draw simple warning if display cuts off data
-        {
-                
-            if(clipWarningHi) {
-                for (int j=0; j<=3; j++)
-                {
-                    int clipmarker = jto_wholechannel_clip;
-                        
-                    if(clipmarker>0 && clipmarker<display->lfpChannelBitmap.getHeight()){
-                        bdLfpChannelBitmap.setPixelColour(i,clipmarker-j,Colour(255,255,255));
-                    }
-                }
-            }
-                
-            if(clipWarningLo) {
-                for (int j=0; j<=3; j++)
-                {
-                    int clipmarker = jfrom_wholechannel_clip;
-                        
-                    if(clipmarker>0 && clipmarker<display->lfpChannelBitmap.getHeight()){
-                        bdLfpChannelBitmap.setPixelColour(i,clipmarker+j,Colour(255,255,255));
-                    }
-                }
-            }
-                
-            clipWarningHi=false;
-            clipWarningLo=false;
-        }
-            
-        if (spikeFlag) // draw spikes
-        {
-            for (int k = jfrom_wholechannel; k <= jto_wholechannel; k++){ // draw line
-                if (k > 0 && k < display->lfpChannelBitmap.getHeight()){
-                    bdLfpChannelBitmap.setPixelColour(i,k,lineColour);
-                }
-            };
-        }
-            
-        if (canvasSplit->drawSaturationWarning) // draw bigger warning if actual data gets cuts off
-        {
-                
-            if(saturateWarningHi || saturateWarningLo) {
-                    
-                for (int k=jfrom_wholechannel; k<=jto_wholechannel; k++){ // draw line
-                    Colour thiscolour=Colour(255,0,0);
-                    if (fmod((i+k),50)>25){
-                        thiscolour=Colour(255,255,255);
-                    }
-                    if(k>0 && k<display->lfpChannelBitmap.getHeight()){
-                        bdLfpChannelBitmap.setPixelColour(i,k,thiscolour);
-                    }
-                };
-            }
-                
-            saturateWarningHi=false; // we likely just need one of this because for this warning we dont care if its saturating on the positive or negative side
-            saturateWarningLo=false;
-
-        } // if i < getWidth()
-        
-    } //  for (int index = ifrom; index < ito; index++)
+        drawColumn(bitmapData, i,
+                   canvasSplit->getYCoordMin(chan, index),
+                   canvasSplit->getYCoordMax(chan, index),
+                   canvasSplit->getYCoordMean(chan, index),
+                   (int) canvasSplit->getEventState(index),
+                   bounds);
+    }
 
 }
 
 
-void LfpChannelDisplay::pxPaintHistory(int playhead, int rightEdge, int maxScreenBufferIndex)
+void LfpChannelDisplay::pxPaintHistory(Image::BitmapData& bitmapData, int playhead, int rightEdge, int maxScreenBufferIndex)
 {
     if (!isEnabled || isHidden || getWidth() == 0)
     {
         return; // return early if THIS display is not enabled
     }
 
-    Image::BitmapData bdLfpChannelBitmap(display->lfpChannelBitmap, 0, 0, display->lfpChannelBitmap.getWidth(), display->lfpChannelBitmap.getHeight());
-
-    int center = getHeight() / 2;
-
-    // max and min of channel in absolute px coords for event displays etc - actual data might be drawn outside of this range
-    int jfrom_wholechannel = (int)(getY() + center - channelHeight / 2) + 1 + 0;
-    int jto_wholechannel = (int)(getY() + center + channelHeight / 2) - 0;
-
-    // max and min of channel, this is the range where actual data is drawn
-    int jfrom_wholechannel_clip = (int)(getY() + center - (channelHeight)*canvasSplit->channelOverlapFactor) + 1;
-    int jto_wholechannel_clip = (int)(getY() + center + (channelHeight)*canvasSplit->channelOverlapFactor) - 0;
-
-    if (jfrom_wholechannel < 0) { jfrom_wholechannel = 0; };
-    if (jto_wholechannel >= display->lfpChannelBitmap.getHeight()) { jto_wholechannel = display->lfpChannelBitmap.getHeight() - 1; };
+    const ColumnBounds bounds = getColumnBounds(bitmapData.height);
 
     if (playhead < rightEdge - 1)
     {
-        for (int k = jfrom_wholechannel; k <= jto_wholechannel; k += 2) // draw yellow line
-        {
-            bdLfpChannelBitmap.setPixelColour(playhead + 1, k, Colours::yellow);
-        }
+        LfpBitmapPlotter::fillColumn(bitmapData, playhead + 1, bounds.top, bounds.bottom,
+                                     Colours::yellow.getPixelARGB(), 2);
     }
-    
-    bool clipWarningHi = false; // keep track if something clipped in the display, so we can draw warnings after the data pixels are done
-    bool clipWarningLo = false;
-
-    bool saturateWarningHi = false; // similar, but for saturating the amplifier, not just the display - make this warning very visible
-    bool saturateWarningLo = false;
-
-    int stepSize = 1;
-    int from = 0;
-    int to = 0;
-    int endIndex;
 
-    //if (chan == 0)
-    //{
-   //     std::cout << "Channel 0 drawing history" << std::endl;
-   // }
-
-    bool drawWithOffsetCorrection = display->getMedianOffsetPlotting();
-
-    LfpBitmapPlotterInfo plotterInfo; // hold and pass plotting info for each plotting method class
+    const int eventChannel = canvasSplit->getNumChannels();
 
     for (int ii = 0; ii < rightEdge; ii++)
     {
+        // columns to the right of the playhead wrap around to the previous sweep
+        int pixelsAgo = playhead - ii - 1;
 
-        int i = ii;
-        int index = 0;
+        if (playhead <= rightEdge && ii >= playhead)
+            pixelsAgo += rightEdge;
 
-        if (playhead > rightEdge)
+        if (pixelsAgo < canvasSplit->screenBufferWidth)
         {
-			int hiddenPixels = playhead - rightEdge;
-            
-            index = maxScreenBufferIndex - hiddenPixels - rightEdge + ii;
-            
-        }
-        else {
-            if (ii < playhead)
-            {
-                index = maxScreenBufferIndex - playhead + ii;
-            }
-            else
-            {
-                //int numExtraPixels = rightEdge - playhead;
-                int offset = ii - rightEdge;
-                index = maxScreenBufferIndex - playhead + offset;
-            }
-                
-        }
+            int index = maxScreenBufferIndex - 1 - pixelsAgo;
 
-        if (index < 0)
-            index = canvasSplit->screenBufferWidth + index;
+            if (index < 0)
+                index = canvasSplit->screenBufferWidth + index;
 
-        //if (index < 0) // past edge of screenbuffer
-        //    continue;
+            drawColumn(bitmapData, ii,
+                       canvasSplit->getYCoordMin(chan, index),
+                       canvasSplit->getYCoordMax(chan, index),
+                       canvasSplit->getYCoordMean(chan, index),
+                       (int) canvasSplit->getEventState(index),
+                       bounds);
+        }
+        else
+        {
+            // older than the screen buffer: use the display buffer's min/max history
+            float minimum, maximum;
 
+            if (!canvasSplit->getHistoryColumn(chan, pixelsAgo, minimum, maximum))
+                continue;
 
-        //if (ii == 0)
-        //    std::cout << "First screenBufferIndex: " << index << std::endl;
-            
+            float eventMinimum, eventMaximum;
+            int eventState = 0;
 
-        //draw zero line
-        int m = getY() + center;
+            if (canvasSplit->getHistoryColumn(eventChannel, pixelsAgo, eventMinimum, eventMaximum))
+                eventState = (int) eventMaximum;
 
-        if (m > 0 && m < display->lfpChannelBitmap.getHeight())
-        {
-            //if (bdLfpChannelBitmap.getPixelColour(i, m).isTransparent()) { // make sure we're not drawing over an existing plot from another channel
-                bdLfpChannelBitmap.setPixelColour(i, m, Colour(50, 50, 50));
-           // }
+            drawColumn(bitmapData, ii, minimum, maximum, (minimum + maximum) / 2.0f, eventState, bounds);
         }
+    }
 
-        //draw range markers
-        if (isSelected)
-        {
-            int start = getY() + center - channelHeight / 2;
-            int jump = channelHeight / 4;
+}
+
+void LfpChannelDisplay::drawColumn(Image::BitmapData& bitmapData, int i,
+                                   float minimum, float maximum, float mean, int rawEventState,
+                                   const ColumnBounds& bounds)
+{
+    const int bitmapHeight = bitmapData.height;
 
-            for (m = start; m <= start + jump * 4; m += jump)
+    //draw zero line
+    int m = bounds.centre;
+        
+    if (m > 0 && m < bitmapHeight)
+    {
+        LfpBitmapPlotter::fillColumn(bitmapData, i, m, m, Colour(50, 50, 50).getPixelARGB());
+    }
+        
+    //draw range markers
+    if (isSelected)
+    {
+        int start = bounds.centre - channelHeight / 2;
+        int jump = jmax(1, channelHeight / 4);
+            
+        for (m = start; m <= start + jump * 4; m += jump)
+        {
+            if (m > 0 && m < bitmapHeight)
             {
-                if (m > 0 && m < display->lfpChannelBitmap.getHeight())
-                {
-                    bdLfpChannelBitmap.setPixelColour(i, m, Colour(80, 80, 80));
-                }
+                LfpBitmapPlotter::fillColumn(bitmapData, i, m, m, Colour(80, 80, 80).getPixelARGB());
             }
         }
-
-        // draw event markers
-        const int rawEventState = canvasSplit->getEventState(index); // get event state
-
-        for (int ev_ch = 0; ev_ch < 8; ev_ch++) // for all event channels
+    }
+    
+    // draw event markers
+    for (int ev_ch = 0; ev_ch < 8; ev_ch++) // for all event channels
+    {
+        if (display->getEventDisplayState(ev_ch))  // check if plotting for this channel is enabled
         {
-            if (display->getEventDisplayState(ev_ch))  // check if plotting for this channel is enabled
+            if (rawEventState & (1 << ev_ch))    // events are  represented by a bit code, so we have to extract the individual bits with a mask
             {
-                if (rawEventState & (1 << ev_ch))    // events are  represented by a bit code, so we have to extract the individual bits with a mask
-                {
-                    //                        std::cout << "Drawing event." << std::endl;
-                    const Colour currentcolor = display->channelColours[ev_ch * 2];
+                const Colour currentcolor = display->channelColours[ev_ch * 2];
 
-                    for (int k = jfrom_wholechannel; k <= jto_wholechannel; k++) // draw line
-                    {
-                        bdLfpChannelBitmap.setPixelColour(i,
-                            k,
-                            bdLfpChannelBitmap.getPixelColour(i, k).interpolatedWith(currentcolor, 0.3f));
-                    }
+                for (int k = bounds.top; k <= bounds.bottom; k++) // draw line
+                {
+                    PixelARGB* pixel = reinterpret_cast<PixelARGB*>(bitmapData.getPixelPointer(i, k));
 
+                    *pixel = Colour(pixel->getUnpremultiplied()).interpolatedWith(currentcolor, 0.3f).getPixelARGB();
                 }
             }
         }
+    }
+        
+    // set max-min range for plotting
+    double a = (maximum / range * channelHeightFloat) - bounds.offset;
+    double b = (minimum / range * channelHeightFloat) - bounds.offset;
+        
+    double a_raw = maximum;
+    double b_raw = minimum;
+    double from_raw = 0; double to_raw = 0;
 
-        // set max-min range for plotting
-        double a = (canvasSplit->getYCoordMax(chan, index) / range * channelHeightFloat);
-        double b = (canvasSplit->getYCoordMin(chan, index) / range * channelHeightFloat);
-
-        double mean = (canvasSplit->getMean(chan) / range * channelHeightFloat);
-
-        if (drawWithOffsetCorrection)
-        {
-            a -= mean;
-            b -= mean;
-        }
-
-        double a_raw = canvasSplit->getYCoordMax(chan, index);
-        double b_raw = canvasSplit->getYCoordMin(chan, index);
-        double from_raw = 0; double to_raw = 0;
-
-        if (a < b)
-        {
-            from = (a); to = (b);
-            from_raw = (a_raw); to_raw = (b_raw);
-
-        }
-        else
-        {
-            from = (b); to = (a);
-            from_raw = (b_raw); to_raw = (a_raw);
-        }
-
-        // start by clipping so that we're not populating pixels that we dont want to plot
-        int lm = channelHeightFloat * canvasSplit->channelOverlapFactor;
-        if (lm > 0)
-            lm = -lm;
-
-        if (from > -lm) { from = -lm; clipWarningHi = true; };
-        if (to > -lm) { to = -lm; clipWarningHi = true; };
-        if (from < lm) { from = lm; clipWarningLo = true; };
-        if (to < lm) { to = lm; clipWarningLo = true; };
-
-        // test if raw data is clipped for displaying saturation warning
-        if (from_raw > options->selectedSaturationValueFloat) { saturateWarningHi = true; };
-        if (to_raw > options->selectedSaturationValueFloat) { saturateWarningHi = true; };
-        if (from_raw < -options->selectedSaturationValueFloat) { saturateWarningLo = true; };
-        if (to_raw < -options->selectedSaturationValueFloat) { saturateWarningLo = true; };
-
-        bool spikeFlag = display->getSpikeRasterPlotting()
-            && (from_raw - canvasSplit->getYCoordMean(chan, index) < display->getSpikeRasterThreshold()
-                || to_raw - canvasSplit->getYCoordMean(chan, index) < display->getSpikeRasterThreshold());
+    int from = 0;
+    int to = 0;
+        
+    if (a < b)
+    {
+        from = (a); to = (b);
+        from_raw = (a_raw); to_raw = (b_raw);
+    }
+    else
+    {
+        from = (b); to = (a);
+        from_raw = (b_raw); to_raw = (a_raw);
+    }
 
-        from = from + getHeight() / 2;       // so the plot is centered in the channeldisplay
-        to = to + getHeight() / 2;
+    bool clipWarningHi = false; // keep track if something clipped in the display, so we can draw warnings after the data pixels are done
+    bool clipWarningLo = false;
+    
+    bool saturateWarningHi = false; // similar, but for saturating the amplifier, not just the display - make this warning very visible
+    bool saturateWarningLo = false;
+        
+    // start by clipping so that we're not populating pixels that we dont want to plot
+    int lm = channelHeightFloat * canvasSplit->channelOverlapFactor;
+    if (lm > 0)
+        lm = -lm;
+        
+    if (from > -lm) { from = -lm; clipWarningHi = true; };
+    if (to > -lm) { to = -lm; clipWarningHi = true; };
+    if (from < lm) { from = lm; clipWarningLo = true; };
+    if (to < lm) { to = lm; clipWarningLo = true; };
+        
+    // test if raw data is clipped for displaying saturation warning
+    if (from_raw > options->selectedSaturationValueFloat) { saturateWarningHi = true; };
+    if (to_raw > options->selectedSaturationValueFloat) { saturateWarningHi = true; };
+    if (from_raw < -options->selectedSaturationValueFloat) { saturateWarningLo = true; };
+    if (to_raw < -options->selectedSaturationValueFloat) { saturateWarningLo = true; };
+        
+    bool spikeFlag = display->getSpikeRasterPlotting()
+        && (from_raw - mean < display->getSpikeRasterThreshold()
+                || to_raw - mean < display->getSpikeRasterThreshold());
 
-        int samplerange = to - from;
+    from = from + getHeight() / 2;       // so the plot is centered in the channeldisplay
+    to = to + getHeight() / 2;
+        
+    LfpBitmapPlotterInfo plotterInfo; // hold and pass plotting info for each plotting method class
 
-        plotterInfo.channelID = chan;
-        plotterInfo.y = getY();
-        plotterInfo.from = from;
-        plotterInfo.to = to;
-        plotterInfo.samp = i;
-        plotterInfo.lineColour = lineColour;
+    plotterInfo.channelID = chan;
+    plotterInfo.y = getY();
+    plotterInfo.from = from;
+    plotterInfo.to = to;
+    plotterInfo.samp = i;
+    plotterInfo.lineColour = lineColour;
+            
+    // Do the actual plotting for the selected plotting method
+    if (!display->getSpikeRasterPlotting())
+        display->getPlotterPtr()->plot(bitmapData, plotterInfo);
+        
+    // now draw warnings, if needed
+    if (canvasSplit->drawClipWarning) // draw simple warning if display cuts off data
+    {
+        const PixelARGB white = Colour(255, 255, 255).getPixelARGB();
 
-        // Do the actual plotting for the selected plotting method
-        if (!display->getSpikeRasterPlotting())
-            display->getPlotterPtr()->plot(bdLfpChannelBitmap, plotterInfo);
+        if (clipWarningHi && bounds.clipBottom > 0 && bounds.clipBottom < bitmapHeight)
+            LfpBitmapPlotter::fillColumn(bitmapData, i, bounds.clipBottom - 3, bounds.clipBottom, white);
 
-        // now draw warnings, if needed
-        if (canvasSplit->drawClipWarning) // draw simple warning if display cuts off data
+        if (clipWarningLo && bounds.clipTop > 0 && bounds.clipTop < bitmapHeight)
+            LfpBitmapPlotter::fillColumn(bitmapData, i, bounds.clipTop, bounds.clipTop + 3, white);
+    }
+        
+    if (spikeFlag) // draw spikes
+    {
+        LfpBitmapPlotter::fillColumn(bitmapData, i, jmax(1, bounds.top), bounds.bottom, lineColour.getPixelARGB());
+    }
+        
+    if (canvasSplit->drawSaturationWarning) // draw bigger warning if actual data gets cuts off
+    {
+        if (saturateWarningHi || saturateWarningLo)
         {
+            const PixelARGB red = Colour(255, 0, 0).getPixelARGB();
+            const PixelARGB white = Colour(255, 255, 255).getPixelARGB();
 
-            if (clipWarningHi) {
-                for (int j = 0; j <= 3; j++)
-                {
-                    int clipmarker = jto_wholechannel_clip;
-
-                    if (clipmarker > 0 && clipmarker < display->lfpChannelBitmap.getHeight()) {
-                        bdLfpChannelBitmap.setPixelColour(i, clipmarker - j, Colour(255, 255, 255));
-                    }
-                }
-            }
-
-            if (clipWarningLo) {
-                for (int j = 0; j <= 3; j++)
-                {
-                    int clipmarker = jfrom_wholechannel_clip;
-
-                    if (clipmarker > 0 && clipmarker < display->lfpChannelBitmap.getHeight()) {
-                        bdLfpChannelBitmap.setPixelColour(i, clipmarker + j, Colour(255, 255, 255));
-                    }
-                }
+            for (int k = jmax(1, bounds.top); k <= bounds.bottom; k++) // draw line
+            {
+                LfpBitmapPlotter::fillColumn(bitmapData, i, k, k, ((i + k) % 50 > 25) ? white : red);
             }
-
-            clipWarningHi = false;
-            clipWarningLo = false;
         }
-
-        if (spikeFlag) // draw spikes
-        {
-            for (int k = jfrom_wholechannel; k <= jto_wholechannel; k++) { // draw line
-                if (k > 0 && k < display->lfpChannelBitmap.getHeight()) {
-                    bdLfpChannelBitmap.setPixelColour(i, k, lineColour);
-                }
-            };
-        }
-
-        if (canvasSplit->drawSaturationWarning) // draw bigger warning if actual data gets cuts off
-        {
-
-            if (saturateWarningHi || saturateWarningLo) {
-
-                for (int k = jfrom_wholechannel; k <= jto_wholechannel; k++) { // draw line
-                    Colour thiscolour = Colour(255, 0, 0);
-                    if (fmod((i + k), 50) > 25) {
-                        thiscolour = Colour(255, 255, 255);
-                    }
-                    if (k > 0 && k < display->lfpChannelBitmap.getHeight()) {
-                        bdLfpChannelBitmap.setPixelColour(i, k, thiscolour);
-                    }
-                };
-            }
-
-            saturateWarningHi = false; // we likely just need one of this because for this warning we dont care if its saturating on the positive or negative side
-            saturateWarningLo = false;
-
-        } // if i < getWidth()
-
-    } //  for (int index = ifrom; index < ito; index++)
+    }
 
 }
 
@@ -59,7 +59,7 @@ public:
         drawn, so cant do it per channel)
 
     */
-    void pxPaint();
+    void pxPaint(Image::BitmapData& bitmapData);
 
     /** Populates the lfpChannelBitmap while scrolling back in time
 
@@ -67,8 +67,11 @@ public:
         because otherwise we cant deal with the channel overlap (need to clear a vertical section first, _then_ all channels are
         drawn, so cant do it per channel)
 
+        Columns that are older than the screen buffer are drawn from the display buffer's
+        long-term min/max history.
+
     */
-    void pxPaintHistory(int playhead, int rightEdge, int maxScreenBufferIndex);
+    void pxPaintHistory(Image::BitmapData& bitmapData, int playhead, int rightEdge, int maxScreenBufferIndex);
                 
     /** Selects this channel*/
     void select();
@@ -177,6 +180,27 @@ protected:
     
     void drawEventOverlay(int x, int yfrom, int yto, Image::BitmapData* image);
 
+    /** Rows (in lfpChannelBitmap coordinates) used when drawing this channel */
+    struct ColumnBounds
+    {
+        int centre;
+        int top;
+        int bottom;
+        int clipTop;
+        int clipBottom;
+        double offset;
+    };
+
+    /** Computes the rows occupied by this channel in a bitmap of the given height */
+    ColumnBounds getColumnBounds(int bitmapHeight);
+
+    /** Draws one column of the channel from its range and the event state, writing directly
+        into the bitmap. Only touches rows near this channel, so different channels can be drawn
+        on different threads as long as they are far enough apart.*/
+    void drawColumn(Image::BitmapData& bitmapData, int x,
+                    float minimum, float maximum, float mean, int eventState,
+                    const ColumnBounds& bounds);
+
     LfpDisplaySplitter* canvasSplit;
     LfpDisplay* display;
     LfpDisplayOptions* options;
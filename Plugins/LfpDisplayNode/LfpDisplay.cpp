@@ -66,6 +66,7 @@ LfpDisplay::LfpDisplay(LfpDisplaySplitter* c, Viewport* v)
     , m_SpikeRasterPlottingFlag(false)
     , lastBitmapIndex(0)
     , lastFillFrom(-1)
+    , rasterPool(jlimit(1, 8, SystemStats::getNumCpus() - 1))
 {
     perPixelPlotter = std::make_unique<PerPixelBitmapPlotter>(this);
     supersampledPlotter = std::make_unique<SupersampledBitmapPlotter>(this);
@@ -413,11 +414,15 @@ void LfpDisplay::refresh()
 
             lfpChannelBitmap.clear(Rectangle<int>(0, 0, totalXPixels, totalYPixels));
 
+            Array<LfpChannelDisplay*> channelsToPaint;
+
+            for (int i = 0; i < numChans; i++)
+                channelsToPaint.add(channels[i]);
+
+            paintChannels(channelsToPaint, true, playhead, rightEdge, maxScreenBufferIndex);
+
             for (int i = 0; i < numChans; i++)
-            {
-                channels[i]->pxPaintHistory(playhead, rightEdge, maxScreenBufferIndex);
                 channelInfo[i]->repaint();
-            }
 
             repaint();
 
@@ -462,6 +467,8 @@ void LfpDisplay::refresh()
 
         lfpChannelBitmap.clear(Rectangle<int>(0, 0, totalXPixels, totalYPixels));
 
+        Array<LfpChannelDisplay*> channelsToPaint;
+
         for (int i = 0; i < numChans; i++)
         {
             int componentTop = channels[i]->getY();
@@ -469,11 +476,13 @@ void LfpDisplay::refresh()
             
             if ((topBorder <= componentBottom && bottomBorder >= componentTop)) // only draw things that are visible
             {
-                channels[i]->pxPaintHistory(playhead, rightEdge, maxScreenBufferIndex);
+                channelsToPaint.add(channels[i]);
                 channelInfo[i]->repaint();
             }
         }
 
+        paintChannels(channelsToPaint, true, playhead, rightEdge, maxScreenBufferIndex);
+
         canvasSplit->fullredraw = false;
 
         repaint(0, topBorder, getWidth(), bottomBorder - topBorder);
@@ -535,6 +544,8 @@ void LfpDisplay::refresh()
         
     }
 
+    Array<LfpChannelDisplay*> channelsToPaint;
+
     for (int i = 0; i < numChans; i++)
     {
 
@@ -543,39 +554,26 @@ void LfpDisplay::refresh()
 
         if ((topBorder <= componentBottom && bottomBorder >= componentTop)) // only draw things that are visible
         {
-            if (canvasSplit->fullredraw)
-            {
-                channels[i]->fullredraw = true;
-
-                channels[i]->pxPaint();
-                channelInfo[i]->repaint();
-            }
-            else
-            {
-                 channels[i]->pxPaint(); // draws to lfpChannelBitmap
-                
-                 // it's not clear why, but apparently because the pxPaint() is in a child component of LfpDisplay, 
-                 // we also need to issue repaint() calls for each channel, even though there's nothing 
-                 // to repaint there. Otherwise, the repaint call in LfpDisplay::refresh(), a few lines down, 
-                 // lags behind the update line by ~60 px. This could have something to do with the repaint 
-                 // message passing in juce. In any case, this seemingly redundant repaint here seems to fix the issue.
-                
-                 // we redraw from 0 to +2 (px) relative to the real redraw window, the +1 draws the vertical update line
-                 if (fillfrom_local < fillto_local)
-                 {
-                     channels[i]->repaint(fillfrom_local, 0, fillto_local - fillfrom_local + 2, channels[i]->getHeight());
-                 }
-                 else
-                 {
-                     channels[i]->repaint(fillfrom_local, 0, totalXPixels - fillfrom_local + 2, channels[i]->getHeight());
-                     channels[i]->repaint(0, 0, fillto_local + 2, channels[i]->getHeight());
-                 }
-                
-            }
+            channelsToPaint.add(channels[i]);
         }
 
     }
 
+    paintChannels(channelsToPaint); // draws to lfpChannelBitmap
+
+    // only the columns that changed need to be blitted; we redraw from 0 to +2 (px) relative
+    // to the real redraw window, the +1 draws the vertical update line
+    // (the channel displays start at leftmargin, which is where the bitmap is drawn)
+    if (fillfrom_local < fillto_local)
+    {
+        repaint(canvasSplit->leftmargin + fillfrom_local, topBorder, fillto_local - fillfrom_local + 2, bottomBorder - topBorder);
+    }
+    else
+    {
+        repaint(canvasSplit->leftmargin + fillfrom_local, topBorder, totalXPixels - fillfrom_local + 2, bottomBorder - topBorder);
+        repaint(canvasSplit->leftmargin, topBorder, fillto_local + 2, bottomBorder - topBorder);
+    }
+
     if (fillfrom_local == 0 && singleChan != -1)
     {
         channelInfo[singleChan]->repaint();
@@ -590,6 +588,71 @@ void LfpDisplay::refresh()
 
 }
 
+void LfpDisplay::paintChannels(Array<LfpChannelDisplay*>& channelsToPaint, bool drawHistory,
+                               int playhead, int rightEdge, int maxScreenBufferIndex)
+{
+    if (channelsToPaint.size() == 0)
+        return;
+
+    Image::BitmapData bitmapData(lfpChannelBitmap, Image::BitmapData::readWrite);
+
+    auto paintGroup = [&] (int first, int last)
+    {
+        for (int i = first; i < last; i++)
+        {
+            if (drawHistory)
+                channelsToPaint[i]->pxPaintHistory(bitmapData, playhead, rightEdge, maxScreenBufferIndex);
+            else
+                channelsToPaint[i]->pxPaint(bitmapData);
+        }
+    };
+
+    const int numChannels = channelsToPaint.size();
+    const int numThreads = rasterPool.getNumThreads();
+
+    // traces can extend into neighbouring channels (by up to channelOverlapFactor channel heights),
+    // so a group must be tall enough that groups two apart never touch the same rows
+    const int minGroupSize = jmax(8, int(std::ceil(2.0f * canvasSplit->channelOverlapFactor)) + 2);
+
+    if (numThreads < 2 || numChannels < 2 * minGroupSize)
+    {
+        paintGroup(0, numChannels);
+        return;
+    }
+
+    std::sort(channelsToPaint.begin(), channelsToPaint.end(),
+              [] (const LfpChannelDisplay* a, const LfpChannelDisplay* b) { return a->getY() < b->getY(); });
+
+    const int groupSize = jmax(minGroupSize, (numChannels + 2 * numThreads - 1) / (2 * numThreads));
+    const int numGroups = (numChannels + groupSize - 1) / groupSize;
+
+    // even groups first, then odd groups: within each phase, groups are at least one group apart
+    for (int phase = 0; phase < 2; phase++)
+    {
+        std::atomic<int> remainingGroups((numGroups - phase + 1) / 2);
+        WaitableEvent phaseFinished;
+
+        if (remainingGroups == 0)
+            continue;
+
+        for (int group = phase; group < numGroups; group += 2)
+        {
+            const int first = group * groupSize;
+            const int last = jmin(numChannels, first + groupSize);
+
+            rasterPool.addJob([&, first, last]
+            {
+                paintGroup(first, last);
+
+                if (--remainingGroups == 0)
+                    phaseFinished.signal();
+            });
+        }
+
+        phaseFinished.wait();
+    }
+}
+
 void LfpDisplay::setRange(float r, ContinuousChannel::Type type)
 {
 
@@ -1157,6 +1220,12 @@ void LfpDisplay::timerCallback()
     canRefresh = true;
 }
 
+int LfpDisplay::getMaxHistoryOffset()
+{
+    // the leftmost column is (pausePoint + offset) columns before the newest one
+    return jmax(0, canvasSplit->getHistoryLengthPixels() - pausePoint);
+}
+
 void LfpDisplay::setTimeOffset(float offset)
 {
 
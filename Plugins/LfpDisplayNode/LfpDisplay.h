@@ -208,6 +208,9 @@ public:
     /** Sets the time offset for the display */
     void setTimeOffset(float offset);
 
+    /** Returns the largest time offset (in px) that can be drawn from the long-term history */
+    int getMaxHistoryOffset();
+
     /** Sets playhead back to left edge*/
     void sync();
     
@@ -296,7 +299,13 @@ private:
 
     /** Used to throttle refresh speed when scrolling backwards */
     void timerCallback() override;
-    
+
+    /** Draws a set of channels into lfpChannelBitmap (either the latest columns, or the
+        history view). Large sets are split into groups of adjacent channels that are
+        drawn in parallel. */
+    void paintChannels(Array<LfpChannelDisplay*>& channelsToPaint, bool drawHistory = false,
+                       int playhead = 0, int rightEdge = 0, int maxScreenBufferIndex = 0);
+
     int singleChan;
 	 
     int pausePoint;
@@ -341,6 +350,9 @@ private:
 
     uint8 activeColourScheme;
     OwnedArray<ChannelColourScheme> colourSchemeList;
+
+    /** Threads used to rasterize channels (declared last, so that they stop first) */
+    ThreadPool rasterPool;
 };
   
 }; // end LfpViewer namespace
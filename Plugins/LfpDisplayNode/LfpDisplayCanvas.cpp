@@ -726,6 +726,9 @@ LfpDisplaySplitter::LfpDisplaySplitter(LfpDisplayNode* node,
 
     displayBuffer = nullptr;
 
+    triggeredAverage = std::make_unique<TriggeredAverage>();
+    drawnAverageVersion = -1;
+
 }
 
 void LfpDisplaySplitter::resized()
@@ -805,23 +808,28 @@ void LfpDisplaySplitter::beginAnimation()
 
         syncDisplay();
 
-        numTrials = -1;
+        triggeredAverage->reset();
 
         eventState = 0;
 
     }    
 
-    startTimer(50);
+    updateAveraging();
+    triggeredAverage->startThread();
+
+    FrameScheduler::getInstance()->addClient(this, 20.0f);
 
     reachedEnd = true;
 }
 
 void LfpDisplaySplitter::endAnimation()
 {
-    stopTimer();
+    FrameScheduler::getInstance()->removeClient(this);
+
+    triggeredAverage->stopThread(1000);
 }
 
-void LfpDisplaySplitter::timerCallback()
+void LfpDisplaySplitter::renderFrame()
 {
     refresh();
 }
@@ -974,6 +982,8 @@ void LfpDisplaySplitter::updateSettings()
     syncDisplay(); // sets lastBitmapIndex to 0
     syncDisplayBuffer(); // sets displayBufferIndex to 0
 
+    updateAveraging();
+
     isUpdating = false;
 
     //lfpDisplay->setColors(); // calls refresh
@@ -998,23 +1008,101 @@ void LfpDisplaySplitter::setTriggerChannel(int ch)
     if (triggerChannel == -1)
         timescale->setTimebase(timebase);
     
+    updateAveraging();
+
     syncDisplay();
 }
 
 void LfpDisplaySplitter::setAveraging(bool avg)
 {
-    if (trialAveraging == false)
-    {
-        numTrials = -1;
-    }
-
     trialAveraging = avg;
-    
+
+    updateAveraging();
+
+    syncDisplay();
 }
 
 void LfpDisplaySplitter::resetTrials()
 {
-    numTrials = -1;
+    triggeredAverage->reset();
+}
+
+void LfpDisplaySplitter::setAverageWindow(float preTrigger, float postTrigger)
+{
+    averagePreWindow = preTrigger;
+    averagePostWindow = postTrigger;
+
+    updateAveraging();
+
+    syncDisplay();
+}
+
+void LfpDisplaySplitter::updateAveraging()
+{
+    triggeredAverage->setSource(displayBuffer);
+
+    triggeredAverage->setWindow(int(sampleRate * averagePreWindow), int(sampleRate * averagePostWindow));
+    triggeredAverage->setEnabled(isAveraging());
+
+    drawnAverageVersion = -1;
+
+    // the average spans the whole screen, whatever the timebase
+    if (isAveraging() && sampleRate > 0)
+        timescale->setTimebase(float(triggeredAverage->getWindowLength()) / sampleRate,
+                               float(triggeredAverage->getPreSamples()) / sampleRate);
+    else
+        timescale->setTimebase(timebase);
+}
+
+void LfpDisplaySplitter::drawAverage()
+{
+    // nothing new to draw unless the average has changed
+    for (int channel = 0; channel <= nChans; channel++)
+        lastScreenBufferIndex.set(channel, screenBufferIndex[channel]);
+
+    const int version = triggeredAverage->getVersion();
+    const int displayWidth = lfpDisplay->lfpChannelBitmap.getWidth();
+
+    if (version == drawnAverageVersion || displayWidth <= 0 || displayWidth >= screenBufferWidth
+        || triggeredAverage->getWindowLength() == 0)
+        return;
+
+    drawnAverageVersion = version;
+
+    const double ratio = triggeredAverage->getWindowLength() / double(displayWidth); // samples / pixel
+
+    averageDeviation.malloc(displayWidth);
+
+    for (int channel = 0; channel < nChans; channel++)
+    {
+        float* minimum = screenBufferMin->getWritePointer(channel);
+        float* maximum = screenBufferMax->getWritePointer(channel);
+
+        triggeredAverage->summarize(channel, ratio, displayWidth,
+                                    minimum,
+                                    screenBufferMean->getWritePointer(channel),
+                                    maximum,
+                                    averageDeviation);
+
+        // each column spans one standard deviation across trials on either side of the average
+        FloatVectorOperations::subtract(minimum, averageDeviation, displayWidth);
+        FloatVectorOperations::add(maximum, averageDeviation, displayWidth);
+    }
+
+    // mark the trigger in the event channel
+    eventDisplayBuffer->clear(0, 0, displayWidth);
+
+    const int triggerColumn = int(triggeredAverage->getPreSamples() / ratio);
+
+    if (triggerColumn < displayWidth)
+        eventDisplayBuffer->setSample(0, triggerColumn, float(1 << jlimit(0, 7, triggerChannel)));
+
+    // the whole screen is redrawn from the start of the screen buffer
+    for (int channel = 0; channel <= nChans; channel++)
+        screenBufferIndex.set(channel, displayWidth);
+
+    lfpDisplay->lastBitmapIndex = displayWidth;
+    fullredraw = true;
 }
 
 void LfpDisplaySplitter::refreshSplitterState()
@@ -1062,6 +1150,8 @@ void LfpDisplaySplitter::refreshScreenBuffer()
         screenBufferMin->clear();
         screenBufferMean->clear();
         screenBufferMax->clear();
+
+        drawnAverageVersion = -1;
         
     }
     
@@ -1092,7 +1182,7 @@ void LfpDisplaySplitter::syncDisplayBuffer()
 
     for (int channel = 0; channel <= nChans; channel++)
     {
-        displayBufferIndex.set(channel, displayBuffer->displayBufferIndices[channel]);
+        displayBufferIndex.set(channel, displayBuffer->getWriteIndex());
         leftOverSamples.set(channel, 0.0f);
     }
 
@@ -1104,12 +1194,55 @@ void LfpDisplaySplitter::pause(bool shouldPause)
     if (shouldPause)
     {
         isUpdating = true;
+
+        pauseSampleNumber.clearQuick();
+
+        if (displayBuffer != nullptr && displayBufferSize > 0)
+        {
+            // a single snapshot of the write position, shared by all channels
+            const int64 samplesWritten = displayBuffer->getSamplesWritten();
+            const int writeIndex = int(samplesWritten % displayBufferSize);
+
+            for (int channel = 0; channel <= nChans; channel++)
+            {
+                // samples already in the display buffer but not yet drawn
+                int pending = writeIndex - displayBufferIndex[channel];
+
+                if (pending < 0)
+                    pending += displayBufferSize;
+
+                pauseSampleNumber.add(samplesWritten - pending);
+            }
+        }
     }
     else {
         isUpdating = false;
     }
 }
 
+bool LfpDisplaySplitter::getHistoryColumn(int chan, int pixelsAgo, float& minimum, float& maximum)
+{
+    if (displayBuffer == nullptr || triggerChannel >= 0 || chan >= pauseSampleNumber.size())
+        return false;
+
+    const double ratio = sampleRate * timebase / double(lfpDisplay->lfpChannelBitmap.getWidth()); // samples / pixel
+
+    const int64 endSample = pauseSampleNumber[chan] - int64(pixelsAgo * ratio);
+    const int64 startSample = pauseSampleNumber[chan] - int64((pixelsAgo + 1) * ratio);
+
+    return displayBuffer->getHistoryRange(chan, startSample, jmax(endSample, startSample + 1), minimum, maximum);
+}
+
+int LfpDisplaySplitter::getHistoryLengthPixels()
+{
+    if (displayBuffer == nullptr || triggerChannel >= 0 || sampleRate <= 0 || timebase <= 0)
+        return 0;
+
+    const double ratio = sampleRate * timebase / double(lfpDisplay->lfpChannelBitmap.getWidth());
+
+    return int(jmin(double(displayBuffer->getHistoryLength()) / ratio, double(std::numeric_limits<int>::max() / 2)));
+}
+
 void LfpDisplaySplitter::updateScreenBuffer()
 {
     if (isVisible() && displayBuffer != nullptr && !isUpdating)
@@ -1133,13 +1266,20 @@ void LfpDisplaySplitter::updateScreenBuffer()
         {
             processor->acknowledgeTrigger(splitID);
         }
+
+        if (isAveraging())
+        {
+            drawAverage();
+            return;
+        }
                 
+        // every channel is drawn up to the same published position
+        const int newDisplayBufferIndex = displayBuffer->getWriteIndex();
+
         for (int channel = 0; channel <= nChans; channel++) // pull one extra channel for event display
         {
             
             int dbi = displayBufferIndex[channel]; // display buffer index from the last round of drawing
-
-            int newDisplayBufferIndex = displayBuffer->displayBufferIndices[channel]; // get the latest value from the display buffer
  
             int newSamples = newDisplayBufferIndex - dbi; // N new samples (not pixels) to be drawn
 
@@ -1207,13 +1347,10 @@ void LfpDisplaySplitter::updateScreenBuffer()
 
                         if (channel == 0)
                         {
-                            numTrials += 1;
-
                             //std::cout << "Rewinding playhead" << std::endl;
                             lfpDisplay->lastBitmapIndex = 0;
 
-                            /*std::cout << "Trial number: " << numTrials << std::endl;
-                            std::cout << "maxSamples: " << maxSamples << std::endl;
+                            /*std::cout << "maxSamples: " << maxSamples << std::endl;
                             std::cout << "ratio: " << ratio << std::endl;
                             std::cout << "dispBufLim: " << dispBufLim << std::endl;
                             std::cout << "screenThird: " << screenThird << std::endl;
@@ -1280,17 +1417,9 @@ void LfpDisplaySplitter::updateScreenBuffer()
                             eventDisplayBuffer->clear(0, sbi, 1);
                         }
                         else {
-                            if (triggerChannel < 0 || numTrials == 0 || trialAveraging == false)
-                            {
-                                screenBufferMean->clear(channel, sbi, 1);
-                                screenBufferMin->clear(channel, sbi, 1);
-                                screenBufferMax->clear(channel, sbi, 1);
-                            }
-                            else {
-                                screenBufferMean->applyGain(channel, sbi, 1, numTrials);
-                                screenBufferMin->applyGain(channel, sbi, 1, numTrials);
-                                screenBufferMax->applyGain(channel, sbi, 1, numTrials);
-                            }
+                            screenBufferMean->clear(channel, sbi, 1);
+                            screenBufferMin->clear(channel, sbi, 1);
+                            screenBufferMax->clear(channel, sbi, 1);
                         }
                             
                         if (ratio < 1.0) // less than one sample per pixel
@@ -1349,35 +1478,26 @@ void LfpDisplaySplitter::updateScreenBuffer()
                                 sample_max = sample_sum;
                                 sampleCount = 1.0f;
                             }
-
-                            bool foundIt = false;
-
-                            while (subSampleOffset > 1.0f && sampleNumber < newSamples) 
+                            else
                             {
-                                sampleNumber++;
+                                // summarize all samples that fall within this pixel, using the
+                                // display buffer's min/max pyramid rather than visiting each sample
+                                const int samplesThisPixel = jmin(int(std::ceil(subSampleOffset - 1.0f)),
+                                                                  newSamples - sampleNumber);
 
-                                float sample_current = displayBuffer->getSample(channel, dbi);
-
-
-                                sample_sum = sample_sum + sample_current;
-
-                                if (sample_min >= sample_current)
+                                if (samplesThisPixel > 0)
                                 {
-                                    sample_min = sample_current;
-                                }
+                                    displayBuffer->getRangeSummary(channel, dbi, samplesThisPixel,
+                                                                   sample_min, sample_max, sample_sum);
 
-                                if (sample_max <= sample_current)
-                                {
-                                    sample_max = sample_current;
-                                }
-                              
-                                subSampleOffset -= 1.0f;
+                                    sampleNumber += samplesThisPixel;
+                                    subSampleOffset -= float(samplesThisPixel);
 
-                                dbi += 1;
-                                dbi %= displayBufferSize;
-
-                                sampleCount += 1.0f;
+                                    dbi += samplesThisPixel;
+                                    dbi %= displayBufferSize;
 
+                                    sampleCount = float(samplesThisPixel);
+                                }
                             }
 
                             float sample_mean = sample_sum / sampleCount;
@@ -1404,14 +1524,6 @@ void LfpDisplaySplitter::updateScreenBuffer()
                             }                  
                         }
                         
-                        if (triggerChannel >= 0 && trialAveraging == true && channel != nChans)
-                        {
-
-                            screenBufferMean->applyGain(channel, sbi, 1, 1 / (numTrials + 1));
-                            screenBufferMin->applyGain(channel, sbi, 1, 1 / (numTrials + 1));
-                            screenBufferMax->applyGain(channel, sbi, 1, 1 / (numTrials + 1));
-                        }
-
                         sbi++;
 
                         if (triggerChannel >= 0)
@@ -1432,32 +1544,6 @@ void LfpDisplaySplitter::updateScreenBuffer()
                         }
 
                         sbi %= maxSamples;
-
-                        
-                        // HISTOGRAM DRAWING IS CURRENTLY DISABLED
-                        // similarly, for each pixel on the screen, we want a list of all values so we can draw a histogram later
-                        // for simplicity, we'll just do this as 2d array, samplesPerPixel[px][samples]
-                        // with an additional array sampleCountPerPixel[px] that holds the N samples per pixel
-
-                        //if (channel < nChans) // we're looping over one 'extra' channel for events above, so make sure not to loop over that one here
-                       // {
-                            // this is for fancy drawing -- not used in new LFP Viewer
-                            /*int c = 0;
-                            for (int j = dbi; j < nextpix && c < MAX_N_SAMP_PER_PIXEL; j++)
-                            {
-                                float sample_current = displayBuffer->getSample(channel, j);
-                                samplesPerPixel[channel][sbi][c] = sample_current;
-                                c++;
-                            }
-                            if (c > 0){
-                                sampleCountPerPixel.set(sbi, c - 1); // save count of samples for this pixel
-                            }
-                            else{
-                                sampleCountPerPixel.set(sbi, 0);
-                            }*/
-                            //sample_mean = sample_mean / c;
-                            
-                     //   }
                         
                     } // !isPaused
 
@@ -1493,10 +1579,7 @@ void LfpDisplaySplitter::setTimebase(float t)
         startTimer(50);
     }*/
 
-    if (trialAveraging)
-    {
-        numTrials = -1;
-    }
+    updateAveraging();
 
     syncDisplay();
     syncDisplayBuffer();
@@ -1672,7 +1755,10 @@ void LfpDisplaySplitter::visibleAreaChanged()
 
 void LfpDisplaySplitter::refresh()
 {
-    
+    // kept up to date while paused or hidden, so that no history is lost
+    if (displayBuffer != nullptr)
+        displayBuffer->updateHistory();
+
     updateScreenBuffer();
     
     if (shouldRebuildChannelList) 
@@ -34,6 +34,7 @@
 #include "LfpTimescale.h"
 #include "LfpViewport.h"
 #include "LfpDisplay.h"
+#include "TriggeredAverage.h"
 
 namespace LfpViewer {
 
@@ -156,7 +157,7 @@ private:
 */
 class LfpDisplaySplitter : public Component,
                            public ComboBox::Listener,
-                           public Timer
+                           public FrameScheduler::Client
 {
 public:
 
@@ -275,18 +276,32 @@ public:
     /** Returns true if the display is in triggered mode */
     bool isInTriggeredMode() { return triggerChannel > -1; }
 
+    /** Returns true if the display shows the trial average */
+    bool isAveraging() { return triggerChannel > -1 && trialAveraging; }
+
     /** Set whether triggered display should use online averaging */
     void setAveraging(bool);
 
     /** Reset trial count for online average */
     void resetTrials();
 
+    /** Sets the time averaged before and after each trigger (in s) */
+    void setAverageWindow(float preTrigger, float postTrigger);
+
     /** Sets the timebase for this display (in s) */
     void setTimebase(float timebase);
 
     /** Stops/starts updating the screen buffer */
     void pause(bool shouldPause);
 
+    /** Gets the range of a channel for a pixel column that has already scrolled out of the
+        screen buffer, from the display buffer's long-term history. pixelsAgo counts back
+        from the newest column drawn before pausing. Returns false if no data is available. */
+    bool getHistoryColumn(int chan, int pixelsAgo, float& minimum, float& maximum);
+
+    /** Returns the number of pixel columns (at the current timebase) held in the long-term history */
+    int getHistoryLengthPixels();
+
     Array<int> screenBufferIndex;
     Array<int> lastScreenBufferIndex;
     Array<float> leftOverSamples;
@@ -331,8 +346,11 @@ public:
     /** Sample-wise data buffer for display*/
     DisplayBuffer* displayBuffer;
 
-    /** Refreshes the display */
-    void timerCallback();
+    /** Event-triggered average of displayBuffer, shown when averaging is enabled in triggered mode */
+    std::unique_ptr<TriggeredAverage> triggeredAverage;
+
+    /** Refreshes the display (called by the FrameScheduler) */
+    void renderFrame() override;
 
     /** Send a message to audio monitor one channel */
     void monitorChannel(int channel);
@@ -355,10 +373,25 @@ private:
     LfpDisplayCanvas* canvas;
 
     float sampleRate;
-    float numTrials;
 
     bool trialAveraging;
 
+    /** Time averaged before and after each trigger (in s) */
+    float averagePreWindow = 0.1f;
+    float averagePostWindow = 0.5f;
+
+    /** Version of the triggered average that is in the screen buffer */
+    int drawnAverageVersion;
+
+    /** Sets the source and window of the triggered average to match the display */
+    void updateAveraging();
+
+    /** Fills the screen buffer with the triggered average, if it has changed */
+    void drawAverage();
+
+    /** Standard deviation across trials of each column of the triggered average */
+    HeapBlock<float> averageDeviation;
+
     float displayGain;
     float timeOffset;
 
@@ -385,6 +418,9 @@ private:
     Array<int> displayBufferIndex;
     int displayBufferSize;
 
+    /** Display buffer sample count of the newest drawn sample, captured when pausing */
+    Array<int64> pauseSampleNumber;
+
     int scrollBarThickness;
     
     Array<int> filteredChannels = Array<int>();
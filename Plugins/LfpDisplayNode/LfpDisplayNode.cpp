@@ -252,6 +252,13 @@ void LfpDisplayNode::handleTTLEvent(TTLEventPtr event)
                     // if an event came in on the trigger channel
                     //std::cout << "Setting latest current trigger to " << eventTime << std::endl;
                     latestCurrentTrigger.set(i, eventTime);
+
+                    // every trigger is passed to the averaging engine, which reads its window once it has been published
+                    if (splitDisplays[i]->displayBuffer != nullptr)
+                    {
+                        splitDisplays[i]->triggeredAverage->addTrigger(splitDisplays[i]->displayBuffer->getBlockStartSample()
+                                                                       + eventTime);
+                    }
                 }
             }
         }
@@ -293,7 +300,7 @@ void LfpDisplayNode::finalizeEventChannels()
     {
         if (latestTrigger[i] == -1 && latestCurrentTrigger[i] > -1) // received a trigger, but not yet acknowledged
         {
-            int triggerSample = latestCurrentTrigger[i] + splitDisplays[i]->displayBuffer->displayBufferIndices.getLast();
+            int triggerSample = latestCurrentTrigger[i] + splitDisplays[i]->displayBuffer->getBlockStartIndex();
             //std::cout << "Setting latest trigger to " << triggerSample << std::endl;
             latestTrigger.set(i, triggerSample);
         }
@@ -309,6 +316,9 @@ void LfpDisplayNode::finalizeEventChannels()
 
 void LfpDisplayNode::process (AudioBuffer<float>& buffer)
 {
+    // without a canvas, nothing will ever be drawn
+    if (CoreServices::isHeadless())
+        return;
 
     initializeEventChannels();
     checkForEvents();
@@ -322,6 +332,11 @@ void LfpDisplayNode::process (AudioBuffer<float>& buffer)
 
         displayBufferMap[streamId]->addData(buffer, chan, nSamples);
     }
+
+    for (auto displayBuffer : displayBuffers)
+    {
+        displayBuffer->publish(getNumSamplesInBlock(displayBuffer->id));
+    }
 }
 
 int64 LfpDisplayNode::getLatestTriggerTime(int id) const
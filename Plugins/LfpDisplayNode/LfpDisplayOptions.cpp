@@ -211,7 +211,7 @@ LfpDisplayOptions::LfpDisplayOptions(LfpDisplayCanvas* canvas_, LfpDisplaySplitt
     ttlWordLabel->setColour(Label::backgroundColourId, Colour(25,25,25));
     ttlWordLabel->setColour(Label::textColourId, Colour(120,120,100));
     addAndMakeVisible(ttlWordLabel.get());
-    startTimer(250);
+    FrameScheduler::getInstance()->addClient(this, 4.0f, false);
 
     // Pause button
     pauseButton = std::make_unique<UtilityButton>("Pause", Font("Default", "Plain", 15));
@@ -396,6 +396,33 @@ LfpDisplayOptions::LfpDisplayOptions(LfpDisplayCanvas* canvas_, LfpDisplaySplitt
     resetButton->setToggleState(false, sendNotification);
     addChildComponent(resetButton.get());
 
+    // time averaged before and after the trigger
+    averagePreWindows.add("50");
+    averagePreWindows.add("100");
+    averagePreWindows.add("200");
+    averagePreWindows.add("300");
+    averagePreWindows.add("400");
+
+    averagePreSelection = std::make_unique<ComboBox>("Pre-trigger window");
+    averagePreSelection->addItemList(averagePreWindows, 1);
+    averagePreSelection->setSelectedId(2, dontSendNotification);
+    averagePreSelection->setEditableText(true);
+    averagePreSelection->addListener(this);
+    addAndMakeVisible(averagePreSelection.get());
+
+    averagePostWindows.add("100");
+    averagePostWindows.add("250");
+    averagePostWindows.add("500");
+    averagePostWindows.add("1000");
+    averagePostWindows.add("2000");
+
+    averagePostSelection = std::make_unique<ComboBox>("Post-trigger window");
+    averagePostSelection->addItemList(averagePostWindows, 1);
+    averagePostSelection->setSelectedId(3, dontSendNotification);
+    averagePostSelection->setEditableText(true);
+    averagePostSelection->addListener(this);
+    addAndMakeVisible(averagePostSelection.get());
+
     // init show/hide options button
     showHideOptionsButton = std::make_unique<ShowHideOptionsButton>(this);
     showHideOptionsButton->addListener(this);
@@ -432,7 +459,7 @@ LfpDisplayOptions::LfpDisplayOptions(LfpDisplayCanvas* canvas_, LfpDisplaySplitt
 
 }
 
-void LfpDisplayOptions::timerCallback()
+void LfpDisplayOptions::renderFrame()
 {
     ttlWordLabel->setText(ttlWordString, dontSendNotification);
 }
@@ -539,6 +566,16 @@ void LfpDisplayOptions::resized()
         50, 
         height);
 
+    averagePreSelection->setBounds(getWidth() / 4 * 3 + 125,
+        getHeight() - startHeight + verticalSpacing * 2,
+        80,
+        height);
+
+    averagePostSelection->setBounds(getWidth() / 4 * 3 + 125,
+        getHeight() - startHeight + verticalSpacing * 3,
+        80,
+        height);
+
 
     showHideOptionsButton->setBounds (getWidth() - 28, getHeight() - 28, 20, 20);
 }
@@ -672,6 +709,22 @@ void LfpDisplayOptions::paint(Graphics& g)
         Justification::left,
         false);
 
+    g.drawText("Pre-trigger (ms):",
+        getWidth() / 4 * 3 + 10,
+        averagePreSelection->getY(),
+        150,
+        22,
+        Justification::left,
+        false);
+
+    g.drawText("Post-trigger (ms):",
+        getWidth() / 4 * 3 + 10,
+        averagePostSelection->getY(),
+        150,
+        22,
+        Justification::left,
+        false);
+
     /*g.drawText("Range("+ rangeUnits[selectedChannelType] +")",115,getHeight()-row1,300,20,Justification::left, false);
     
     g.drawText("Size(px)",5,getHeight()-row2,300,20,Justification::left, false);
@@ -849,6 +902,15 @@ void LfpDisplayOptions::setAveraging(bool state)
     }
 }
 
+void LfpDisplayOptions::setAverageWindow()
+{
+    // custom values are accepted, and limited by the averaging engine
+    const float preTrigger = jmax(0.0f, averagePreSelection->getText().getFloatValue());
+    const float postTrigger = jmax(0.0f, averagePostSelection->getText().getFloatValue());
+
+    canvasSplit->setAverageWindow(preTrigger / 1000.0f, postTrigger / 1000.0f);
+}
+
 void LfpDisplayOptions::setSortByDepth(bool state)
 {
 
@@ -1000,8 +1062,6 @@ void LfpDisplayOptions::setTimebaseAndSelectionText(float timebase)
         }
         
     }
-
-    timescale->setTimebase(canvasSplit->timebase);
 }
 
 void LfpDisplayOptions::comboBoxChanged(ComboBox* cb)
@@ -1099,8 +1159,6 @@ void LfpDisplayOptions::comboBoxChanged(ComboBox* cb)
         {
             setTimebaseAndSelectionText(cb->getText().getFloatValue());
         }
-
-        timescale->setTimebase(canvasSplit->timebase);
     }
     else if (cb == rangeSelection.get())
     {
@@ -1285,6 +1343,10 @@ void LfpDisplayOptions::comboBoxChanged(ComboBox* cb)
         canvasSplit->setTriggerChannel(cb->getSelectedId() - 2);
         processor->setParameter(cb->getSelectedId()-2, float(canvasSplit->splitID));
     }
+    else if (cb == averagePreSelection.get() || cb == averagePostSelection.get())
+    {
+        setAverageWindow();
+    }
 
 
     
@@ -1367,6 +1429,8 @@ void LfpDisplayOptions::saveParameters(XmlElement* xml)
     
     xmlNode->setAttribute("triggerSource", triggerSourceSelection->getSelectedId());
     xmlNode->setAttribute("trialAvg", averageSignalButton->getToggleState());
+    xmlNode->setAttribute("avgPreWindow", averagePreSelection->getText());
+    xmlNode->setAttribute("avgPostWindow", averagePostSelection->getText());
 
     xmlNode->setAttribute("singleChannelView", lfpDisplay->getSingleChannelShown());
 
@@ -1518,6 +1582,10 @@ void LfpDisplayOptions::loadParameters(XmlElement* xml)
             //LOGD("    --> setInputInverted: ", MS_FROM_START, " milliseconds");
             start = Time::getHighResolutionTicks();
 
+            averagePreSelection->setText(xmlNode->getStringAttribute("avgPreWindow", "100"), dontSendNotification);
+            averagePostSelection->setText(xmlNode->getStringAttribute("avgPostWindow", "500"), dontSendNotification);
+            setAverageWindow();
+
             setAveraging(xmlNode->getBoolAttribute("trialAvg", false));
             //LOGD("    --> setAveraging: ", MS_FROM_START, " milliseconds");
             start = Time::getHighResolutionTicks();
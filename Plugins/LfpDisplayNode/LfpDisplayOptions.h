@@ -44,7 +44,7 @@ class LfpDisplayOptions :
     public Component,
     public ComboBox::Listener,
     public Button::Listener,
-    public Timer
+    public FrameScheduler::Client
 {
 public:
 
@@ -126,6 +126,9 @@ public:
 
     /** Sets whether to use averaging in triggered display*/
     void setAveraging(bool);
+
+    /** Applies the pre- and post-trigger windows selected for averaging */
+    void setAverageWindow();
     
     /** Sets whether channel numbers should be shown instead of names */
     void setShowChannelNumbers(bool);
@@ -164,7 +167,8 @@ public:
     
     float selectedSaturationValueFloat;
     
-    void timerCallback();
+    /** Updates the TTL word label */
+    void renderFrame() override;
 
 private:
 
@@ -214,12 +218,16 @@ private:
     std::unique_ptr<ComboBox> triggerSourceSelection;
     std::unique_ptr<UtilityButton> averageSignalButton;
     std::unique_ptr<UtilityButton> resetButton;
+    std::unique_ptr<ComboBox> averagePreSelection;
+    std::unique_ptr<ComboBox> averagePostSelection;
      
     StringArray voltageRanges[CHANNEL_TYPES];
     StringArray timebases;
     StringArray spreads; // option for vertical spacing between channels
     StringArray colorGroupings; // option for coloring every N channels the same
     StringArray triggerSources; // option for trigger source event channel
+    StringArray averagePreWindows; // time averaged before the trigger (ms)
+    StringArray averagePostWindows; // time averaged after the trigger (ms)
     StringArray overlaps; //
     StringArray saturationThresholds; //default values for when different amplifiers saturate
     StringArray clipThresholds;
@@ -121,12 +121,11 @@ void LfpTimescale::setPausedState(bool isPaused_)
         timeOffset = 0;
         currentTimeOffset = timeOffset;
         isPaused = false;
-        stopTimer();
+        FrameScheduler::getInstance()->removeClient(this);
     }
     else {
         lfpDisplay->pause(true);
         isPaused = true;
-        startTimer(100);
     }
 
     repaint();
@@ -149,7 +148,7 @@ void LfpTimescale::mouseDown(const juce::MouseEvent& e)
 
 }
 
-void LfpTimescale::timerCallback()
+void LfpTimescale::renderFrame()
 {
 	if (isPaused && timeOffsetChanged)
 	{
@@ -205,6 +204,17 @@ bool LfpTimescale::keyPressed(const KeyPress &key)
             return true;
         }
     }
+    else if (key.isKeyCode(KeyPress::pageUpKey) || key.isKeyCode(KeyPress::pageDownKey))
+    {
+        // jump a full screen at a time through the history
+        const int pageDeltaX = key.isKeyCode(KeyPress::pageUpKey) ? getWidth() : -getWidth();
+
+        if(scrollTimescale(pageDeltaX))
+        {
+            currentTimeOffset = timeOffset;
+            return true;
+        }
+    }
 
     return false;
 }
@@ -219,12 +229,16 @@ bool LfpTimescale::scrollTimescale(int deltaX)
     if (timeOffset < 0)
         timeOffset = 0;
 
-    if (timeOffset > getWidth() * 3)
-        timeOffset = getWidth() * 3;
+    // the screen buffer covers three widths of scrollback, the display buffer's history much more
+    const int maxTimeOffset = jmax(getWidth() * 3, lfpDisplay->getMaxHistoryOffset());
+
+    if (timeOffset > maxTimeOffset)
+        timeOffset = maxTimeOffset;
 
     if (currentTimeOffset != timeOffset)
     {
         timeOffsetChanged = true;
+        FrameScheduler::getInstance()->requestFrame(this);
         return true;
     }
 
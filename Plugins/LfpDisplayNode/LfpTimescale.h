@@ -38,7 +38,7 @@ namespace LfpViewer {
  
  */
 class LfpTimescale : public Component,
-                     public Timer
+                     public FrameScheduler::Client
 {
 public:
 
@@ -67,8 +67,8 @@ public:
     /** Set paused state (called by options interface */
     void setPausedState(bool isPaused);
 
-    /** Timer callback -- used to throttle scrolling */
-    void timerCallback() override;
+    /** Applies the latest time offset -- scroll events are coalesced into one update per frame */
+    void renderFrame() override;
 
 private:
 
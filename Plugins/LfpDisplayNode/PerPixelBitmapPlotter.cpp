@@ -54,21 +54,8 @@ void PerPixelBitmapPlotter::plot(Image::BitmapData &bitmapData, LfpBitmapPlotter
     //if (yofs<0) {yofs=0;};
     
     if (pInfo.samp < 0) {pInfo.samp = 0;};
-    if (pInfo.samp >= display->lfpChannelBitmap.getWidth()) {pInfo.samp = display->lfpChannelBitmap.getWidth()-1;}; // this shouldnt happen, there must be some bug above - to replicate, run at max refresh rate where draws overlap the right margin by a lot
+    if (pInfo.samp >= bitmapData.width) {pInfo.samp = bitmapData.width-1;}; // this shouldnt happen, there must be some bug above - to replicate, run at max refresh rate where draws overlap the right margin by a lot
     
-    if (jfrom<0) {jfrom=0;};
-    if (jto >= display->lfpChannelBitmap.getHeight()) {jto=display->lfpChannelBitmap.getHeight()-1;};
-    
-    for (int j = jfrom; j <= jto; j += 1)
-    {
-        
-        //uint8* const pu8Pixel = bdSharedLfpDisplay.getPixelPointer(	(int)(i),(int)(j));
-        //*(pu8Pixel)		= 200;
-        //*(pu8Pixel+1)	= 200;
-        //*(pu8Pixel+2)	= 200;
-        
-        bitmapData.setPixelColour(pInfo.samp,j,pInfo.lineColour);
-        
-    }
+    fillColumn(bitmapData, pInfo.samp, jfrom, jto, pInfo.lineColour.getPixelARGB());
 }
 
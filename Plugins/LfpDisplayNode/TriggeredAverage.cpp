@@ -0,0 +1,334 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "TriggeredAverage.h"
+#include "DisplayBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace LfpViewer {
+
+/** Longest window that can be averaged after the trigger (in s) */
+#define MAX_POST_WINDOW_S 2.0f
+
+/** Time the pre-trigger samples must stay in the display buffer after the trigger is queued (in s) */
+#define TRIGGER_LATENCY_S 0.1f
+
+/** Number of triggers that can be queued between two passes of the worker */
+#define TRIGGER_QUEUE_SIZE 256
+
+/** Interval between passes of the worker (in ms) */
+#define UPDATE_INTERVAL_MS 10
+
+TriggeredAverage::TriggeredAverage() :
+    Thread("Triggered Average"),
+    source(nullptr),
+    numChannels(0),
+    requestedPreSamples(0),
+    requestedPostSamples(0),
+    preSamples(0),
+    windowLength(0),
+    triggerFifo(TRIGGER_QUEUE_SIZE),
+    enabled(false),
+    version(0)
+{
+    triggerQueue.calloc(TRIGGER_QUEUE_SIZE);
+}
+
+TriggeredAverage::~TriggeredAverage()
+{
+    stopThread(1000);
+}
+
+void TriggeredAverage::setSource(DisplayBuffer* buffer)
+{
+    const ScopedLock lock(sourceLock);
+
+    const int channels = buffer != nullptr ? buffer->numChannels : 0;
+
+    if (buffer == source && channels == numChannels)
+        return;
+
+    {
+        const ScopedLock statisticsLock(resultLock);
+
+        source = buffer;
+        numChannels = channels;
+    }
+
+    // the window is limited by the source's sample rate and length
+    updateWindow(true);
+}
+
+void TriggeredAverage::setWindow(int preSamples_, int postSamples_)
+{
+    const ScopedLock lock(sourceLock);
+
+    requestedPreSamples = preSamples_;
+    requestedPostSamples = postSamples_;
+
+    updateWindow(false);
+}
+
+void TriggeredAverage::updateWindow(bool channelsChanged)
+{
+    int maxPre = 0;
+    int maxPost = 0;
+
+    if (source != nullptr)
+    {
+        // the first samples of a trial are read once the worker sees the trigger, while the
+        // newest half of the buffer is still readable
+        maxPre = jmax(0, source->getNumSamples() / 2 - int(source->sampleRate * TRIGGER_LATENCY_S));
+        maxPost = int(source->sampleRate * MAX_POST_WINDOW_S);
+    }
+
+    const int pre = jlimit(0, maxPre, requestedPreSamples);
+    const int length = pre + jlimit(0, maxPost, requestedPostSamples);
+
+    if (!channelsChanged && pre == preSamples && length == windowLength)
+        return;
+
+    {
+        // summarize() may be reading the previous statistics
+        const ScopedLock lock(resultLock);
+
+        preSamples = pre;
+        windowLength = length;
+
+        runningMean.calloc(size_t(numChannels) * size_t(windowLength));
+        runningSquares.calloc(size_t(numChannels) * size_t(windowLength));
+        trialCount.calloc(windowLength);
+        inverseCount.calloc(windowLength);
+    }
+
+    clearTrials();
+}
+
+void TriggeredAverage::reset()
+{
+    const ScopedLock lock(sourceLock);
+
+    clearTrials();
+}
+
+void TriggeredAverage::clearTrials()
+{
+    {
+        const ScopedLock lock(resultLock);
+
+        if (numChannels > 0 && windowLength > 0)
+        {
+            FloatVectorOperations::clear(runningMean.getData(), numChannels * windowLength);
+            FloatVectorOperations::clear(runningSquares.getData(), numChannels * windowLength);
+        }
+
+        for (int i = 0; i < windowLength; i++)
+            trialCount[i] = 0;
+    }
+
+    trials.clear();
+
+    // triggers queued for the previous settings are dropped
+    triggerFifo.finishedRead(triggerFifo.getNumReady());
+
+    version++;
+}
+
+void TriggeredAverage::addTrigger(int64 sampleNumber)
+{
+    if (!enabled)
+        return;
+
+    int start1, size1, start2, size2;
+    triggerFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 > 0)
+    {
+        triggerQueue[start1] = sampleNumber;
+        triggerFifo.finishedWrite(1);
+    }
+}
+
+int TriggeredAverage::getNumTrials()
+{
+    const ScopedLock lock(resultLock);
+
+    return windowLength > 0 ? trialCount[windowLength - 1] : 0;
+}
+
+void TriggeredAverage::run()
+{
+    while (!threadShouldExit())
+    {
+        if (processTrials())
+            version++;
+
+        wait(UPDATE_INTERVAL_MS);
+    }
+}
+
+bool TriggeredAverage::processTrials()
+{
+    const ScopedLock lock(sourceLock);
+
+    int start1, size1, start2, size2;
+    const int numTriggers = triggerFifo.getNumReady();
+    triggerFifo.prepareToRead(numTriggers, start1, size1, start2, size2);
+
+    for (int i = 0; i < size1 + size2; i++)
+    {
+        const int64 triggerSample = triggerQueue[i < size1 ? start1 + i : start2 + i - size1];
+
+        if (triggerSample - preSamples >= 0)
+            trials.push_back({ triggerSample - preSamples, 0 });
+    }
+
+    triggerFifo.finishedRead(size1 + size2);
+
+    if (source == nullptr || numChannels == 0 || windowLength == 0)
+    {
+        trials.clear();
+        return false;
+    }
+
+    const int64 samplesWritten = source->getSamplesWritten();
+
+    // the block after the published samples may already be overwriting the oldest half of the buffer
+    const int64 oldestReadable = samplesWritten - source->getNumSamples() / 2;
+
+    bool changed = false;
+
+    for (auto& trial : trials)
+    {
+        const int64 nextSample = trial.firstSample + trial.samplesDone;
+        const int available = int(jmin(int64(windowLength - trial.samplesDone), samplesWritten - nextSample));
+
+        if (available <= 0)
+            continue;
+
+        if (nextSample < oldestReadable)
+        {
+            // the worker fell behind, and the rest of this trial has been overwritten
+            trial.samplesDone = windowLength;
+            continue;
+        }
+
+        accumulate(trial, available);
+        changed = true;
+    }
+
+    trials.erase(std::remove_if(trials.begin(), trials.end(),
+                                [this](const Trial& trial) { return trial.samplesDone >= windowLength; }),
+                 trials.end());
+
+    return changed;
+}
+
+void TriggeredAverage::accumulate(Trial& trial, int numSamples)
+{
+    const ScopedLock lock(resultLock);
+
+    const int bufferSize = source->getNumSamples();
+
+    while (numSamples > 0)
+    {
+        const int position = trial.samplesDone;
+        const int index = int((trial.firstSample + position) % bufferSize);
+        const int chunk = jmin(numSamples, bufferSize - index);
+
+        // every channel of this trial shares the same count at each position
+        for (int i = position; i < position + chunk; i++)
+            inverseCount[i] = 1.0f / float(++trialCount[i]);
+
+        for (int channel = 0; channel < numChannels; channel++)
+        {
+            const float* x = source->getReadPointer(channel, index);
+            float* mean = runningMean + size_t(channel) * windowLength + position;
+            float* squares = runningSquares + size_t(channel) * windowLength + position;
+            const float* scale = inverseCount + position;
+
+            for (int i = 0; i < chunk; i++)
+            {
+                const float delta = x[i] - mean[i];
+                mean[i] += delta * scale[i];
+                squares[i] += delta * (x[i] - mean[i]);
+            }
+        }
+
+        trial.samplesDone += chunk;
+        numSamples -= chunk;
+    }
+}
+
+void TriggeredAverage::summarize(int channel, double samplesPerColumn, int numColumns,
+                                 float* minimum, float* mean, float* maximum,
+                                 float* standardDeviation)
+{
+    const ScopedLock lock(resultLock);
+
+    for (int column = 0; column < numColumns; column++)
+    {
+        const int start = int(column * samplesPerColumn);
+        const int end = jmin(windowLength, jmax(start + 1, int((column + 1) * samplesPerColumn)));
+
+        if (channel >= numChannels || start >= windowLength || trialCount[start] == 0)
+        {
+            minimum[column] = mean[column] = maximum[column] = 0.0f;
+
+            if (standardDeviation != nullptr)
+                standardDeviation[column] = 0.0f;
+
+            continue;
+        }
+
+        const float* values = runningMean + size_t(channel) * windowLength + start;
+        const Range<float> range = FloatVectorOperations::findMinAndMax(values, end - start);
+
+        float sum = 0.0f;
+
+        for (int i = 0; i < end - start; i++)
+            sum += values[i];
+
+        minimum[column] = range.getStart();
+        maximum[column] = range.getEnd();
+        mean[column] = sum / float(end - start);
+
+        if (standardDeviation != nullptr)
+        {
+            const float* squares = runningSquares + size_t(channel) * windowLength + start;
+            float deviation = 0.0f;
+
+            for (int i = start; i < end; i++)
+            {
+                if (trialCount[i] > 1)
+                    deviation += std::sqrt(squares[i - start] / float(trialCount[i] - 1));
+            }
+
+            standardDeviation[column] = deviation / float(end - start);
+        }
+    }
+}
+
+};
@@ -0,0 +1,160 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#ifndef __TRIGGEREDAVERAGE_H__
+#define __TRIGGEREDAVERAGE_H__
+
+#include <ProcessorHeaders.h>
+
+#include <atomic>
+#include <vector>
+
+namespace LfpViewer {
+
+class DisplayBuffer;
+
+    //==============================================================================
+    /**
+
+        Event-triggered average of the channels of one DisplayBuffer.
+
+        Triggers are queued from the audio thread. A worker thread reads each
+        trial's window from the display buffer as soon as its samples have been
+        published, and updates a running mean and variance (Welford's method)
+        for every channel at the buffer's full sample rate.
+
+        Trials are accumulated incrementally, so windows can be longer than the
+        display buffer, and overlapping trials are handled independently. The
+        display only summarizes the result when it changes.
+
+    */
+    class TriggeredAverage : public Thread
+    {
+    public:
+
+        /** Constructor */
+        TriggeredAverage();
+
+        /** Destructor */
+        ~TriggeredAverage();
+
+        /** Sets the buffer that trials are read from (or nullptr). Clears the average if the buffer changes. */
+        void setSource(DisplayBuffer* buffer);
+
+        /** Sets the number of samples averaged before and after each trigger.
+            Clears the average if the window changes. The pre-trigger window is limited to
+            samples that are still in the source buffer when the trigger is processed, and
+            the post-trigger window is limited separately. */
+        void setWindow(int preSamples, int postSamples);
+
+        /** Returns the number of samples before the trigger */
+        int getPreSamples() const { return preSamples; }
+
+        /** Returns the total number of samples in the window */
+        int getWindowLength() const { return windowLength; }
+
+        /** Discards all trials */
+        void reset();
+
+        /** Starts or stops accepting triggers */
+        void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+
+        /** Queues a trigger, given as a sample number counted by DisplayBuffer::getSamplesWritten().
+            Called from the audio thread. */
+        void addTrigger(int64 sampleNumber);
+
+        /** Returns the number of trials that have been averaged over the whole window */
+        int getNumTrials();
+
+        /** Returns a counter that is incremented whenever the average changes */
+        int getVersion() const { return version.load(); }
+
+        /** Summarizes the average of one channel in numColumns consecutive columns of samplesPerColumn
+            samples, starting at the beginning of the window. Columns that no trial has reached yet are
+            set to zero. Optionally writes the mean standard deviation across trials of each column. */
+        void summarize(int channel, double samplesPerColumn, int numColumns,
+                       float* minimum, float* mean, float* maximum,
+                       float* standardDeviation = nullptr);
+
+        /** Accumulates trials until the thread is stopped */
+        void run() override;
+
+    private:
+
+        /** A trial whose window has not been fully accumulated yet */
+        struct Trial
+        {
+            int64 firstSample;
+            int samplesDone;
+        };
+
+        /** Moves queued triggers to the list of trials and accumulates any newly published samples.
+            Returns true if the average changed. */
+        bool processTrials();
+
+        /** Adds the next numSamples samples of a trial to the running statistics */
+        void accumulate(Trial& trial, int numSamples);
+
+        /** Limits the requested window to the source, and reallocates the running statistics if the
+            window or number of channels changed (sourceLock must be held) */
+        void updateWindow(bool channelsChanged);
+
+        /** Clears the running statistics and pending trials (sourceLock must be held) */
+        void clearTrials();
+
+        /** Guards the source and window; held by the worker while reading from the source */
+        CriticalSection sourceLock;
+
+        /** Guards the running statistics */
+        CriticalSection resultLock;
+
+        DisplayBuffer* source;
+
+        int numChannels;
+
+        /** Window as requested, and as limited by the source's sample rate and length */
+        int requestedPreSamples;
+        int requestedPostSamples;
+        int preSamples;
+        int windowLength;
+
+        /** Running mean and sum of squared deviations, windowLength values per channel */
+        HeapBlock<float> runningMean;
+        HeapBlock<float> runningSquares;
+
+        /** Number of trials that reached each sample of the window */
+        HeapBlock<int> trialCount;
+        HeapBlock<float> inverseCount;
+
+        std::vector<Trial> trials;
+
+        AbstractFifo triggerFifo;
+        HeapBlock<int64> triggerQueue;
+
+        std::atomic<bool> enabled;
+        std::atomic<int> version;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TriggeredAverage);
+    };
+};
+
+#endif //__TRIGGEREDAVERAGE_H__
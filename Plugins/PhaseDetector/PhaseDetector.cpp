@@ -29,8 +29,16 @@ PhaseDetectorSettings::PhaseDetectorSettings() :
     lastSample(0.0f),
     isActive(true),
     wasTriggered(false),
-    detectorType(PEAK),
+    outputLineChanged(false),
+    lastOutputLine(0),
     currentPhase(NO_PHASE),
+    detectorType(PEAK),
+    estimatorType(ZERO_CROSSING),
+    sampleRate(0.0f),
+    lowCut(4.0f),
+    highCut(12.0f),
+    targetPhase(0.0f),
+    lastPhaseError(0.0f),
     triggerChannel(0),
     outputLine(0),
     gateLine(0)
@@ -38,6 +46,12 @@ PhaseDetectorSettings::PhaseDetectorSettings() :
 
 }
 
+void PhaseDetectorSettings::updateEstimator()
+{
+    estimator.prepare(1, sampleRate, lowCut, highCut);
+    lastPhaseError = 0.0f;
+}
+
 TTLEventPtr PhaseDetectorSettings::createEvent(int64 sample_number, bool state)
 {
 
@@ -87,6 +101,17 @@ PhaseDetector::PhaseDetector() : GenericProcessor ("Phase Detector")
          "RISING ZERO-CROSSING"
           },
         0);
+    addCategoricalParameter(Parameter::STREAM_SCOPE,
+        "estimator",
+        "The method used to estimate phase",
+        { "ZERO-CROSSING",
+          "HILBERT"
+        },
+        0);
+    addFloatParameter(Parameter::STREAM_SCOPE, "target_phase", "Target phase for the Hilbert estimator (degrees, 0 = peak)", 0, 0, 360, 1);
+    addFloatParameter(Parameter::STREAM_SCOPE, "lead_ms", "Time by which to advance the Hilbert estimator output (ms)", 0, 0, 100, 0.1);
+    addFloatParameter(Parameter::STREAM_SCOPE, "low_cut", "Lower edge of the Hilbert estimator band (Hz)", 4, 0.1, 1000, 0.1, true);
+    addFloatParameter(Parameter::STREAM_SCOPE, "high_cut", "Upper edge of the Hilbert estimator band (Hz)", 12, 0.1, 1000, 0.1, true);
 }
 
 AudioProcessorEditor* PhaseDetector::createEditor()
@@ -127,6 +152,35 @@ void PhaseDetector::parameterValueChanged(Parameter* param)
     {
         settings[param->getStreamId()]->gateLine = (int)param->getValue() - 1;
     }
+    else if (param->getName().equalsIgnoreCase("estimator"))
+    {
+        settings[param->getStreamId()]->estimatorType = EstimatorType((int) param->getValue());
+    }
+    else if (param->getName().equalsIgnoreCase("target_phase"))
+    {
+        settings[param->getStreamId()]->targetPhase = degreesToRadians((float) param->getValue());
+    }
+    else if (param->getName().equalsIgnoreCase("lead_ms"))
+    {
+        settings[param->getStreamId()]->estimator.setLead((float) param->getValue());
+    }
+    else if (param->getName().equalsIgnoreCase("low_cut")
+             || param->getName().equalsIgnoreCase("high_cut"))
+    {
+        const DataStream* stream = getDataStream(param->getStreamId());
+
+        if ((float) (*stream)["low_cut"] >= (float) (*stream)["high_cut"])
+        {
+            param->restorePreviousValue();
+            return;
+        }
+
+        PhaseDetectorSettings* module = settings[param->getStreamId()];
+
+        module->lowCut = (*stream)["low_cut"];
+        module->highCut = (*stream)["high_cut"];
+        module->updateEstimator();
+    }
 
 }
 
@@ -141,6 +195,16 @@ void PhaseDetector::updateSettings()
         parameterValueChanged(stream->getParameter("Channel"));
         parameterValueChanged(stream->getParameter("TTL_out"));
         parameterValueChanged(stream->getParameter("gate_line"));
+        parameterValueChanged(stream->getParameter("estimator"));
+        parameterValueChanged(stream->getParameter("target_phase"));
+        parameterValueChanged(stream->getParameter("lead_ms"));
+
+        PhaseDetectorSettings* module = settings[stream->getStreamId()];
+
+        module->sampleRate = stream->getSampleRate();
+        module->lowCut = (*stream)["low_cut"];
+        module->highCut = (*stream)["high_cut"];
+        module->updateEstimator();
 
         EventChannel::Settings s{
             EventChannel::Type::TTL,
@@ -175,6 +239,20 @@ void PhaseDetector::handleTTLEvent (TTLEventPtr event)
 }
 
 
+bool PhaseDetector::startAcquisition()
+{
+    for (auto stream : getDataStreams())
+    {
+        PhaseDetectorSettings* module = settings[stream->getStreamId()];
+
+        module->estimator.reset();
+        module->lastPhaseError = 0.0f;
+    }
+
+    return true;
+}
+
+
 void PhaseDetector::process (AudioBuffer<float>& buffer)
 {
     checkForEvents();
@@ -196,110 +274,12 @@ void PhaseDetector::process (AudioBuffer<float>& buffer)
                 && module->triggerChannel >= 0
                 && module->triggerChannel < buffer.getNumChannels())
             {
-                for (int i = 0; i < numSamplesInBlock; ++i)
-                {
-                    const float sample = *buffer.getReadPointer(module->triggerChannel, i);
-
-                    if (sample < module->lastSample
-                        && sample > 0
-                        && module->currentPhase != FALLING_POS)
-                    {
-                        if (module->detectorType == PEAK)
-                        {
-                            TTLEventPtr ptr = module->createEvent(
-                                                                  firstSampleInBlock + i,
-                                                                  true);
-
-                            addEvent(ptr, i);
-
-                            //LOGD("[phase detector] PEAK found!");
-                        }
-
-                        module->currentPhase = FALLING_POS;
-                    }
-                    else if (sample < 0
-                        && module->lastSample >= 0
-                        && module->currentPhase != FALLING_NEG)
-                    {
-                        if (module->detectorType == FALLING_ZERO)
-                        {
-
-                            TTLEventPtr ptr = module->createEvent(
-                                                                  firstSampleInBlock + i,
-                                                                  true);
-
-                            addEvent(ptr, i);
-
-                            //("FALLING ZERO");
-                        }
-
-                        module->currentPhase = FALLING_NEG;
-                    }
-                    else if (sample > module->lastSample
-                        && sample < 0
-                        && module->currentPhase != RISING_NEG)
-                    {
-                        if (module->detectorType == TROUGH)
-                        {
-
-                            TTLEventPtr ptr = module->createEvent(
-                                                                  firstSampleInBlock + i,
-                                                                  true);
-
-                            addEvent(ptr, i);
-
-                            //LOGD("TROUGH");
-                        }
-
-                        module->currentPhase = RISING_NEG;
-                    }
-                    else if (sample > 0
-                        && module->lastSample <= 0
-                        && module->currentPhase != RISING_POS)
-                    {
-                        if (module->detectorType == RISING_ZERO)
-                        {
-                            TTLEventPtr ptr = module->createEvent(
-                                                                  firstSampleInBlock + i,
-                                                                  true);
-
-                            addEvent(ptr, i);
-
-                            //LOGD("RISING ZERO");
-                        }
-
-                        module->currentPhase = RISING_POS;
-                    }
-
-                    module->lastSample = sample;
-
-                    if (module->wasTriggered)
-                    {
-                        if (module->samplesSinceTrigger > 2000)
-                        {
-                            TTLEventPtr ptr = module->createEvent(
-                                                                  firstSampleInBlock + i,
-                                                                  false);
-
-                            addEvent(ptr, i);
-
-                            //LOGD("TURNING OFF");
-                        }
-                        else
-                        {
-                            module->samplesSinceTrigger++;
-                        }
-                    }
-
-                    if (module->outputLineChanged)
-                    {
-                        TTLEventPtr ptr = module->clearOutputLine(
-                                                                 firstSampleInBlock + i);
-
-                        addEvent(ptr, i);
-
-                    }
-                }
+                const float* samples = buffer.getReadPointer(module->triggerChannel);
+
+                if (module->estimatorType == HILBERT)
+                    detectHilbertPhase(module, samples, firstSampleInBlock, numSamplesInBlock);
+                else
+                    detectZeroCrossings(module, samples, firstSampleInBlock, numSamplesInBlock);
             }
 
             // If event is on when 'None' is selected in channel selector, turn off event
@@ -316,3 +296,167 @@ void PhaseDetector::process (AudioBuffer<float>& buffer)
 }
 
 
+void PhaseDetector::detectZeroCrossings(PhaseDetectorSettings* module,
+                                        const float* samples,
+                                        int64 firstSampleInBlock,
+                                        int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float sample = samples[i];
+
+        if (sample < module->lastSample
+            && sample > 0
+            && module->currentPhase != FALLING_POS)
+        {
+            if (module->detectorType == PEAK)
+            {
+                TTLEventPtr ptr = module->createEvent(
+                                                      firstSampleInBlock + i,
+                                                      true);
+
+                addEvent(ptr, i);
+
+                //LOGD("[phase detector] PEAK found!");
+            }
+
+            module->currentPhase = FALLING_POS;
+        }
+        else if (sample < 0
+            && module->lastSample >= 0
+            && module->currentPhase != FALLING_NEG)
+        {
+            if (module->detectorType == FALLING_ZERO)
+            {
+
+                TTLEventPtr ptr = module->createEvent(
+                                                      firstSampleInBlock + i,
+                                                      true);
+
+                addEvent(ptr, i);
+
+                //("FALLING ZERO");
+            }
+
+            module->currentPhase = FALLING_NEG;
+        }
+        else if (sample > module->lastSample
+            && sample < 0
+            && module->currentPhase != RISING_NEG)
+        {
+            if (module->detectorType == TROUGH)
+            {
+
+                TTLEventPtr ptr = module->createEvent(
+                                                      firstSampleInBlock + i,
+                                                      true);
+
+                addEvent(ptr, i);
+
+                //LOGD("TROUGH");
+            }
+
+            module->currentPhase = RISING_NEG;
+        }
+        else if (sample > 0
+            && module->lastSample <= 0
+            && module->currentPhase != RISING_POS)
+        {
+            if (module->detectorType == RISING_ZERO)
+            {
+                TTLEventPtr ptr = module->createEvent(
+                                                      firstSampleInBlock + i,
+                                                      true);
+
+                addEvent(ptr, i);
+
+                //LOGD("RISING ZERO");
+            }
+
+            module->currentPhase = RISING_POS;
+        }
+
+        module->lastSample = sample;
+
+        updateOutputState(module, firstSampleInBlock, i);
+    }
+}
+
+
+void PhaseDetector::detectHilbertPhase(PhaseDetectorSettings* module,
+                                       const float* samples,
+                                       int64 firstSampleInBlock,
+                                       int numSamples)
+{
+    if (module->estimator.getNumChannels() == 0)
+        return;
+
+    // only grows the buffer the first time a larger block arrives
+    module->phaseBuffer.setSize(1, numSamples, false, false, true);
+
+    float* phase = module->phaseBuffer.getWritePointer(0);
+
+    module->estimator.process(&samples, numSamples, &phase);
+
+    const bool primed = module->estimator.isPrimed();
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float error = phase[i] - module->targetPhase;
+
+        if (error > MathConstants<float>::pi)
+            error -= MathConstants<float>::twoPi;
+        else if (error <= -MathConstants<float>::pi)
+            error += MathConstants<float>::twoPi;
+
+        // crossing from below, excluding the jump where the error wraps around
+        if (primed
+            && module->lastPhaseError < 0
+            && error >= 0
+            && error - module->lastPhaseError < MathConstants<float>::pi)
+        {
+            TTLEventPtr ptr = module->createEvent(
+                                                  firstSampleInBlock + i,
+                                                  true);
+
+            addEvent(ptr, i);
+        }
+
+        module->lastPhaseError = error;
+
+        updateOutputState(module, firstSampleInBlock, i);
+    }
+}
+
+
+void PhaseDetector::updateOutputState(PhaseDetectorSettings* module,
+                                      int64 firstSampleInBlock,
+                                      int sampleIndex)
+{
+    if (module->wasTriggered)
+    {
+        if (module->samplesSinceTrigger > 2000)
+        {
+            TTLEventPtr ptr = module->createEvent(
+                                                  firstSampleInBlock + sampleIndex,
+                                                  false);
+
+            addEvent(ptr, sampleIndex);
+
+            //LOGD("TURNING OFF");
+        }
+        else
+        {
+            module->samplesSinceTrigger++;
+        }
+    }
+
+    if (module->outputLineChanged)
+    {
+        TTLEventPtr ptr = module->clearOutputLine(
+                                                 firstSampleInBlock + sampleIndex);
+
+        addEvent(ptr, sampleIndex);
+
+    }
+}
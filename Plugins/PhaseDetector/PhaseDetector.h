@@ -26,6 +26,8 @@
 
 #include <ProcessorHeaders.h>
 
+#include "PhaseEstimator.h"
+
 enum PhaseType
 {
     NO_PHASE = 0, RISING_POS, FALLING_POS, FALLING_NEG, RISING_NEG
@@ -36,6 +38,11 @@ enum DetectorType
     PEAK = 0, FALLING_ZERO, TROUGH, RISING_ZERO
 };
 
+enum EstimatorType
+{
+    ZERO_CROSSING = 0, HILBERT
+};
+
 /** Holds settings for one stream's phase detector*/
 class PhaseDetectorSettings
 {
@@ -52,6 +59,9 @@ public:
     /** Clears the output bit*/
     TTLEventPtr clearOutputLine(int64 sample_number);
 
+    /** Re-designs the phase estimator for the current band*/
+    void updateEstimator();
+
     int samplesSinceTrigger;
 
     float lastSample;
@@ -64,6 +74,20 @@ public:
 
     PhaseType currentPhase;
     DetectorType detectorType;
+    EstimatorType estimatorType;
+
+    PhaseEstimator estimator;
+    AudioBuffer<float> phaseBuffer;
+
+    float sampleRate;
+    float lowCut;
+    float highCut;
+
+    /** Target phase for the HILBERT estimator (radians, 0 = peak)*/
+    float targetPhase;
+
+    /** Predicted phase minus target phase at the previous sample*/
+    float lastPhaseError;
 
     int triggerChannel;
     int outputLine;
@@ -76,6 +100,11 @@ public:
     Uses peaks, troughs, and zero crossings to estimate 
     the phase of a continuous signal.
 
+    Alternatively, a causal band-limited Hilbert transform
+    (see PhaseEstimator) can track the instantaneous phase, 
+    which allows triggering at any phase, with a lead that 
+    compensates for known output latency.
+
     See Siegle & Wilson (2014) for an example application
     https://elifesciences.org/articles/03061
 
@@ -102,10 +131,22 @@ public:
     /** Called when a parameter is updated*/
     void parameterValueChanged(Parameter* param) override;
 
+    /** Resets the phase estimators before acquisition starts*/
+    bool startAcquisition() override;
+
 private:
     /** Called whenever a new TTL event arrives*/
     void handleTTLEvent (TTLEventPtr event) override;
 
+    /** Detects peaks, troughs, and zero crossings from the sign and slope of the raw signal*/
+    void detectZeroCrossings(PhaseDetectorSettings* module, const float* samples, int64 firstSampleInBlock, int numSamples);
+
+    /** Detects crossings of the target phase predicted by the Hilbert estimator*/
+    void detectHilbertPhase(PhaseDetectorSettings* module, const float* samples, int64 firstSampleInBlock, int numSamples);
+
+    /** Turns the output off after a trigger and clears a previous output line*/
+    void updateOutputState(PhaseDetectorSettings* module, int64 firstSampleInBlock, int sampleIndex);
+
     StreamSettings<PhaseDetectorSettings> settings;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PhaseDetector);
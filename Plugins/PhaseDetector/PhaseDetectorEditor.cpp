@@ -33,7 +33,7 @@ PhaseDetectorEditor::PhaseDetectorEditor(GenericProcessor* parentNode)
     : GenericEditor(parentNode)
 
 {
-    desiredWidth = 220;
+    desiredWidth = 400;
 
     addSelectedChannelsParameterEditor("Channel", 120, 105);
     addComboBoxParameterEditor("TTL_out", 15, 30);
@@ -42,6 +42,12 @@ PhaseDetectorEditor::PhaseDetectorEditor(GenericProcessor* parentNode)
     Parameter* param = getProcessor()->getParameter("phase");
     addCustomParameterEditor(new DetectorInterface(param), 110, 25);
 
+    addComboBoxParameterEditor("estimator", 220, 30);
+    addTextBoxParameterEditor("target_phase", 220, 80);
+    addTextBoxParameterEditor("lead_ms", 310, 30);
+    addTextBoxParameterEditor("low_cut", 310, 80);
+    addTextBoxParameterEditor("high_cut", 310, 120);
+
 }
 
 
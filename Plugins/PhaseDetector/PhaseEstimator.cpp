@@ -0,0 +1,224 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PhaseEstimator.h"
+
+#include <cmath>
+
+namespace
+{
+    /** Oversampling of the upper band edge after decimation*/
+    const float DECIMATED_OVERSAMPLING = 8.0f;
+
+    /** Smoothing applied to the instantaneous frequency estimate*/
+    const float OMEGA_SMOOTHING = 0.1f;
+
+    const int MIN_HALF_LENGTH = 8;
+    const int MAX_HALF_LENGTH = 256;
+
+    inline float wrapPhase (float phase)
+    {
+        const float twoPi = MathConstants<float>::twoPi;
+
+        phase = std::fmod (phase + MathConstants<float>::pi, twoPi);
+
+        if (phase < 0.0f)
+            phase += twoPi;
+
+        return phase - MathConstants<float>::pi;
+    }
+}
+
+PhaseEstimator::PhaseEstimator() :
+    halfLength (MIN_HALF_LENGTH),
+    historyLength (2 * MIN_HALF_LENGTH + 1),
+    decimationFactor (1),
+    numChannels (0),
+    writeIndex (0),
+    samplesInAccumulator (0),
+    samplesSinceUpdate (0),
+    samplesSeen (0),
+    sampleRate (0.0f),
+    leadMs (0.0f),
+    minOmega (0.0f),
+    maxOmega (0.0f),
+    leadSamples (0.0f),
+    delaySamples (0.0f),
+    centreCoefficient (0.0f)
+{
+
+}
+
+void PhaseEstimator::prepare (int numChannels_, float sampleRate_, float lowCut, float highCut)
+{
+    numChannels = jmax (0, numChannels_);
+    sampleRate = sampleRate_;
+
+    if (sampleRate <= 0.0f || lowCut <= 0.0f || highCut <= lowCut)
+    {
+        numChannels = 0;
+        return;
+    }
+
+    decimationFactor = jmax (1, int (sampleRate / (DECIMATED_OVERSAMPLING * highCut)));
+
+    const double decimatedRate = sampleRate / decimationFactor;
+
+    // filter spans one cycle of the lowest frequency in the band
+    halfLength = jlimit (MIN_HALF_LENGTH, MAX_HALF_LENGTH,
+                         roundToInt (decimatedRate / (2.0 * lowCut)));
+    historyLength = 2 * halfLength + 1;
+
+    const double w1 = MathConstants<double>::twoPi * lowCut / decimatedRate;
+    const double w2 = MathConstants<double>::twoPi * jmin (double (highCut), decimatedRate / 2.0) / decimatedRate;
+
+    realCoefficients.malloc (halfLength + 1);
+    imagCoefficients.malloc (halfLength + 1);
+
+    centreCoefficient = float ((w2 - w1) / MathConstants<double>::pi);
+
+    for (int k = 1; k <= halfLength; k++)
+    {
+        const double window = 0.54 + 0.46 * std::cos (MathConstants<double>::pi * k / (halfLength + 1));
+        const double piK = MathConstants<double>::pi * k;
+
+        realCoefficients[k] = float (window * (std::sin (w2 * k) - std::sin (w1 * k)) / piK);
+        imagCoefficients[k] = float (window * (std::cos (w1 * k) - std::cos (w2 * k)) / piK);
+    }
+
+    minOmega = float (w1 / decimationFactor);
+    maxOmega = float (w2 / decimationFactor);
+
+    // group delay of the FIR pair plus the delay of the averaging stage
+    delaySamples = float (halfLength * decimationFactor) + (decimationFactor - 1) / 2.0f;
+
+    history.calloc (2 * historyLength * numChannels);
+    accumulator.calloc (numChannels);
+    realPart.calloc (numChannels);
+    imagPart.calloc (numChannels);
+    phase.calloc (numChannels);
+    omega.calloc (numChannels);
+
+    setLead (leadMs);
+    reset();
+}
+
+void PhaseEstimator::setLead (float leadMs_)
+{
+    leadMs = leadMs_;
+    leadSamples = leadMs * sampleRate / 1000.0f;
+}
+
+void PhaseEstimator::reset()
+{
+    writeIndex = 0;
+    samplesInAccumulator = 0;
+    samplesSinceUpdate = 0;
+    samplesSeen = 0;
+
+    if (numChannels == 0)
+        return;
+
+    FloatVectorOperations::clear (history.getData(), 2 * historyLength * numChannels);
+    FloatVectorOperations::clear (accumulator.getData(), numChannels);
+    FloatVectorOperations::clear (phase.getData(), numChannels);
+    FloatVectorOperations::fill (omega.getData(), (minOmega + maxOmega) / 2.0f, numChannels);
+}
+
+void PhaseEstimator::updateAnalyticSignal()
+{
+    float* newest = history.getData() + writeIndex * numChannels;
+    float* newestCopy = newest + historyLength * numChannels;
+
+    const float scale = 1.0f / decimationFactor;
+
+    for (int c = 0; c < numChannels; c++)
+    {
+        newest[c] = accumulator[c] * scale;
+        newestCopy[c] = newest[c];
+        accumulator[c] = 0.0f;
+    }
+
+    // the window of the last historyLength samples is contiguous and ends at newestCopy
+    const float* centre = newestCopy - halfLength * numChannels;
+
+    for (int c = 0; c < numChannels; c++)
+    {
+        realPart[c] = centreCoefficient * centre[c];
+        imagPart[c] = 0.0f;
+    }
+
+    for (int k = 1; k <= halfLength; k++)
+    {
+        const float* older = centre - k * numChannels;
+        const float* newer = centre + k * numChannels;
+        const float g = realCoefficients[k];
+        const float h = imagCoefficients[k];
+
+        for (int c = 0; c < numChannels; c++)
+        {
+            realPart[c] += g * (older[c] + newer[c]);
+            imagPart[c] += h * (older[c] - newer[c]);
+        }
+    }
+
+    for (int c = 0; c < numChannels; c++)
+    {
+        const float newPhase = std::atan2 (imagPart[c], realPart[c]);
+        const float step = wrapPhase (newPhase - phase[c]) / decimationFactor;
+
+        omega[c] += OMEGA_SMOOTHING * (jlimit (minOmega, maxOmega, step) - omega[c]);
+        phase[c] = newPhase;
+    }
+
+    writeIndex = (writeIndex + 1) % historyLength;
+    samplesSinceUpdate = 0;
+}
+
+void PhaseEstimator::process (const float* const* input, int numSamples, float* const* phaseOut)
+{
+    if (numChannels == 0)
+        return;
+
+    const float offset = delaySamples + leadSamples;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        for (int c = 0; c < numChannels; c++)
+            accumulator[c] += input[c][i];
+
+        if (++samplesInAccumulator == decimationFactor)
+        {
+            updateAnalyticSignal();
+            samplesInAccumulator = 0;
+        }
+        else
+        {
+            samplesSinceUpdate++;
+        }
+
+        for (int c = 0; c < numChannels; c++)
+            phaseOut[c][i] = wrapPhase (phase[c] + omega[c] * (offset + samplesSinceUpdate));
+    }
+
+    samplesSeen += numSamples;
+}
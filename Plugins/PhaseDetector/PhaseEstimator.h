@@ -0,0 +1,129 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PHASEESTIMATOR_H_3C7A91D2__
+#define __PHASEESTIMATOR_H_3C7A91D2__
+
+#include <ProcessorHeaders.h>
+
+/**
+    Causal, band-limited estimate of the instantaneous phase
+    of one or more continuous channels.
+
+    The input is first averaged down to a rate of roughly eight
+    times the upper band edge. A pair of short windowed FIR filters
+    (a band-pass and its Hilbert transform) then produces the analytic
+    signal of each channel, delayed by the filter's group delay. Between
+    filter updates, and to cancel that delay plus a user-defined lead,
+    the phase is extrapolated using a running estimate of the
+    instantaneous frequency, so a phase value is available for every
+    input sample.
+
+    Channel histories are stored interleaved, so that every tap
+    is applied to all channels in one contiguous inner loop.
+
+    @see PhaseDetector
+*/
+class PhaseEstimator
+{
+public:
+    /** Constructor */
+    PhaseEstimator();
+
+    /** Destructor */
+    ~PhaseEstimator() { }
+
+    /** Designs the filters for a given band and allocates the channel histories.
+        Must not be called while process() is running.*/
+    void prepare (int numChannels, float sampleRate, float lowCut, float highCut);
+
+    /** Sets the amount of time (in ms) by which the output should be advanced,
+        in addition to the filter's own group delay*/
+    void setLead (float leadMs);
+
+    /** Clears the channel histories*/
+    void reset();
+
+    /** Computes the predicted phase (in radians, -pi to pi) of every channel
+        for every sample. input[c] and phaseOut[c] point to numSamples values.*/
+    void process (const float* const* input, int numSamples, float* const* phaseOut);
+
+    /** Returns the number of channels tracked by this estimator*/
+    int getNumChannels() const { return numChannels; }
+
+    /** Returns the delay compensated by extrapolation, in input samples*/
+    float getDelay() const { return delaySamples; }
+
+    /** Returns true once enough samples have arrived to fill the filter*/
+    bool isPrimed() const { return samplesSeen >= (int64) historyLength * decimationFactor; }
+
+private:
+
+    /** Pushes one decimated sample per channel and updates the phase estimates*/
+    void updateAnalyticSignal();
+
+    /** Number of taps on either side of the centre tap*/
+    int halfLength;
+
+    /** Total filter length (2 * halfLength + 1)*/
+    int historyLength;
+
+    /** Number of input samples averaged into each filter input*/
+    int decimationFactor;
+
+    int numChannels;
+    int writeIndex;
+    int samplesInAccumulator;
+    int samplesSinceUpdate;
+    int64 samplesSeen;
+
+    float sampleRate;
+    float leadMs;
+    float minOmega;
+    float maxOmega;
+    float leadSamples;
+
+    /** Delay between the latest input sample and the centre tap, in input samples*/
+    float delaySamples;
+
+    /** Band-pass (real part) coefficients for taps 1..halfLength, plus the centre tap*/
+    HeapBlock<float> realCoefficients;
+    float centreCoefficient;
+
+    /** Hilbert (imaginary part) coefficients for taps 1..halfLength*/
+    HeapBlock<float> imagCoefficients;
+
+    /** Interleaved channel history, written twice so that any window is contiguous*/
+    HeapBlock<float> history;
+
+    /** Per-channel scratch and state*/
+    HeapBlock<float> accumulator;
+    HeapBlock<float> realPart;
+    HeapBlock<float> imagPart;
+    HeapBlock<float> phase;
+    HeapBlock<float> omega;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PhaseEstimator);
+};
+
+#endif  // __PHASEESTIMATOR_H_3C7A91D2__
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""
+Measures how many parameter updates per second the Open Ephys HTTP server
+accepts, one PUT per parameter versus the batched /api/parameters endpoint.
+
+Usage:
+    http_parameter_benchmark.py <processor_id> <parameter> <value> [--stream N]
+                                [--count N] [--host H] [--port P] [--msgpack]
+
+The same parameter is set <count> times, which exercises the same path as
+setting <count> different parameters. MessagePack encoding requires the
+"msgpack" Python package.
+"""
+
+import argparse
+import http.client
+import json
+import time
+
+
+def put(connection, path, body, content_type):
+    connection.request("PUT", path, body=body, headers={"Content-Type": content_type})
+    response = connection.getresponse()
+    data = response.read()
+
+    if response.status != 200:
+        raise RuntimeError("%s returned %d: %s" % (path, response.status, data[:200]))
+
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("processor", type=int)
+    parser.add_argument("parameter")
+    parser.add_argument("value", type=json.loads)
+    parser.add_argument("--stream", type=int, default=None)
+    parser.add_argument("--count", type=int, default=384)
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=37497)
+    parser.add_argument("--msgpack", action="store_true")
+    args = parser.parse_args()
+
+    # a single keep-alive connection for all requests
+    connection = http.client.HTTPConnection(args.host, args.port)
+
+    if args.stream is None:
+        path = "/api/processors/%d/parameters/%s" % (args.processor, args.parameter)
+    else:
+        path = "/api/processors/%d/streams/%d/parameters/%s" % (args.processor, args.stream, args.parameter)
+
+    start = time.perf_counter()
+    for _ in range(args.count):
+        put(connection, path, json.dumps({"value": args.value}), "application/json")
+    single = time.perf_counter() - start
+
+    update = {"processor": args.processor, "parameter": args.parameter, "value": args.value}
+    if args.stream is not None:
+        update["stream"] = args.stream
+
+    request = {"updates": [update] * args.count}
+
+    start = time.perf_counter()
+    if args.msgpack:
+        import msgpack
+        reply = msgpack.unpackb(put(connection, "/api/parameters", msgpack.packb(request), "application/msgpack"))
+    else:
+        reply = json.loads(put(connection, "/api/parameters", json.dumps(request), "application/json"))
+    batched = time.perf_counter() - start
+
+    print("one request per update: %8.0f updates/s" % (args.count / single))
+    print("batched:                %8.0f updates/s (%d us applying on the message thread)"
+          % (args.count / batched, reply["elapsed_us"]))
+
+
+if __name__ == "__main__":
+    main()
@@ -25,12 +25,14 @@
 #include "AudioComponent.h"
 #include "../AccessClass.h"
 #include "../Processors/ProcessorGraph/ProcessorGraph.h"
+#include "../Processors/RecordNode/RecordNode.h"
+#include "../CoreServices.h"
 #include <stdio.h>
 
 
 #include "../Utils/Utils.h"
 
-AudioComponent::AudioComponent() : isPlaying(false)
+AudioComponent::AudioComponent() : Thread("Free-running graph driver"), isPlaying(false)
 {
     bool initialized = false;
     while (!initialized)
@@ -198,6 +200,17 @@ void AudioComponent::stopDevice()
 bool AudioComponent::beginCallbacks()
 {
 
+    if (!isPlaying && CoreServices::isFreeRunning())
+    {
+        LOGC("Starting free-running graph driver.");
+        isPlaying = true;
+
+        // start once the current message has been handled, i.e. after the graph has started acquisition
+        MessageManager::callAsync([this] { if (isPlaying) startThread(); });
+
+        return true;
+    }
+
     if (!isPlaying)
     {
 
@@ -227,11 +240,84 @@ bool AudioComponent::beginCallbacks()
 
 void AudioComponent::endCallbacks()
 {
+    if (CoreServices::isFreeRunning())
+    {
+        LOGC("Stopping free-running graph driver.");
+        isPlaying = false;
+        stopThread(2000);
+        return;
+    }
+
     LOGC("Removing audio callback.");
     deviceManager.removeAudioCallback(graphPlayer.get());
     isPlaying = false;
 }
 
+void AudioComponent::run()
+{
+    AudioProcessor* graph = graphPlayer->getCurrentProcessor();
+
+    if (graph == nullptr)
+        return;
+
+    AudioDeviceManager::AudioDeviceSetup setup;
+    deviceManager.getAudioDeviceSetup(setup);
+
+    const double sampleRate = setup.sampleRate > 0 ? setup.sampleRate : 44100.0;
+    const int blockSize = setup.bufferSize > 0 ? setup.bufferSize : 1024;
+
+    graph->setRateAndBufferSizeDetails(sampleRate, blockSize);
+    graph->prepareToPlay(sampleRate, blockSize);
+
+    AudioBuffer<float> buffer(jmax(1, graph->getTotalNumInputChannels(), graph->getTotalNumOutputChannels()), blockSize);
+    MidiBuffer midiMessages;
+
+    // the signal chain can't change during acquisition
+    const Array<RecordNode*> recordNodes = AccessClass::getProcessorGraph()->getRecordNodes();
+
+    auto recordBuffersAreFilling = [&recordNodes]
+    {
+        for (auto node : recordNodes)
+        {
+            if (node->getRecordBufferUsage() > 0.5f)
+                return true;
+        }
+
+        return false;
+    };
+
+    int64 numBlocks = 0;
+    int64 numWaits = 0;
+    const int64 startTime = Time::getHighResolutionTicks();
+
+    while (!threadShouldExit())
+    {
+        // running faster than the Record Nodes can write to disk would overflow their buffers,
+        // so wait for them to catch up instead
+        if (recordBuffersAreFilling())
+        {
+            numWaits++;
+            wait(2);
+            continue;
+        }
+
+        buffer.clear();
+        midiMessages.clear();
+
+        const ScopedLock sl(graph->getCallbackLock());
+        graph->processBlock(buffer, midiMessages);
+
+        numBlocks++;
+    }
+
+    const double seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTime);
+
+    if (seconds > 0)
+        LOGC("Free-running: ", numBlocks, " blocks in ", seconds, " s (", numBlocks * blockSize / sampleRate / seconds, "x real time, ", numWaits, " waits for Record Nodes)");
+
+    graph->releaseResources();
+}
+
 void AudioComponent::saveStateToXml(XmlElement* parent)
 {
     // JUCE's audioState XML format (includes all info)
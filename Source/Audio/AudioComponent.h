@@ -38,11 +38,15 @@
   Determines the initial size of the sample buffer (crucial for
   real-time feedback latency).
 
+  When the GUI is free-running, the ProcessorGraph is instead driven
+  by a background thread, one block after another, with the block
+  size and sample rate of the current audio device settings.
+
   @see MainWindow, ProcessorGraph
 
 */
 
-class AudioComponent
+class AudioComponent : private Thread
 {
 
 public:
@@ -97,6 +101,9 @@ public:
 
 private:
 
+    /** Runs the graph as fast as possible (free-running mode only) */
+    void run() override;
+
     bool isPlaying;
 
     std::unique_ptr<AudioProcessorPlayer> graphPlayer;
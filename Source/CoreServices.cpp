@@ -45,13 +45,18 @@ namespace CoreServices
 
 	void saveRecoveryConfig()
 	{
+		// headless instances leave the interactive session's recovery file alone
+		if (isHeadless())
+			return;
+
 		File configsDir = getSavedStateDirectory();
 		if (!configsDir.getFullPathName().contains("plugin-GUI" + File::getSeparatorString() + "Build"))
 			configsDir = configsDir.getChildFile("configs-api" + String(PLUGIN_API_VER));
 
+		// Settings changes often come in bursts, so the file is written once they settle
 		EditorViewport* ev = getEditorViewport();
 		File recoveryFile = configsDir.getChildFile("recoveryConfig.xml");
-		ev->saveState(recoveryFile);
+		ev->saveStateInBackground(recoveryFile);
 	}
 
 	void loadSignalChain(String path)
@@ -416,6 +421,30 @@ namespace CoreServices
 		return STR_DEF(JUCE_APP_VERSION);
 	}
 
+	static bool headlessMode = false;
+
+	bool isHeadless()
+	{
+		return headlessMode;
+	}
+
+	void setHeadless(bool headless)
+	{
+		headlessMode = headless;
+	}
+
+	static bool freeRunningMode = false;
+
+	bool isFreeRunning()
+	{
+		return freeRunningMode;
+	}
+
+	void setFreeRunning(bool freeRunning)
+	{
+		freeRunningMode = freeRunning;
+	}
+
 
 	namespace PluginInstaller
 	{
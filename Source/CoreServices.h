@@ -44,7 +44,8 @@ namespace CoreServices
 */
 PLUGIN_API void updateSignalChain(GenericEditor* source);
 
-/** Saves the recoveryConfig.xml settings file*/
+/** Saves the recoveryConfig.xml settings file. The file is written on a background
+    thread about a second after the last call, so repeated calls are cheap.*/
 PLUGIN_API void saveRecoveryConfig();
 
 /** Loads signal chain from a given path*/
@@ -207,6 +208,21 @@ PLUGIN_API File getSavedStateDirectory();
 /** Gets the GUI version */
 PLUGIN_API String getGUIVersion();
 
+/** Returns true if the GUI was started with --headless: processors run, but no
+    windows are shown and no visualizer canvases are created */
+PLUGIN_API bool isHeadless();
+
+/** Sets the headless state (called once at startup, before the signal chain is loaded) */
+void setHeadless(bool headless);
+
+/** Returns true if the GUI was started with --free-run: the signal chain is driven as
+    fast as it will run instead of by the audio device, and File Reader sources stop at
+    the end of the file (used to reprocess recordings offline) */
+PLUGIN_API bool isFreeRunning();
+
+/** Sets the free-running state (called once at startup) */
+void setFreeRunning(bool freeRunning);
+
 
 namespace PluginInstaller
 {
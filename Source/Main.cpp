@@ -60,9 +60,33 @@ public:
         parameters.addTokens(commandLine, " ", "\"");
         parameters.removeEmptyStrings();
 
+        // --headless runs the signal chain without any windows (controlled through the HTTP server)
+        const bool headless = parameters.contains("--headless");
+        parameters.removeString("--headless");
+
+        // --free-run processes data as fast as possible instead of at the audio device's pace
+        const bool freeRunning = parameters.contains("--free-run");
+        parameters.removeString("--free-run");
+
+        // --port <number> moves the HTTP server, so that several instances can run side by side
+        int httpServerPort = PORT;
+        const int portIndex = parameters.indexOf("--port");
+
+        if (portIndex >= 0)
+        {
+            httpServerPort = parameters[portIndex + 1].getIntValue();
+            parameters.removeRange(portIndex, 2);
+
+            if (httpServerPort <= 0)
+                httpServerPort = PORT;
+        }
+
+        CoreServices::setHeadless(headless);
+        CoreServices::setFreeRunning(freeRunning);
+
 #ifdef _WIN32
 
-        if (AllocConsole())
+        if (!headless && AllocConsole())
         {
             freopen("CONOUT$", "w", stdout);
             freopen("CONOUT$", "w", stderr);
@@ -88,11 +112,11 @@ public:
         if (!parameters.isEmpty())
         {
             File fileToLoad(File::getCurrentWorkingDirectory().getChildFile(parameters[0]));
-            mainWindow = std::make_unique<MainWindow>(fileToLoad);
+            mainWindow = std::make_unique<MainWindow>(fileToLoad, httpServerPort);
         }
         else
         {
-            mainWindow = std::make_unique<MainWindow>();
+            mainWindow = std::make_unique<MainWindow>(File(), httpServerPort);
         }
     }
 
@@ -107,6 +131,14 @@ public:
     {
         bool shouldQuit = true;
 
+        // there is no one to ask: stop acquisition (and recording) and quit
+        if (CoreServices::isHeadless())
+        {
+            mainWindow->shutDownGUI();
+            quit();
+            return;
+        }
+
         if (CoreServices::getAcquisitionStatus())
         {
             
@@ -29,7 +29,7 @@
 #include <stdio.h>
 
 
-MainWindow::MainWindow(const File& fileToLoad)
+MainWindow::MainWindow(const File& fileToLoad, int httpServerPort)
 : DocumentWindow(JUCEApplication::getInstance()->getApplicationName(),
 		Colour(Colours::black),
 		DocumentWindow::allButtons)
@@ -54,6 +54,9 @@ MainWindow::MainWindow(const File& fileToLoad)
 	LOGC("Operating System: ", SystemStats::getOperatingSystemName());
 	LOGC("CPU: ", SystemStats::getCpuModel(), " (", SystemStats::getNumCpus(), " core)");
 
+	if (CoreServices::isHeadless())
+		LOGC("Running headless");
+
 	setResizable(true,      // isResizable
 			false);   // useBottomCornerRisizer -- doesn't work very well
 
@@ -86,6 +89,28 @@ MainWindow::MainWindow(const File& fileToLoad)
 
 	addKeyListener(commandManager.getKeyMappings());
 
+	if (CoreServices::isHeadless())
+	{
+		// load the requested signal chain (or the last one), without asking
+		File configToLoad = fileToLoad.getFullPathName().isEmpty() ? configsDir.getChildFile("lastConfig.xml")
+																	: fileToLoad;
+
+		if (configToLoad.existsAsFile())
+		{
+			LOGC("Loading signal chain from ", configToLoad.getFullPathName());
+			ui->getEditorViewport()->loadState(configToLoad);
+		}
+		else
+		{
+			LOGC("Signal chain ", configToLoad.getFullPathName(), " not found; starting with an empty signal chain");
+		}
+
+		http_server_thread = std::make_unique<OpenEphysHttpServer>(processorGraph.get(), httpServerPort);
+		enableHttpServer();
+
+		return;
+	}
+
 	LOGD("Loading window bounds.");
 	loadWindowBounds();
 	setUsingNativeTitleBar(true);
@@ -153,7 +178,7 @@ MainWindow::MainWindow(const File& fileToLoad)
 		}
 	}
 
-	http_server_thread = std::make_unique<OpenEphysHttpServer>(processorGraph.get());
+	http_server_thread = std::make_unique<OpenEphysHttpServer>(processorGraph.get(), httpServerPort);
 
 	if (shouldEnableHttpServer) {
 		enableHttpServer();
@@ -176,17 +201,21 @@ MainWindow::~MainWindow()
 		audioComponent->endCallbacks();
 		processorGraph->stopAcquisition();
 	}
-    
-	saveWindowBounds();
 
 	audioComponent->disconnectProcessorGraph();
 	UIComponent* ui = (UIComponent*) getContentComponent();
 	ui->disableDataViewport();
-	
-	File lastConfig = configsDir.getChildFile("lastConfig.xml");
-	File recoveryConfig = configsDir.getChildFile("recoveryConfig.xml");
-	ui->getEditorViewport()->saveState(lastConfig);
-	ui->getEditorViewport()->saveState(recoveryConfig);
+
+	// headless instances leave the interactive session's settings alone
+	if (!CoreServices::isHeadless())
+	{
+		saveWindowBounds();
+
+		File lastConfig = configsDir.getChildFile("lastConfig.xml");
+		File recoveryConfig = configsDir.getChildFile("recoveryConfig.xml");
+		ui->getEditorViewport()->saveState(lastConfig);
+		ui->getEditorViewport()->saveState(recoveryConfig);
+	}
 
 	//TODO: Possibly send some message inidicating everything has been saved successfully
 	if (http_server_thread) {
@@ -252,6 +281,13 @@ void MainWindow::handleCrash(void* input)
 
 	String recoveryFileLocation = crashLogDir.getChildFile("recoveryConfig.xml").getFullPathName();
 
+	if (CoreServices::isHeadless())
+	{
+		std::cerr << "Open Ephys has stopped working. Recovery config: " << recoveryFileLocation
+				  << ", activity log: " << crashLog.getFullPathName() << std::endl;
+		return;
+	}
+
 	AlertWindow::showMessageBox(AlertWindow::NoIcon,
 		"Open Ephys has stopped working",
 		"To help fix the problem, please email the following files to support@open-ephys.org: \n\n"
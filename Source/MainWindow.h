@@ -48,8 +48,12 @@ class MainWindow   : public DocumentWindow
 public:
 
     /** Initializes the MainWindow, creates the AudioComponent, ProcessorGraph,
-        and UIComponent, and sets the window boundaries. */
-    MainWindow(const File& fileToLoad = File());
+        and UIComponent, and sets the window boundaries.
+
+        When the GUI is headless, the window is never put on the desktop, no
+        dialogs are shown, and the HTTP server (on httpServerPort) is always
+        enabled so that acquisition and recording can be controlled remotely. */
+    MainWindow(const File& fileToLoad = File(), int httpServerPort = PORT);
 
     /** Destroys the AudioComponent, ProcessorGraph, and UIComponent, and saves the window boundaries. */
     ~MainWindow();
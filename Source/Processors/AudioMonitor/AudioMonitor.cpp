@@ -29,10 +29,10 @@
 AudioMonitor::AudioMonitor()
     : GenericProcessor ("Audio Monitor"),
       destBufferSampleRate(44100.0f),
-      estimatedSamples(1024)
+      estimatedSamples(1024),
+      selectedStream(0),
+      resamplerStream(0)
 {
-
-    tempBuffer = std::make_unique<AudioSampleBuffer>();
     
     addBooleanParameter(Parameter::GLOBAL_SCOPE,
                         String("mute_audio"),
@@ -48,19 +48,13 @@ AudioMonitor::AudioMonitor()
     addSelectedChannelsParameter(Parameter::STREAM_SCOPE,
                                  String("Channels"),
                                  "Channels to monitor",
-                                 4);
+                                 MAX_CHANNELS);
 
-    for (int i = 0; i < MAX_CHANNELS; i++)
-    {
-        
-        bandpassfilters.add (new Dsp::SmoothedFilterDesign
-                         <Dsp::Butterworth::Design::BandPass    // design type
-                         <2>,                                   // order
-                         1,                                     // number of channels (must be const)
-                         Dsp::DirectFormII> (1));               // realization
-        
-        antialiasingfilters.add (new Dsp::SmoothedFilterDesign<Dsp::RBJ::Design::LowPass, 1> (1024));
-    }
+    bandpassFilter = std::make_unique<Dsp::SmoothedFilterDesign
+                        <Dsp::Butterworth::Design::BandPass    // design type
+                        <2>,                                   // order
+                        1,                                     // number of channels (must be const)
+                        Dsp::DirectFormII>> (1);               // realization
 
 }
 
@@ -86,10 +80,7 @@ void AudioMonitor::updateSettings()
         {
             selectedStream = stream->getStreamId();
             
-            for (int i = 0; i < activeChannels->size(); i++)
-            {
-                updateFilter(i, selectedStream);
-            }
+            updateFilter(selectedStream);
         }
     }
 }
@@ -114,51 +105,12 @@ void AudioMonitor::prepareToPlay(double sampleRate_, int estimatedSamplesPerBloc
 
 	destBufferSampleRate = sampleRate_;
     estimatedSamples = estimatedSamplesPerBlock;
-    recreateBuffers();
-
-}
-
-
-void AudioMonitor::recreateBuffers()
-{
-	numSamplesExpected.clear();
-    sourceBufferSampleRate.clear();
-    
-    ratio.clear();
-    
-    for (int i = 0; i < getNumInputs(); i++)
-    {
-        numSamplesExpected.emplace(i,
-                                   continuousChannels[i]->getSampleRate()
-                                   / destBufferSampleRate
-                                   * estimatedSamples);
-        
-        sourceBufferSampleRate.emplace(i, continuousChannels[i]->getSampleRate());
-        
-        ratio.emplace(i, sourceBufferSampleRate[i]/destBufferSampleRate);
-        
-    }
-
-    samplesInBackupBuffer.clear();
-    samplesInOverflowBuffer.clear();
-    
-    bufferA.clear();
-    bufferB.clear();
-    bufferSwap.clear();
-    
-    for (int i = 0; i < MAX_CHANNELS; i++)
-    {
 
-        samplesInBackupBuffer.emplace(i, 0.0f);
-        samplesInOverflowBuffer.emplace(i, 0.0f);
+    mixBuffer.setSize(1, estimatedSamples);
 
-        bufferA.emplace(i, std::make_unique<AudioBuffer<float>>(1,44100));
-        bufferB.emplace(i, std::make_unique<AudioBuffer<float>>(1,44100));
-        bufferSwap.emplace(i, false);
+    // forces the resampler to be reconfigured for the new device settings
+    resampler.setRates(0.0, destBufferSampleRate, estimatedSamples);
 
-    }
-
-    tempBuffer->setSize(1, 4096);
 }
 
 
@@ -181,21 +133,10 @@ void AudioMonitor::parameterValueChanged(Parameter* param)
 
         for (int i = 0; i < activeChannels->size(); i++)
         {
-            
-            int localIndex =(int) activeChannels->getReference(i);
-
-            LOGA("Selected channel ", localIndex);
-
-            auto continuousChannels = getDataStream(selectedStream)->getContinuousChannels();
-
-            if (continuousChannels.size() > localIndex)
-            {
-                int globalIndex = continuousChannels[localIndex]->getGlobalIndex();
-
-                updateFilter(i, selectedStream);
-            }
-
+            LOGA("Selected channel ", (int) activeChannels->getReference(i));
         }
+
+        updateFilter(selectedStream);
         
         // clear monitored channels on all other streams
         //for (auto stream : dataStreams)
@@ -209,7 +150,7 @@ void AudioMonitor::parameterValueChanged(Parameter* param)
 }
 
 
-void AudioMonitor::updateFilter(int i, uint16 streamId)
+void AudioMonitor::updateFilter(uint16 streamId)
 {
 
     Dsp::Params params1;
@@ -218,18 +159,7 @@ void AudioMonitor::updateFilter(int i, uint16 streamId)
     params1[2] = (7000 + 100) / 2;     // center frequency
     params1[3] = 7000 - 100;           // bandwidth
 
-    bandpassfilters[i]->setParams (params1);
-    
-    double cutoffFreq = destBufferSampleRate / 2; // upsample
-
-    double sampleFreq = destBufferSampleRate;  // upsample
-
-    Dsp::Params params2;
-    params2[0] = sampleFreq; // sample rate
-    params2[1] = cutoffFreq; // cutoff frequency
-    params2[2] = 1.25; //Q //
-
-    antialiasingfilters[i]->setParams(params2);
+    bandpassFilter->setParams (params1);
 
 }
 
@@ -276,272 +206,75 @@ void AudioMonitor::handleBroadcastMessage(String msg)
 void AudioMonitor::process (AudioBuffer<float>& buffer)
 {
     
-    int valuesNeeded = buffer.getNumSamples(); // samples needed to fill the complete buffer
+    const int numOutputSamples = buffer.getNumSamples(); // samples needed to fill the complete buffer
     
-    int totalBufferChannels = buffer.getNumChannels();
+    const int leftChannel = buffer.getNumChannels() - 2;
+    const int rightChannel = buffer.getNumChannels() - 1;
 
     // clear the left and right channels (last two channels)
-    buffer.clear(totalBufferChannels - 2, 0, buffer.getNumSamples());
-    buffer.clear(totalBufferChannels - 1, 0, buffer.getNumSamples());
-
-    if (!getParameter("mute_audio")->getValue())
-    {
-
-        for (auto stream : dataStreams)
-        {
-            
-            if (stream->getStreamId() == selectedStream
-                && (*stream)["enable_stream"])
-            {
-                
-                AudioSampleBuffer* overflowBuffer;
-                AudioSampleBuffer* backupBuffer;
-
-                Array<var>* activeChannels = stream->getParameter("Channels")->getValue().getArray();
-
-                for (int i = 0; i < activeChannels->size(); i++)
-                {
-
-                    int localIndex = (int) activeChannels->getReference(i);
-                    
-                    int globalIndex = getDataStream(selectedStream)->getContinuousChannels()[localIndex]->getGlobalIndex();
-                    
-                    tempBuffer->clear();
-
-                    if (!bufferSwap[i])
-                    {
-                        overflowBuffer = bufferA[i].get();
-                        backupBuffer = bufferB[i].get();
-
-                        bufferSwap[i] = true;
-                    }
-                    else
-                    {
-                        overflowBuffer = bufferB[i].get();
-                        backupBuffer = bufferA[i].get();
-
-                        bufferSwap[i] = false;
-                    }
-
-                    backupBuffer->clear();
-
-                    samplesInOverflowBuffer[i] = samplesInBackupBuffer[i]; // size of buffer after last round
-                    samplesInBackupBuffer[i] = 0;
-
-                    double orphanedSamples = 0;
+    buffer.clear(leftChannel, 0, numOutputSamples);
+    buffer.clear(rightChannel, 0, numOutputSamples);
 
-                    // 1. copy overflow buffer
+    if (getParameter("mute_audio")->getValue())
+        return;
 
-                    double samplesToCopyFromOverflowBuffer =
-                        ((samplesInOverflowBuffer[i] <= numSamplesExpected[globalIndex]) ?
-                            samplesInOverflowBuffer[i] :
-                            numSamplesExpected[globalIndex]);
+    DataStream* stream = getDataStream(selectedStream);
 
-                    // LOGD("Number of samples to copy: ", samplesToCopyFromOverflowBuffer);
-                    
-                    //std::cout << "Copying from overflow buffer: " << samplesToCopyFromOverflowBuffer << std::endl;
-
-                    if (samplesToCopyFromOverflowBuffer > 0) // need to re-add samples from backup buffer
-                    {
-
-                        tempBuffer->addFrom(0,    // destination channel
-                            0,                // destination start sample
-                            *overflowBuffer,  // source
-                            0,                // source channel
-                            0,                // source start sample
-                            (int) samplesToCopyFromOverflowBuffer,    // number of samples
-                            1.0f              // gain to apply
-                        );
-
-                        double leftoverSamples = samplesInOverflowBuffer[i] - samplesToCopyFromOverflowBuffer;
-                        
-                        //std::cout << "Copying to backup buffer: " << leftoverSamples << std::endl;
-
-                        if (leftoverSamples > 0) // move remaining samples to the backup buffer
-                        {
-
-                            backupBuffer->addFrom(0, // destination channel
-                                0,                     // destination start sample
-                                *overflowBuffer,       // source
-                                0,                     // source channel
-                                (int) samplesToCopyFromOverflowBuffer,         // source start sample
-                                (int) leftoverSamples,       // number of samples
-                                1.0f                   // gain to apply
-                            );
-                        }
-
-                        samplesInBackupBuffer[i] = leftoverSamples;
-                    }
-                    
-                    double remainingSamples = double(numSamplesExpected[globalIndex]) - samplesToCopyFromOverflowBuffer;
-
-                    double samplesAvailable = double(getNumSamplesInBlock(selectedStream));
-                    
-                    //std::cout << "Remaining samples: " << remainingSamples << std::endl;
-                    //std::cout << "Samples available: " << samplesAvailable << std::endl;
+    if (stream == nullptr || !(*stream)["enable_stream"])
+        return;
 
-                    double samplesToCopyFromIncomingBuffer = ((remainingSamples <= samplesAvailable) ?
-                        remainingSamples :
-                        samplesAvailable);
-                    
-                    //std::cout << "Copying from incoming buffer: " << samplesToCopyFromIncomingBuffer << std::endl;
+    if (resamplerStream != selectedStream
+        || resampler.getSourceRate() != stream->getSampleRate())
+    {
+        resampler.setRates(stream->getSampleRate(), destBufferSampleRate, numOutputSamples);
+        resamplerStream = selectedStream;
+    }
 
-                    if (samplesToCopyFromIncomingBuffer > 0)
-                    {
+    const int numSamples = getNumSamplesInBlock(selectedStream);
 
-                        tempBuffer->addFrom(0,                  // destination channel
-                            (int) samplesToCopyFromOverflowBuffer,    // destination start sample
-                            buffer,                             // source
-                            globalIndex,                        // source channel
-                            0,                                  // source start sample
-                            (int) samplesToCopyFromIncomingBuffer,    //  number of samples
-                            1.0f                                // gain to apply
-                        );
+    if (numSamples > 0)
+    {
+        if (numSamples > mixBuffer.getNumSamples())
+            mixBuffer.setSize(1, numSamples, false, false, true);
 
-                    }
+        float* mix = mixBuffer.getWritePointer(0);
 
-                    orphanedSamples = samplesAvailable - samplesToCopyFromIncomingBuffer;
-                    
-                    //std::cout << "Orphaned samples: " << orphanedSamples << std::endl;
+        FloatVectorOperations::clear(mix, numSamples);
 
-                    if (orphanedSamples > 0 && (samplesInBackupBuffer[i] + orphanedSamples < backupBuffer->getNumSamples()))
-                    {
+        // mix the selected channels at the stream's rate; since the bandpass filter and
+        // the resampler are linear, they only need to run once, on the mix
+        Array<var>* activeChannels = stream->getParameter("Channels")->getValue().getArray();
 
-                        backupBuffer->addFrom(0,          // destination channel
-                            samplesInBackupBuffer[i],     // destination start sample
-                            buffer,                       // source
-                            globalIndex,                  // source channel
-                            (int) remainingSamples,             // source start sample
-                            (int) orphanedSamples,              //  number of samples
-                            1.0f                          // gain to apply
-                        );
+        const int numActiveChannels = jmin(activeChannels->size(), MAX_CHANNELS);
 
-                        samplesInBackupBuffer[i] = samplesInBackupBuffer[i] + orphanedSamples;
+        for (int i = 0; i < numActiveChannels; i++)
+        {
+            int localIndex = (int) activeChannels->getReference(i);
 
-                    }
-                    
-                    //std::cout << "Total copied: " << samplesToCopyFromOverflowBuffer + samplesToCopyFromIncomingBuffer << std::endl;
+            if (localIndex < 0 || localIndex >= stream->getContinuousChannels().size())
+                continue;
 
-                    // now that our tempBuffer is ready, we can filter it and copy it into the
-                    // original buffer
-                    float* ptr = tempBuffer->getWritePointer(0);
-                    
-                    int totalCopied = int(samplesToCopyFromOverflowBuffer + samplesToCopyFromIncomingBuffer);
-                    
-                    if (totalCopied == 0)
-                        continue;
-                    
-                    bandpassfilters[i]->process(totalCopied, &ptr);
-                    
-                    /*if (i == 0)
-                    {
-                        std::cout << "np.array([";
-                        for (int j = 0; j < totalCopied; j++)
-                        {
-                            std::cout << *(tempBuffer->getReadPointer(0, j)) << ", ";
-                        }
-                        
-                        std::cout << "])";
-                        std::cout << std::endl;
-                        std::cout << "------------- " << std::endl;
-                    }*/
-
-                    // initialize variables
-                    int sourceBufferPos = 0;
-                    int sourceBufferSize = totalCopied;
-                    double subSampleOffset = 0.0;
-                    int nextPos = (sourceBufferPos + 1) % sourceBufferSize;
-
-                    double destBufferPos;
-                    int targetChannel;
-                    
-                    //std::cout << "Ratio: " << ratio[globalIndex] << std::endl;
+            int globalIndex = stream->getContinuousChannels()[localIndex]->getGlobalIndex();
 
-                    if (int(getParameter("audio_output")->getValue()) == 0 || int(getParameter("audio_output")->getValue()) == 1)
-                        targetChannel = totalBufferChannels - 2;
-                    else
-                        targetChannel = totalBufferChannels - 1;
+            FloatVectorOperations::add(mix, buffer.getReadPointer(globalIndex), numSamples);
+        }
 
-                    // code modified from "juce_ResamplingAudioSource.cpp":
-                    for (destBufferPos = 0; destBufferPos < valuesNeeded; destBufferPos++)
-                    {
-                        float alpha = (float) subSampleOffset;
-                        float invAlpha = 1.0f - alpha;
-
-                        buffer.addFrom(targetChannel,    // destChannel
-                            destBufferPos,               // destSampleOffset
-                            *tempBuffer,                 // source
-                            0,                           // sourceChannel
-                            sourceBufferPos,             // sourceSampleOffset
-                            1,                           // number of samples
-                            invAlpha);                   // gain to apply to source
-                        
-                        buffer.addFrom(targetChannel,    // destChannel
-                            destBufferPos,               // destSampleOffset
-                            *tempBuffer,                 // source
-                            0,                           // sourceChannel
-                            nextPos,                     // sourceSampleOffset
-                            1,                           // number of samples
-                            alpha);                      // gain to apply to source
-
-                        subSampleOffset += ratio[globalIndex];
-                        
-                        while (subSampleOffset >= 1.0)
-                        {
-                            //if (++sourceBufferPos >= sourceBufferSize)
-                            //    sourceBufferPos = 0;
+        bandpassFilter->process(numSamples, &mix);
 
-                            ++sourceBufferPos;
-                            nextPos = (sourceBufferPos + 1); //% sourceBufferSize;
-                            
-                            if (nextPos >= sourceBufferSize)
-                                nextPos = sourceBufferPos;
-                            
-                            subSampleOffset -= 1.0;
-                        }
-                    }
-                    
-                    //std::cout << "Source buffer pos: " << sourceBufferPos << std::endl;
-                    
-                    //std::cout << "After upsampling: " << valuesNeeded << std::endl;
-                    
-                    //std::cout << std::endl;
+        resampler.pushSamples(mix, numSamples);
+    }
 
-                    //ptr = buffer.getWritePointer(targetChannel);
-                    //antialiasingfilters[i]->process(destBufferPos, &ptr);
-                    
-                    /*if (i == 0)
-                    {
-                        std::cout << "np.array([";
-                        for (int j = 0; j < valuesNeeded; j++)
-                        {
-                            std::cout << *(buffer.getReadPointer(targetChannel, j)) << ", ";
-                        }
-                        
-                        std::cout << "])";
-                        std::cout << std::endl;
-                        std::cout << "------------- " << std::endl;
-                    }*/
-                    
-                } // end cycling through channels
+    // always produce a full block at the device rate, even if no new samples arrived
+    const int audioOutput = int(getParameter("audio_output")->getValue());
 
-                if (int(getParameter("audio_output")->getValue()) == 1)
-                {
-                    // copy the signal into the right channel
-                    buffer.addFrom(totalBufferChannels - 1,    // destChannel
-                        0,                                     // destSampleOffset
-                        buffer,                                // source
-                        totalBufferChannels - 2,               // sourceChannel
-                        0,                                     // sourceSampleOffset
-                        valuesNeeded,                          // number of samples
-                        1.0);                                  // gain to apply to source
+    const int targetChannel = (audioOutput == 2) ? rightChannel : leftChannel;
 
-                }
-                
-            } // stream is selected
-        
-        } // loop through streams
+    resampler.process(buffer.getWritePointer(targetChannel), numOutputSamples);
 
-    } // not muted
+    if (audioOutput == 1)
+    {
+        // copy the signal into the right channel
+        buffer.copyFrom(rightChannel, 0, buffer, leftChannel, 0, numOutputSamples);
+    }
 
 } // process
@@ -31,7 +31,9 @@
 #include "../GenericProcessor/GenericProcessor.h"
 #include "../Dsp/Dsp.h"
 
-#define MAX_CHANNELS 4
+#include "AudioResampler.h"
+
+#define MAX_CHANNELS 16
 
 /**
   Reads data from a file.
@@ -48,7 +50,7 @@ public:
     /** Destructor*/
     ~AudioMonitor() { }
 
-    /** Re-samples, filters, and copies selected channels*/
+    /** Mixes, filters, and re-samples the selected channels*/
     void process (AudioBuffer<float>& buffer) override;
     
     /** Creates the custom UI for the AudioMonitor*/
@@ -60,7 +62,7 @@ public:
     /** Updates the audio buffer size*/
 	void updatePlaybackBuffer();
 
-    /** Updates the resampling ratio for each channel*/
+    /** Updates the output sample rate and block size of the resampler*/
     void prepareToPlay(double sampleRate_, int estimatedSamplesPerBlock) override;
     
     /** Called whenever a parameter's value is changed (called by GenericProcessor::setParameter())*/
@@ -70,43 +72,31 @@ public:
     void resetConnections() override;
 
     /** Updates the bandpass filter parameters, given the currently monitored stream*/
-    void updateFilter(int i, uint16 streamId);
+    void updateFilter(uint16 streamId);
     
     /** Allows other processors to configure the Audio Monitor during acquisition*/
     void handleBroadcastMessage(String message) override;
 
 private:
     
-    /** Re-sets the copy buffers prior to acquisition*/
-    void recreateBuffers();
-    
-    std::map<int, std::unique_ptr<AudioBuffer<float>>> bufferA;
-    std::map<int, std::unique_ptr<AudioBuffer<float>>> bufferB;
-
-    /** Per-channel buffer state information*/
-    std::map<int, double> samplesInBackupBuffer;
-    std::map<int, double> samplesInOverflowBuffer;
-    std::map<int, double> sourceBufferSampleRate;
-    std::map<int, bool> bufferSwap;
-    
-    std::map<int, double> numSamplesExpected;
-    std::map<int, double> ratio;
-    
     double destBufferSampleRate;
-    double estimatedSamples;
+    int estimatedSamples;
 
-    /** 4 bandpass filters (1 per selected channel)*/
-    OwnedArray<Dsp::Filter> bandpassfilters;
-    
-    /** 4 antialiasing filters (1 per selected channel)*/
-    OwnedArray<Dsp::Filter> antialiasingfilters;
+    /** Bandpass filter, applied once to the mix of all selected channels*/
+    std::unique_ptr<Dsp::Filter> bandpassFilter;
+
+    /** Converts the filtered mix from the stream's rate to the audio device's rate*/
+    AudioResampler resampler;
 
-    /** Holds the data for one channel, before it's copied to the output*/
-    std::unique_ptr<AudioBuffer<float>> tempBuffer;
+    /** Holds the mix of the selected channels, at the stream's sample rate*/
+    AudioBuffer<float> mixBuffer;
     
     /** Only one stream can be monitored at a time*/
     uint16 selectedStream;
 
+    /** Stream for which the resampler was last configured*/
+    uint16 resamplerStream;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioMonitor);
 };
 
@@ -0,0 +1,266 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "AudioResampler.h"
+
+#include <cmath>
+
+namespace
+{
+    /** Passband edge, as a fraction of the lower of the two Nyquist frequencies*/
+    const double PASSBAND = 0.9;
+
+    /** Smoothing applied to the FIFO fill level (per output block)*/
+    const double FILL_SMOOTHING = 0.05;
+
+    /** Proportional and integral gains of the rate tracker*/
+    const double PROPORTIONAL_GAIN = 0.02;
+    const double INTEGRAL_GAIN = 0.00002;
+
+    /** Largest drift correction (clock drift is typically well below 100 ppm)*/
+    const double MAX_DRIFT = 0.001;
+
+    /** Largest total deviation from the nominal ratio*/
+    const double MAX_CORRECTION = 0.005;
+
+    /** Length of the window over which the largest input chunk is remembered (in seconds)*/
+    const double CHUNK_WINDOW = 10.0;
+
+    /** Fill level (relative to the target) above which queued samples are discarded*/
+    const double MAX_FILL_RATIO = 4.0;
+}
+
+AudioResampler::AudioResampler() :
+    sourceRate (0.0),
+    destRate (0.0),
+    nominalRatio (1.0),
+    currentRatio (1.0),
+    readPosition (0.0),
+    samplesWritten (0),
+    targetFill (0.0),
+    smoothedFill (0.0),
+    driftCorrection (0.0),
+    largestChunk (0.0),
+    previousLargestChunk (0.0),
+    blocksInWindow (0),
+    destBlockSize (0),
+    isPriming (true)
+{
+    coefficients.calloc ((numPhases + 1) * numTaps);
+    fifo.calloc (2 * fifoSize);
+}
+
+void AudioResampler::setRates (double sourceRate_, double destRate_, int destBlockSize_)
+{
+    sourceRate = sourceRate_;
+    destRate = destRate_;
+    destBlockSize = jmax (1, destBlockSize_);
+
+    if (sourceRate <= 0.0 || destRate <= 0.0)
+    {
+        nominalRatio = 1.0;
+        reset();
+        return;
+    }
+
+    nominalRatio = sourceRate / destRate;
+
+    // cutoff in cycles per input sample
+    const double cutoff = PASSBAND * 0.5 * jmin (1.0, destRate / sourceRate);
+    const double halfSpan = numTaps / 2;
+
+    for (int p = 0; p <= numPhases; p++)
+    {
+        float* h = coefficients + p * numTaps;
+        const double fraction = double (p) / numPhases;
+
+        double sum = 0.0;
+
+        for (int k = 0; k < numTaps; k++)
+        {
+            // distance between tap k and the interpolated position
+            const double d = k - (halfSpan - 1) - fraction;
+            const double x = MathConstants<double>::pi * 2.0 * cutoff * d;
+            const double sinc = (d == 0.0) ? 1.0 : std::sin (x) / x;
+
+            // Blackman window over the full span
+            const double w = MathConstants<double>::pi * d / halfSpan;
+            const double window = 0.42 + 0.5 * std::cos (w) + 0.08 * std::cos (2.0 * w);
+
+            const double value = (std::abs (d) < halfSpan) ? sinc * window : 0.0;
+
+            h[k] = float (value);
+            sum += value;
+        }
+
+        // unity gain at DC for every phase
+        FloatVectorOperations::multiply (h, float (1.0 / sum), numTaps);
+    }
+
+    reset();
+}
+
+void AudioResampler::reset()
+{
+    FloatVectorOperations::clear (fifo.getData(), 2 * fifoSize);
+
+    readPosition = 0.0;
+    samplesWritten = 0;
+
+    currentRatio = nominalRatio;
+    driftCorrection = 0.0;
+    smoothedFill = 0.0;
+    largestChunk = nominalRatio * destBlockSize;
+    previousLargestChunk = largestChunk;
+    blocksInWindow = 0;
+    targetFill = 2.0 * largestChunk + numTaps / 2;
+
+    isPriming = true;
+}
+
+void AudioResampler::pushSamples (const float* data, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    // only the most recent samples can be kept
+    if (numSamples > fifoSize / 2)
+    {
+        data += numSamples - fifoSize / 2;
+        numSamples = fifoSize / 2;
+    }
+
+    const int start = int (samplesWritten & (fifoSize - 1));
+    const int firstPart = jmin (numSamples, fifoSize - start);
+    const int secondPart = numSamples - firstPart;
+
+    FloatVectorOperations::copy (fifo + start, data, firstPart);
+    FloatVectorOperations::copy (fifo + start + fifoSize, data, firstPart);
+
+    if (secondPart > 0)
+    {
+        FloatVectorOperations::copy (fifo.getData(), data + firstPart, secondPart);
+        FloatVectorOperations::copy (fifo + fifoSize, data + firstPart, secondPart);
+    }
+
+    samplesWritten += numSamples;
+    largestChunk = jmax (largestChunk, double (numSamples));
+}
+
+void AudioResampler::updateRateTracker()
+{
+    const double samplesPerBlock = nominalRatio * destBlockSize;
+
+    // the largest chunk is held for one to two windows, so the target only changes in steps
+    // (a continuously decaying target would bias the drift estimate)
+    if (++blocksInWindow > CHUNK_WINDOW * destRate / destBlockSize)
+    {
+        previousLargestChunk = largestChunk;
+        largestChunk = samplesPerBlock;
+        blocksInWindow = 0;
+    }
+
+    const double chunk = jmax (largestChunk, previousLargestChunk);
+
+    // enough to cover the longest gap between chunks, plus one block and the filter's look-ahead
+    targetFill = chunk + samplesPerBlock + numTaps / 2;
+
+    double fill = getFill();
+
+    // the output side stalled (or the input burst): skip ahead rather than drift back slowly
+    if (fill > MAX_FILL_RATIO * targetFill || fill > fifoSize - 2 * numTaps)
+    {
+        readPosition = double (samplesWritten) - targetFill;
+        fill = targetFill;
+        smoothedFill = targetFill;
+    }
+
+    if (isPriming)
+    {
+        if (fill < targetFill)
+            return;
+
+        isPriming = false;
+        smoothedFill = fill;
+    }
+
+    smoothedFill += FILL_SMOOTHING * (fill - smoothedFill);
+
+    const double error = (smoothedFill - targetFill) / targetFill;
+
+    driftCorrection = jlimit (-MAX_DRIFT, MAX_DRIFT,
+                              driftCorrection + INTEGRAL_GAIN * error);
+
+    const double correction = jlimit (-MAX_CORRECTION, MAX_CORRECTION,
+                                      driftCorrection + PROPORTIONAL_GAIN * error);
+
+    currentRatio = nominalRatio * (1.0 + correction);
+}
+
+void AudioResampler::process (float* output, int numSamples)
+{
+    updateRateTracker();
+
+    if (isPriming)
+    {
+        FloatVectorOperations::clear (output, numSamples);
+        return;
+    }
+
+    const int64 mask = fifoSize - 1;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        const int64 base = int64 (std::floor (readPosition));
+
+        if (base + numTaps / 2 >= samplesWritten)
+        {
+            // FIFO ran dry: wait until it is back at the target level, and leave more margin from now on
+            FloatVectorOperations::clear (output + i, numSamples - i);
+            largestChunk = jmax (largestChunk, previousLargestChunk) + nominalRatio * destBlockSize;
+            isPriming = true;
+            return;
+        }
+
+        const double phasePosition = (readPosition - double (base)) * numPhases;
+        const int phase = jmin (numPhases - 1, int (phasePosition));
+        const float alpha = float (phasePosition - phase);
+
+        const float* x = fifo + ((base - numTaps / 2 + 1) & mask);
+        const float* h0 = coefficients + phase * numTaps;
+        const float* h1 = h0 + numTaps;
+
+        float sum0 = 0.0f;
+        float sum1 = 0.0f;
+
+        for (int k = 0; k < numTaps; k++)
+        {
+            sum0 += h0[k] * x[k];
+            sum1 += h1[k] * x[k];
+        }
+
+        output[i] = sum0 + alpha * (sum1 - sum0);
+
+        readPosition += currentRatio;
+    }
+}
@@ -0,0 +1,126 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __AUDIORESAMPLER_H_5E2B7C14__
+#define __AUDIORESAMPLER_H_5E2B7C14__
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+/**
+    Streaming polyphase resampler that converts a signal arriving at
+    a data stream's native rate into exactly one audio device block
+    per call.
+
+    Incoming samples are queued in a FIFO. Output samples are computed
+    with a windowed-sinc filter bank (linearly interpolated between
+    adjacent phases), so arbitrary and slowly varying ratios are
+    supported without the need for a separate anti-aliasing stage.
+
+    Because the acquisition hardware and the sound card run on
+    different clocks, and data arrives in irregular chunks, the
+    nominal ratio is continuously corrected by a rate tracker that
+    keeps the FIFO near a target fill level. The target follows the
+    largest chunk recently received, so the latency adapts to the
+    source's delivery pattern.
+
+    All memory is allocated in the constructor; setRates() may be
+    called from the audio thread.
+
+    @see AudioMonitor
+*/
+class AudioResampler
+{
+public:
+
+    /** Constructor */
+    AudioResampler();
+
+    /** Destructor */
+    ~AudioResampler() { }
+
+    /** Sets the input and output rates and the size of the output blocks.
+        Designs the filter bank and clears the FIFO.*/
+    void setRates (double sourceRate, double destRate, int destBlockSize);
+
+    /** Clears the FIFO and the rate tracker*/
+    void reset();
+
+    /** Appends samples at the source rate*/
+    void pushSamples (const float* data, int numSamples);
+
+    /** Writes exactly numSamples output samples. If the FIFO runs dry, the rest
+        of the block is silent and output resumes once the FIFO is refilled.*/
+    void process (float* output, int numSamples);
+
+    /** Returns the rate passed to the last call to setRates()*/
+    double getSourceRate() const { return sourceRate; }
+
+    /** Returns the input/output ratio currently applied, including drift correction*/
+    double getCurrentRatio() const { return currentRatio; }
+
+private:
+
+    /** Number of input samples spanned by each phase of the filter*/
+    static const int numTaps = 32;
+
+    /** Number of fractional positions for which coefficients are stored*/
+    static const int numPhases = 128;
+
+    /** Capacity of the FIFO (power of 2)*/
+    static const int fifoSize = 1 << 16;
+
+    /** Returns the number of input samples that are queued beyond the read position*/
+    double getFill() const { return double (samplesWritten) - readPosition; }
+
+    /** Updates the fill target and the drift correction once per output block*/
+    void updateRateTracker();
+
+    double sourceRate;
+    double destRate;
+    double nominalRatio;
+    double currentRatio;
+
+    /** Absolute (fractional) input position of the next output sample*/
+    double readPosition;
+    int64 samplesWritten;
+
+    /** Rate tracker state*/
+    double targetFill;
+    double smoothedFill;
+    double driftCorrection;
+    double largestChunk;
+    double previousLargestChunk;
+    int blocksInWindow;
+    int destBlockSize;
+    bool isPriming;
+
+    /** (numPhases + 1) sets of numTaps coefficients*/
+    HeapBlock<float> coefficients;
+
+    /** Input history, written twice so that any window of numTaps samples is contiguous*/
+    HeapBlock<float> fifo;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioResampler);
+};
+
+#endif  // __AUDIORESAMPLER_H_5E2B7C14__
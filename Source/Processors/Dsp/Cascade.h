@@ -159,6 +159,20 @@ public:
             reset();
         }
 
+        // Copies the filter history, keeping the stage pointer on this object
+        State(const State& other) : Cascade::StateBase <StateType> (m_states)
+        {
+            *this = other;
+        }
+
+        State& operator= (const State& other)
+        {
+            for (int i = 0; i < MaxStages; ++i)
+                m_states[i] = other.m_states[i];
+
+            return *this;
+        }
+
         void reset()
         {
             StateType* state = m_states;
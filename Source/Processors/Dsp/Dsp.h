@@ -44,6 +44,7 @@ THE SOFTWARE.
 
 #include "Biquad.h"
 #include "Cascade.h"
+#include "FFT.h"
 #include "Filter.h"
 #include "PoleFilter.h"
 #include "SmoothedFilter.h"
@@ -0,0 +1,289 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Common.h"
+#include "FFT.h"
+
+#include <map>
+#include <mutex>
+
+namespace Dsp
+{
+
+namespace
+{
+    const double twoPi = 6.283185307179586476925286766559;
+}
+
+FFTPlan::FFTPlan(int size)
+    : m_size(size)
+    , m_halfSize(size / 2)
+{
+    assert(size >= 2 && (size & (size - 1)) == 0);
+
+    // bit-reversal permutation for the half-size complex transform
+    m_bitReversed.resize(m_halfSize);
+
+    int numBits = 0;
+
+    while ((1 << numBits) < m_halfSize)
+        numBits++;
+
+    for (int i = 0; i < m_halfSize; i++)
+    {
+        int reversed = 0;
+
+        for (int bit = 0; bit < numBits; bit++)
+        {
+            if (i & (1 << bit))
+                reversed |= 1 << (numBits - 1 - bit);
+        }
+
+        m_bitReversed[i] = reversed;
+    }
+
+    m_twiddles.resize(m_halfSize / 2 + 1);
+
+    for (int i = 0; i < (int)m_twiddles.size(); i++)
+    {
+        const double angle = -twoPi * i / m_halfSize;
+        m_twiddles[i] = Complex(float(std::cos(angle)), float(std::sin(angle)));
+    }
+
+    m_splitTwiddles.resize(m_halfSize + 1);
+
+    for (int k = 0; k <= m_halfSize; k++)
+    {
+        const double angle = -twoPi * k / m_size;
+        m_splitTwiddles[k] = Complex(float(std::cos(angle)), float(std::sin(angle)));
+    }
+}
+
+void FFTPlan::performComplexForward(Complex* data) const
+{
+    for (int i = 0; i < m_halfSize; i++)
+    {
+        const int j = m_bitReversed[i];
+
+        if (j > i)
+            std::swap(data[i], data[j]);
+    }
+
+    for (int length = 2; length <= m_halfSize; length <<= 1)
+    {
+        const int halfLength = length / 2;
+        const int step = m_halfSize / length;
+
+        for (int start = 0; start < m_halfSize; start += length)
+        {
+            for (int k = 0; k < halfLength; k++)
+            {
+                const Complex w = m_twiddles[k * step];
+                const Complex a = data[start + k];
+                const Complex b = data[start + k + halfLength] * w;
+
+                data[start + k] = a + b;
+                data[start + k + halfLength] = a - b;
+            }
+        }
+    }
+}
+
+void FFTPlan::performRealForward(const float* input, Complex* output, Complex* scratch) const
+{
+    // pack even samples into the real part and odd samples into the imaginary part
+    for (int n = 0; n < m_halfSize; n++)
+        scratch[n] = Complex(input[2 * n], input[2 * n + 1]);
+
+    performComplexForward(scratch);
+
+    const Complex halfI(0.0f, 0.5f);
+
+    for (int k = 0; k <= m_halfSize; k++)
+    {
+        const Complex zk = scratch[k == m_halfSize ? 0 : k];
+        const Complex zn = std::conj(scratch[k == 0 ? 0 : m_halfSize - k]);
+
+        const Complex even = 0.5f * (zk + zn);
+        const Complex odd = -halfI * (zk - zn);
+
+        output[k] = even + m_splitTwiddles[k] * odd;
+    }
+}
+
+void FFTPlan::performPowerSpectrum(const float* input, float* power, Complex* scratch) const
+{
+    for (int n = 0; n < m_halfSize; n++)
+        scratch[n] = Complex(input[2 * n], input[2 * n + 1]);
+
+    performComplexForward(scratch);
+
+    const Complex halfI(0.0f, 0.5f);
+
+    for (int k = 0; k <= m_halfSize; k++)
+    {
+        const Complex zk = scratch[k == m_halfSize ? 0 : k];
+        const Complex zn = std::conj(scratch[k == 0 ? 0 : m_halfSize - k]);
+
+        const Complex bin = 0.5f * (zk + zn) - halfI * m_splitTwiddles[k] * (zk - zn);
+
+        power[k] = std::norm(bin);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+    std::mutex& getPlanCacheMutex()
+    {
+        static std::mutex planCacheMutex;
+        return planCacheMutex;
+    }
+
+    std::map<int, std::shared_ptr<const FFTPlan>>& getPlanCache()
+    {
+        static std::map<int, std::shared_ptr<const FFTPlan>> planCache;
+        return planCache;
+    }
+}
+
+std::shared_ptr<const FFTPlan> FFTPlanCache::getPlan(int size)
+{
+    std::lock_guard<std::mutex> lock(getPlanCacheMutex());
+
+    std::shared_ptr<const FFTPlan>& plan = getPlanCache()[size];
+
+    if (plan == nullptr)
+        plan = std::make_shared<const FFTPlan>(size);
+
+    return plan;
+}
+
+void FFTPlanCache::purgeUnused()
+{
+    std::lock_guard<std::mutex> lock(getPlanCacheMutex());
+
+    auto& cache = getPlanCache();
+
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        if (it->second.use_count() == 1)
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+Welch::Welch()
+    : m_hop(0)
+    , m_windowPower(0.0f)
+{
+}
+
+void Welch::setup(int segmentLength, float overlap)
+{
+    m_plan = FFTPlanCache::getPlan(segmentLength);
+
+    overlap = std::min(std::max(overlap, 0.0f), 0.95f);
+    m_hop = std::max(1, int(segmentLength * (1.0f - overlap)));
+
+    // periodic Hann window
+    m_window.resize(segmentLength);
+    m_windowPower = 0.0f;
+
+    for (int n = 0; n < segmentLength; n++)
+    {
+        m_window[n] = float(0.5 - 0.5 * std::cos(twoPi * n / segmentLength));
+        m_windowPower += m_window[n] * m_window[n];
+    }
+
+    m_segment.resize(segmentLength);
+    m_power.resize(m_plan->getNumBins());
+    m_psd.resize(m_plan->getNumBins());
+    m_scratch.resize(m_plan->getScratchSize());
+}
+
+int Welch::estimate(const float* data, int numSamples, float sampleRate, float* psd)
+{
+    if (m_plan == nullptr)
+        return 0;
+
+    const int segmentLength = m_plan->getSize();
+    const int numBins = m_plan->getNumBins();
+
+    std::fill(psd, psd + numBins, 0.0f);
+
+    int numSegments = 0;
+
+    // align segments to the end of the data, so the newest samples are always used
+    for (int end = numSamples; end - segmentLength >= 0; end -= m_hop)
+    {
+        const float* segment = data + end - segmentLength;
+
+        for (int n = 0; n < segmentLength; n++)
+            m_segment[n] = segment[n] * m_window[n];
+
+        m_plan->performPowerSpectrum(m_segment.data(), m_power.data(), m_scratch.data());
+
+        for (int k = 0; k < numBins; k++)
+            psd[k] += m_power[k];
+
+        numSegments++;
+    }
+
+    if (numSegments == 0)
+        return 0;
+
+    const float scale = 1.0f / (numSegments * sampleRate * m_windowPower);
+
+    for (int k = 0; k < numBins; k++)
+    {
+        // one-sided spectrum: double everything except DC and Nyquist
+        const float sides = (k == 0 || k == numBins - 1) ? 1.0f : 2.0f;
+        psd[k] *= sides * scale;
+    }
+
+    return numSegments;
+}
+
+float Welch::bandPower(const float* data, int numSamples, float sampleRate, float lowHz, float highHz)
+{
+    if (estimate(data, numSamples, sampleRate, m_psd.data()) == 0)
+        return 0.0f;
+
+    const float binWidth = sampleRate / m_plan->getSize();
+    const int firstBin = std::max(0, int(std::ceil(lowHz / binWidth)));
+    const int lastBin = std::min(m_plan->getNumBins() - 1, int(std::floor(highHz / binWidth)));
+
+    float power = 0.0f;
+
+    for (int k = firstBin; k <= lastBin; k++)
+        power += m_psd[k];
+
+    return power * binWidth;
+}
+
+}
@@ -0,0 +1,162 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DSPFILTERS_FFT_H
+#define DSPFILTERS_FFT_H
+
+#include "Common.h"
+
+#include <memory>
+
+namespace Dsp
+{
+
+/*
+ * FFTPlan
+ *
+ * Bit-reversal table and twiddle factors for a real-input FFT
+ * of a fixed power-of-2 size. The real transform is computed
+ * as a complex FFT of half the size followed by a split step.
+ *
+ * A plan is immutable once constructed, so a single instance
+ * can be used from any number of threads, as long as each
+ * thread provides its own scratch space.
+ *
+ */
+class PLUGIN_API FFTPlan
+{
+public:
+    typedef std::complex<float> Complex;
+
+    explicit FFTPlan(int size);
+
+    /* Number of real input samples */
+    int getSize() const
+    {
+        return m_size;
+    }
+
+    /* Number of output bins (size / 2 + 1) */
+    int getNumBins() const
+    {
+        return m_halfSize + 1;
+    }
+
+    /* Number of complex values required for scratch space */
+    int getScratchSize() const
+    {
+        return m_halfSize;
+    }
+
+    /* Forward transform of getSize() real samples into getNumBins() complex bins */
+    void performRealForward(const float* input, Complex* output, Complex* scratch) const;
+
+    /* Squared magnitude of each of the getNumBins() bins */
+    void performPowerSpectrum(const float* input, float* power, Complex* scratch) const;
+
+private:
+    void performComplexForward(Complex* data) const;
+
+    int m_size;
+    int m_halfSize;
+
+    std::vector<int> m_bitReversed;
+    std::vector<Complex> m_twiddles;
+    std::vector<Complex> m_splitTwiddles;
+};
+
+//------------------------------------------------------------------------------
+
+/*
+ * FFTPlanCache
+ *
+ * Process-wide cache of FFT plans, keyed by size. Plans are
+ * created on first request and shared by every caller asking
+ * for the same size.
+ *
+ */
+class PLUGIN_API FFTPlanCache
+{
+public:
+    /* Returns the plan for a power-of-2 size (creating it if necessary) */
+    static std::shared_ptr<const FFTPlan> getPlan(int size);
+
+    /* Releases plans that are no longer used by anyone */
+    static void purgeUnused();
+};
+
+//------------------------------------------------------------------------------
+
+/*
+ * Welch
+ *
+ * Power spectral density estimate obtained by averaging the
+ * periodograms of overlapping, Hann-windowed segments.
+ *
+ * Each instance owns its scratch buffers, so one instance
+ * should be used per thread (e.g. one per channel).
+ *
+ */
+class PLUGIN_API Welch
+{
+public:
+    Welch();
+
+    /* Sets the segment length (power of 2) and the fraction by which segments overlap */
+    void setup(int segmentLength, float overlap);
+
+    int getSegmentLength() const
+    {
+        return m_plan != nullptr ? m_plan->getSize() : 0;
+    }
+
+    int getNumBins() const
+    {
+        return m_plan != nullptr ? m_plan->getNumBins() : 0;
+    }
+
+    /* Writes the one-sided power spectral density (units^2 / Hz) of the complete
+       segments in data into psd (getNumBins() values). Returns the number of
+       segments averaged. */
+    int estimate(const float* data, int numSamples, float sampleRate, float* psd);
+
+    /* Integrates the power spectral density of data between two frequencies */
+    float bandPower(const float* data, int numSamples, float sampleRate, float lowHz, float highHz);
+
+private:
+    std::shared_ptr<const FFTPlan> m_plan;
+
+    int m_hop;
+
+    std::vector<float> m_window;
+    float m_windowPower;
+
+    std::vector<float> m_segment;
+    std::vector<float> m_power;
+    std::vector<float> m_psd;
+    std::vector<FFTPlan::Complex> m_scratch;
+};
+
+}
+
+#endif
@@ -37,6 +37,7 @@ THE SOFTWARE.
 #define DSPFILTERS_SMOOTHEDFILTER_H
 
 #include <algorithm>
+#include <atomic>
 
 #include "Common.h"
 #include "Filter.h"
@@ -47,6 +48,16 @@ namespace Dsp
 /*
  * Implements smooth modulation of time-varying filter parameters
  *
+ * Coefficients are designed by the thread calling setParams() (normally
+ * the message thread) into one of four design slots, which are handed
+ * over to the audio thread lock-free. The audio thread only ever runs
+ * a fixed-coefficient kernel: when a new design arrives, the previous
+ * design keeps running on a copy of the filter state, and the outputs
+ * of the two are crossfaded over transitionSamples samples.
+ *
+ * A single thread may call setParams(), and a single thread may call
+ * process(); the two may be different.
+ *
  */
 template <class DesignClass,
          int Channels,
@@ -61,7 +72,12 @@ public:
 
     SmoothedFilterDesign(int transitionSamples)
         : m_transitionSamples(transitionSamples)
-        , m_remainingSamples(-1)  // first time flag
+        , m_writeSlot(0)
+        , m_pendingSlot(1)
+        , m_activeSlot(2)
+        , m_previousSlot(3)
+        , m_hasDesign(false)
+        , m_fadePosition(0)
     {
     }
 
@@ -70,50 +86,33 @@ public:
     void processBlock(int numSamples,
                       Sample* const* destChannelArray)
     {
-        const int numChannels = this->getNumChannels();
+        // only accept a new design once the previous crossfade has finished
+        if (m_fadePosition == 0 && (m_pendingSlot.load() & newDesignFlag))
+            acceptNewDesign();
 
         // If this goes off it means setup() was never called
-        assert(m_remainingSamples >= 0);
-
-        // first handle any transition samples
-        int remainingSamples = std::min(m_remainingSamples, numSamples);
-
-        if (remainingSamples > 0)
-        {
-            // interpolate parameters for each sample
-            const double t = 1. / m_remainingSamples;
-            double dp[maxParameters];
-            for (int i = 0; i < DesignClass::NumParams; ++i)
-                dp[i] = (this->getParams()[i] - m_transitionParams[i]) * t;
+        assert(m_hasDesign);
 
-            for (int n = 0; n < remainingSamples; ++n)
-            {
-                for (int i = DesignClass::NumParams; --i >=0;)
-                    m_transitionParams[i] += dp[i];
+        const DesignClass& design = m_slots[m_activeSlot];
 
-                m_transitionFilter.setParams(m_transitionParams);
+        int n = 0;
 
-                for (int i = numChannels; --i >= 0;)
-                {
-                    Sample* dest = destChannelArray[i]+n;
-                    *dest = this->m_state[i].process(*dest, m_transitionFilter);
-                }
-            }
+        while (m_fadePosition > 0 && n < numSamples)
+        {
+            const int chunk = std::min(std::min(numSamples - n, int(fadeChunkSize)), m_fadePosition);
 
-            m_remainingSamples -= remainingSamples;
+            crossfadeChunk(n, chunk, destChannelArray);
 
-            if (m_remainingSamples == 0)
-                m_transitionParams = this->getParams();
+            n += chunk;
         }
 
         // do what's left
-        if (numSamples - remainingSamples > 0)
+        if (numSamples - n > 0)
         {
-            // no transition
-            for (int i = 0; i < numChannels; ++i)
-                this->m_design.process(numSamples - remainingSamples,
-                                       destChannelArray[i] + remainingSamples,
-                                       this->m_state[i]);
+            for (int i = 0; i < Channels; ++i)
+                design.process(numSamples - n,
+                               destChannelArray[i] + n,
+                               this->m_state[i]);
         }
     }
 
@@ -127,29 +126,98 @@ public:
         processBlock(numSamples, arrayOfChannels);
     }
 
+    void reset()
+    {
+        filter_type_t::reset();
+        m_fadeState.reset();
+        m_fadePosition = 0;
+    }
+
 protected:
     void doSetParams(const Params& parameters)
     {
-        if (m_remainingSamples >= 0)
+        // design for introspection (getPoleZeros, response...)
+        filter_type_t::doSetParams(parameters);
+
+        // design for the audio thread, then publish it
+        m_slots[m_writeSlot].setParams(parameters);
+        m_writeSlot = m_pendingSlot.exchange(m_writeSlot | newDesignFlag) & slotMask;
+    }
+
+private:
+    enum
+    {
+        newDesignFlag = 4,
+        slotMask = 3,
+        fadeChunkSize = 64
+    };
+
+    void acceptNewDesign()
+    {
+        const int newSlot = m_pendingSlot.exchange(m_previousSlot) & slotMask;
+
+        m_previousSlot = m_activeSlot;
+        m_activeSlot = newSlot;
+
+        if (m_hasDesign && m_transitionSamples > 0)
         {
-            m_remainingSamples = m_transitionSamples;
+            // the outgoing design continues from the current state
+            m_fadeState = this->m_state;
+            m_fadePosition = m_transitionSamples;
         }
-        else
+
+        m_hasDesign = true;
+    }
+
+    // Runs the outgoing and incoming designs on the same input and
+    // blends their outputs with a linear ramp
+    template <typename Sample>
+    void crossfadeChunk(int start, int numSamples, Sample* const* destChannelArray)
+    {
+        const DesignClass& incoming = m_slots[m_activeSlot];
+        const DesignClass& outgoing = m_slots[m_previousSlot];
+
+        const Sample step = Sample(1) / Sample(m_transitionSamples);
+        const Sample firstGain = Sample(m_transitionSamples - m_fadePosition) * step;
+
+        Sample outgoingOutput[fadeChunkSize];
+
+        for (int i = 0; i < Channels; ++i)
         {
-            // first time
-            m_remainingSamples = 0;
-            m_transitionParams = parameters;
+            Sample* dest = destChannelArray[i] + start;
+
+            std::copy(dest, dest + numSamples, outgoingOutput);
+
+            outgoing.process(numSamples, outgoingOutput, m_fadeState[i]);
+            incoming.process(numSamples, dest, this->m_state[i]);
+
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const Sample gain = firstGain + Sample(n) * step;
+                dest[n] = outgoingOutput[n] + gain * (dest[n] - outgoingOutput[n]);
+            }
         }
 
-        filter_type_t::doSetParams(parameters);
+        m_fadePosition -= numSamples;
     }
 
-protected:
-    Params m_transitionParams;
-    DesignClass m_transitionFilter;
+    DesignClass m_slots[4];
     int m_transitionSamples;
 
-    int m_remainingSamples;        // remaining transition samples
+    // owned by the thread calling setParams()
+    int m_writeSlot;
+
+    // handed between threads; includes newDesignFlag when not yet seen by process()
+    std::atomic<int> m_pendingSlot;
+
+    // owned by the thread calling process()
+    int m_activeSlot;
+    int m_previousSlot;
+    bool m_hasDesign;
+    int m_fadePosition;
+
+    ChannelsState <Channels,
+                  typename DesignClass::template State <StateType> > m_fadeState;
 };
 
 }
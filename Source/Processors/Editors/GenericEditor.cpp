@@ -464,6 +464,7 @@ void GenericEditor::update(bool isEnabled_)
             delayMonitors[stream->getStreamId()] = streamSelector->getDelayMonitor(stream);
             ttlMonitors[stream->getStreamId()] = streamSelector->getTTLMonitor(stream);
 
+            streamSelector->getTTLMonitor(stream)->setSource(p, stream->getStreamId());
             streamSelector->getTTLMonitor(stream)->updateSettings(stream->getEventChannels());
 
         }
@@ -503,6 +504,11 @@ void GenericEditor::setMeanLatencyMs(uint16 streamId, float latencyMs)
         delayMonitors[streamId]->setDelay(latencyMs);
 }
 
+void GenericEditor::meanLatencyChanged(uint16 streamId, float latencyMs)
+{
+    setMeanLatencyMs(streamId, latencyMs);
+}
+
 bool GenericEditor::getCollapsedState()
 {
     return isCollapsed;
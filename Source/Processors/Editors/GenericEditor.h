@@ -27,6 +27,7 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 
 #include "../PluginManager/OpenEphysPlugin.h"
+#include "../GenericProcessor/ProcessingObserver.h"
 
 #include "../Parameter/ParameterEditor.h"
 #include "StreamSelector.h"
@@ -48,7 +49,8 @@ class UtilityButton;
 
     @see GenericProcessor, EditorViewport
 */
-class PLUGIN_API GenericEditor  : public AudioProcessorEditor
+class PLUGIN_API GenericEditor  : public AudioProcessorEditor,
+                                  public ProcessingObserver
 {
 public:
 
@@ -269,6 +271,9 @@ public:
     /** Updates the mean latency for a particular data stream (called by LatencyMeter class)*/
     void setMeanLatencyMs(uint16 streamId, float latencyMs);
 
+    /** Forwards latency measurements from the processing path to the DelayMonitor */
+    void meanLatencyChanged(uint16 streamId, float latencyMs) override;
+
     /** Returns the total width of the editor in it's current state. */
     virtual int getTotalWidth();
 
@@ -23,6 +23,7 @@
 
 #include "TTLMonitor.h"
 #include "GenericEditor.h"
+#include "../GenericProcessor/GenericProcessor.h"
 #include "../Settings/EventChannel.h"
 
 TTLBitDisplay::TTLBitDisplay(Colour colour_, String tooltipString_)
@@ -63,6 +64,9 @@ void TTLBitDisplay::paint(Graphics& g)
 }
 
 TTLMonitor::TTLMonitor()
+    : source(nullptr),
+    sourceStreamId(0),
+    lastWord(0)
 {
     colours.add(Colour(224, 185, 36));
     colours.add(Colour(243, 119, 33));
@@ -94,6 +98,12 @@ int TTLMonitor::updateSettings(Array<EventChannel*> eventChannels)
     return 0;
 }
 
+void TTLMonitor::setSource(GenericProcessor* processor, uint16 streamId)
+{
+    source = processor;
+    sourceStreamId = streamId;
+}
+
 void TTLMonitor::setState(int line, bool state)
 {
     if (line < 10)
@@ -103,6 +113,20 @@ void TTLMonitor::setState(int line, bool state)
 
 void TTLMonitor::timerCallback()
 {
+    if (source != nullptr)
+    {
+        const uint64 word = source->getTTLWord(sourceStreamId);
+        const uint64 changedBits = word ^ lastWord;
+
+        for (int bit = 0; bit < displays.size(); bit++)
+        {
+            if ((changedBits >> bit) & 1)
+                displays[bit]->setState((word >> bit) & 1);
+        }
+
+        lastWord = word;
+    }
+
     for (auto display : displays)
     {
         if (display->changedSinceLastRedraw)
@@ -112,6 +136,12 @@ void TTLMonitor::timerCallback()
 
 void TTLMonitor::startAcquisition()
 {
+    if (source != nullptr)
+        lastWord = source->getTTLWord(sourceStreamId);
+
+    for (int bit = 0; bit < displays.size(); bit++)
+        displays[bit]->setState((lastWord >> bit) & 1);
+
     startTimer(50);
 }
 
@@ -29,6 +29,7 @@
 
 class EventChannel;
 class GenericEditor;
+class GenericProcessor;
 
 /**
 
@@ -69,6 +70,10 @@ private:
   Used to display the status of TTL events within
   a GenericEditor.
 
+  While acquisition is running, the monitor polls the TTL word
+  its processor publishes at the end of each block, so TTL events
+  never call into the GUI from the audio thread.
+
   @see GenericEditor, EventChannel.
 
 */
@@ -86,6 +91,9 @@ public:
     /** Updates settings based on incoming event channels (not used) */
 	int updateSettings(Array<EventChannel*> eventChannels);
 
+    /** Sets the processor and data stream whose TTL word is displayed*/
+    void setSource(GenericProcessor* processor, uint16 streamId);
+
     /** Sets the state of a particular line (1-10 only)*/
     void setState(int line, bool state);
     
@@ -95,11 +103,15 @@ public:
     /** Stops rendering timer*/
     void stopAcquisition();
 
-    /** Repaints the TTL bits*/
+    /** Reads the latest TTL word and repaints the bits that changed*/
     void timerCallback();
 
 private:
 
+    GenericProcessor* source;
+    uint16 sourceStreamId;
+    uint64 lastWord;
+
     Array<Colour> colours; 
 
     OwnedArray<TTLBitDisplay> displays;
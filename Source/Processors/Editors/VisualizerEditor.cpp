@@ -23,6 +23,7 @@
 
 #include "VisualizerEditor.h"
 #include "../../AccessClass.h"
+#include "../../CoreServices.h"
 #include "../../UI/UIComponent.h"
 #include "../../UI/DataViewport.h"
 
@@ -174,6 +175,8 @@ void VisualizerEditor::editorWasClicked()
 
 void VisualizerEditor::ButtonResponder::buttonClicked (Button* button)
 {
+    if (CoreServices::isHeadless())
+        return;
 
     // Handle the buttons to open the canvas in a tab or window
     editor->checkForCanvas();
@@ -233,6 +236,9 @@ void VisualizerEditor::ButtonResponder::buttonClicked (Button* button)
 
 void VisualizerEditor::checkForCanvas()
 {
+    if (CoreServices::isHeadless())
+        return;
+
     if (canvas == nullptr)
     {
         canvas.reset(createNewCanvas());
@@ -254,6 +260,20 @@ void VisualizerEditor::checkForCanvas()
 
 void VisualizerEditor::saveCustomParametersToXml (XmlElement* xml)
 {
+    if (CoreServices::isHeadless())
+    {
+        if (headlessCanvasState != nullptr)
+        {
+            for (int i = 0; i < headlessCanvasState->getNumAttributes(); i++)
+                xml->setAttribute (headlessCanvasState->getAttributeName (i), headlessCanvasState->getAttributeValue (i));
+
+            for (auto* child : headlessCanvasState->getChildIterator())
+                xml->addChildElement (new XmlElement (*child));
+        }
+
+        return;
+    }
+
     xml->setAttribute ("Type", "Visualizer");
 
     XmlElement* tabButtonState = xml->createNewChildElement (EDITOR_TAG_TAB);
@@ -286,6 +306,14 @@ void VisualizerEditor::saveCustomParametersToXml (XmlElement* xml)
 
 void VisualizerEditor::loadCustomParametersFromXml (XmlElement* xml)
 {
+    if (CoreServices::isHeadless())
+    {
+        headlessCanvasState = std::make_unique<XmlElement> (*xml);
+
+        loadVisualizerEditorParameters (xml);
+
+        return;
+    }
 
     bool canvasHidden = false;
 
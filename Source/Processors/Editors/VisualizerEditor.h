@@ -226,6 +226,10 @@ private:
 
     void initializeSelectors();
 
+    /** Saved settings of a canvas that was never created because the GUI is headless;
+        written back unchanged when the signal chain is saved */
+    std::unique_ptr<XmlElement> headlessCanvasState;
+
     // Some constants
 
 	//C++11 constexpr keyword is not implemented in Visual Studio prior 2015
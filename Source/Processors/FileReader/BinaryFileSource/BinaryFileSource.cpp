@@ -23,6 +23,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "BinaryFileSource.h"
 
+#include <algorithm>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BINARY_SOURCE_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if JUCE_LINUX || JUCE_MAC
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 using namespace BinarySource;
 
 BinaryFileSource::BinaryFileSource() 
@@ -197,10 +210,12 @@ void BinaryFileSource::fillRecordInfo()
 			File sampleNumbersFile = m_rootPath.getChildFile("events").getChildFile(streamName).getChildFile(sampleNumbersFilename);
 			std::unique_ptr<MemoryMappedFile> sampleNumbersMap(new MemoryMappedFile(sampleNumbersFile, MemoryMappedFile::readOnly));
 
-			if (sampleNumbersFile.getSize() == EVENT_HEADER_SIZE_IN_BYTES)
+			if (sampleNumbersFile.getSize() == EVENT_HEADER_SIZE_IN_BYTES || sampleNumbersMap->getData() == nullptr)
 			{
 				continue;
 			}
+
+			const int64* sampleNumbers = reinterpret_cast<const int64*>(static_cast<const char*>(sampleNumbersMap->getData()) + EVENT_HEADER_SIZE_IN_BYTES);
 				
 
 			int nEvents = (sampleNumbersFile.getSize() - EVENT_HEADER_SIZE_IN_BYTES) / 8;
@@ -213,18 +228,30 @@ void BinaryFileSource::fillRecordInfo()
 				File channelStatesFile = m_rootPath.getChildFile("events").getChildFile(streamName).getChildFile(channelStatesFilename);
 				std::unique_ptr<MemoryMappedFile> channelStatesFileMap(new MemoryMappedFile(channelStatesFile, MemoryMappedFile::readOnly));
 
+				if (channelStatesFileMap->getData() == nullptr)
+					continue;
+
+				const int16* states = reinterpret_cast<const int16*>(static_cast<const char*>(channelStatesFileMap->getData()) + EVENT_HEADER_SIZE_IN_BYTES);
+
 				streamName = streamName.substring(0,streamName.lastIndexOf("/TTL"));
 
+				EventTable& table = eventTables[streamName];
+				table.sampleNumbersFile = std::move(sampleNumbersMap);
+				table.statesFile = std::move(channelStatesFileMap);
+				table.sampleNumbers = sampleNumbers;
+				table.states = states;
+				table.numEvents = nEvents;
+				table.startSampleNumber = startSampleNumbers[streamName];
+
+				sortEvents(table);
+
 				EventInfo eventInfo;
 
 				for (int j = 0; j < nEvents; j++)
 				{
-					
-					int16* data = static_cast<int16*>(channelStatesFileMap->getData()) + (EVENT_HEADER_SIZE_IN_BYTES / 2) + j * sizeof(int16) / 2;
-					eventInfo.channels.push_back(abs(*data));
-					eventInfo.channelStates.push_back(*data > 0);
-					int64* snData = static_cast<int64*>(sampleNumbersMap->getData()) + (EVENT_HEADER_SIZE_IN_BYTES / 8) + j * sizeof(int64) / 8;
-					eventInfo.timestamps.push_back(*snData - startSampleNumbers[streamName]);
+					eventInfo.channels.push_back(abs(table.states[j]));
+					eventInfo.channelStates.push_back(table.states[j] > 0);
+					eventInfo.timestamps.push_back(table.sampleNumbers[j] - table.startSampleNumber);
 					eventInfo.text.push_back("");
 				}
 				eventInfoMap[streamName] = eventInfo;
@@ -242,7 +269,14 @@ void BinaryFileSource::fillRecordInfo()
 
 				uint64 itemSize = std::stoi(line.fromFirstOccurrenceOf("'|S", 0, 0).upToFirstOccurrenceOf("'", 0, 0).toStdString());
 
-				EventInfo eventInfo;
+				EventTable& table = eventTables[streamName];
+				table.sampleNumbersFile = std::move(sampleNumbersMap);
+				table.sampleNumbers = sampleNumbers;
+				table.numEvents = nEvents;
+
+				// Use the first stream's start sample number for the MessageCenter
+				table.startSampleNumber = startSampleNumbers.begin()->second;
+
 				int k_word;
 
 				juce::MemoryBlock buffer(itemSize);
@@ -258,14 +292,19 @@ void BinaryFileSource::fillRecordInfo()
 							k_word = k;
 					} 
 
-					String outString = juce::String::fromUTF8(data, (int)k_word);
+					table.text.add(juce::String::fromUTF8(data, (int)k_word));
+				}
+
+				sortEvents(table);
+
+				EventInfo eventInfo;
+
+				for (int j = 0; j < nEvents; j++)
+				{
 					eventInfo.channels.push_back(0);
 					eventInfo.channelStates.push_back(0);
-					int64 *snData = static_cast<int64 *>(sampleNumbersMap->getData()) + (EVENT_HEADER_SIZE_IN_BYTES / 8) + j * sizeof(int64) / 8;
-					// Use the first stream's start sample number for the MessageCenter
-					int64 startSampleNumber = startSampleNumbers.begin()->second;
-					eventInfo.timestamps.push_back(*snData - startSampleNumber);
-					eventInfo.text.push_back(outString);
+					eventInfo.timestamps.push_back(table.sampleNumbers[j] - table.startSampleNumber);
+					eventInfo.text.push_back(table.text[j]);
 				}
 				eventInfoMap[streamName] = eventInfo;
 			}
@@ -273,31 +312,103 @@ void BinaryFileSource::fillRecordInfo()
 	}
 }
 
+void BinaryFileSource::sortEvents(EventTable& table)
+{
+	if (std::is_sorted(table.sampleNumbers, table.sampleNumbers + table.numEvents))
+		return;
+
+	std::vector<int> order(table.numEvents);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+		[&table](int a, int b) { return table.sampleNumbers[a] < table.sampleNumbers[b]; });
+
+	table.sortedSampleNumbers.resize(table.numEvents);
+
+	for (int j = 0; j < table.numEvents; j++)
+		table.sortedSampleNumbers[j] = table.sampleNumbers[order[j]];
+
+	table.sampleNumbers = table.sortedSampleNumbers.data();
+
+	if (table.states != nullptr)
+	{
+		table.sortedStates.resize(table.numEvents);
+
+		for (int j = 0; j < table.numEvents; j++)
+			table.sortedStates[j] = table.states[order[j]];
+
+		table.states = table.sortedStates.data();
+	}
+
+	if (table.text.size() == table.numEvents)
+	{
+		StringArray sortedText;
+
+		for (int j = 0; j < table.numEvents; j++)
+			sortedText.add(table.text[order[j]]);
+
+		table.text.swapWith(sortedText);
+	}
+}
+
+void BinaryFileSource::addEvents(EventTable& table, EventInfo& info, int64 localStart, int64 localStop, int64 offset)
+{
+	const int64 first = localStart + table.startSampleNumber;
+	const int64 last = localStop + table.startSampleNumber;
+
+	// continuous playback picks up where the previous range ended; anything else is a seek
+	if (localStart != table.nextSample)
+		table.cursor = int(std::lower_bound(table.sampleNumbers, table.sampleNumbers + table.numEvents, first) - table.sampleNumbers);
+
+	int i = table.cursor;
+
+	for (; i < table.numEvents && table.sampleNumbers[i] < last; i++)
+	{
+		if (table.states != nullptr)
+		{
+			info.channels.push_back(abs(table.states[i]) - 1);
+			info.channelStates.push_back(table.states[i] > 0);
+			info.text.push_back(String());
+		}
+		else
+		{
+			info.channels.push_back(-1);
+			info.channelStates.push_back(0);
+			info.text.push_back(table.text[i]);
+		}
+
+		info.timestamps.push_back(table.sampleNumbers[i] - table.startSampleNumber + offset);
+	}
+
+	table.cursor = i;
+	table.nextSample = localStop;
+}
+
 void BinaryFileSource::processEventData(EventInfo &eventInfo, int64 start, int64 stop)
 {
+	const int64 numSamples = getActiveNumSamples();
 
-	int local_start = start % getActiveNumSamples();
-	int local_stop = stop % getActiveNumSamples();
-	int loop_count = start / getActiveNumSamples();
+	if (stop <= start || numSamples <= 0)
+		return;
 
-	std::vector<String> includeStreams = {currentStream, "MessageCenter"};
+	const int64 localStart = start % numSamples;
+	const int64 localStop = stop % numSamples;
+	const int64 offset = (start / numSamples) * numSamples;
 
-	for (int s = 0; s < includeStreams.size(); s++)
+	for (auto streamName : { currentStream, String("MessageCenter") })
 	{
-		EventInfo info = eventInfoMap[includeStreams[s]];
+		auto it = eventTables.find(streamName);
 
-		int i = 0;
-			
-		while (i < info.timestamps.size())
+		if (it == eventTables.end())
+			continue;
+
+		if (localStop > localStart)
 		{
-			if (info.timestamps[i] >= local_start && info.timestamps[i] < local_stop)
-			{
-				eventInfo.channels.push_back(info.channels[i] - 1);
-				eventInfo.channelStates.push_back((info.channelStates[i]));
-				eventInfo.timestamps.push_back(info.timestamps[i] + loop_count * getActiveNumSamples());
-				eventInfo.text.push_back(info.text[i]);
-			}
-			i++;
+			addEvents(it->second, eventInfo, localStart, localStop, offset);
+		}
+		else // the range wraps around the end of the recording
+		{
+			addEvents(it->second, eventInfo, localStart, numSamples, offset);
+			addEvents(it->second, eventInfo, 0, localStop, offset + numSamples);
 		}
 	}
 }
@@ -354,3 +465,131 @@ void BinaryFileSource::processChannelData(int16* inBuffer, float* outBuffer, int
 		*(outBuffer + i) = *(inBuffer + (numActiveChannels * i) + channel) * bitVolts[channel];
 	}
 }
+
+const int16* BinaryFileSource::getDataView(int64 sample, int numSamples)
+{
+	if (m_dataFile == nullptr || m_dataFile->getData() == nullptr
+		|| sample < 0 || numSamples < 0 || sample + numSamples > getActiveNumSamples())
+		return nullptr;
+
+	return static_cast<const int16*>(m_dataFile->getData()) + (sample * numActiveChannels);
+}
+
+void BinaryFileSource::prefetch(int64 sample, int numSamples)
+{
+#if JUCE_LINUX || JUCE_MAC
+	if (m_dataFile == nullptr || m_dataFile->getData() == nullptr)
+		return;
+
+	const int64 totalSamples = getActiveNumSamples();
+	sample = jlimit<int64>(0, totalSamples, sample);
+	const int64 endSample = jmin<int64>(totalSamples, sample + numSamples);
+
+	if (endSample <= sample)
+		return;
+
+	static const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+
+	char* base = static_cast<char*>(m_dataFile->getData());
+	const size_t startByte = (size_t) (sample * numActiveChannels * sizeof(int16));
+	const size_t endByte = (size_t) (endSample * numActiveChannels * sizeof(int16));
+	const size_t alignedStart = startByte - (startByte % pageSize);
+
+	// The mapping itself is page-aligned, so offsets from its base can be aligned directly
+	posix_madvise(base + alignedStart, endByte - alignedStart, POSIX_MADV_WILLNEED);
+#endif
+}
+
+void BinaryFileSource::processBlockData(const int16* inBuffer, float* const* outBuffers, int64 numSamples)
+{
+	if (!inBuffer) return;
+
+	const int numChannels = numActiveChannels;
+	const float* volts = bitVolts.getRawDataPointer();
+	int channel = 0;
+
+#if BINARY_SOURCE_USE_SSE2
+	// Transposes 8x8 tiles (8 samples of 8 channels) in registers, then converts and
+	// scales each channel's 8 samples at once
+	const int64 numTiledSamples = numSamples & ~int64(7);
+
+	for (; channel + 8 <= numChannels; channel += 8)
+	{
+		__m128 scale[8];
+
+		for (int c = 0; c < 8; c++)
+			scale[c] = _mm_set1_ps(volts[channel + c]);
+
+		for (int64 i = 0; i < numTiledSamples; i += 8)
+		{
+			const int16* in = inBuffer + i * numChannels + channel;
+
+			__m128i r0 = _mm_loadu_si128((const __m128i*) (in));
+			__m128i r1 = _mm_loadu_si128((const __m128i*) (in + numChannels));
+			__m128i r2 = _mm_loadu_si128((const __m128i*) (in + numChannels * 2));
+			__m128i r3 = _mm_loadu_si128((const __m128i*) (in + numChannels * 3));
+			__m128i r4 = _mm_loadu_si128((const __m128i*) (in + numChannels * 4));
+			__m128i r5 = _mm_loadu_si128((const __m128i*) (in + numChannels * 5));
+			__m128i r6 = _mm_loadu_si128((const __m128i*) (in + numChannels * 6));
+			__m128i r7 = _mm_loadu_si128((const __m128i*) (in + numChannels * 7));
+
+			const __m128i a0 = _mm_unpacklo_epi16(r0, r1);
+			const __m128i a1 = _mm_unpackhi_epi16(r0, r1);
+			const __m128i a2 = _mm_unpacklo_epi16(r2, r3);
+			const __m128i a3 = _mm_unpackhi_epi16(r2, r3);
+			const __m128i a4 = _mm_unpacklo_epi16(r4, r5);
+			const __m128i a5 = _mm_unpackhi_epi16(r4, r5);
+			const __m128i a6 = _mm_unpacklo_epi16(r6, r7);
+			const __m128i a7 = _mm_unpackhi_epi16(r6, r7);
+
+			const __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+			const __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+			const __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+			const __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+			const __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+			const __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+			const __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+			const __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+			// Row c now holds channel c for the 8 samples
+			const __m128i columns[8] = {
+				_mm_unpacklo_epi64(b0, b4), _mm_unpackhi_epi64(b0, b4),
+				_mm_unpacklo_epi64(b1, b5), _mm_unpackhi_epi64(b1, b5),
+				_mm_unpacklo_epi64(b2, b6), _mm_unpackhi_epi64(b2, b6),
+				_mm_unpacklo_epi64(b3, b7), _mm_unpackhi_epi64(b3, b7)
+			};
+
+			for (int c = 0; c < 8; c++)
+			{
+				// Sign-extend int16 to int32 by shifting into the upper half
+				const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(columns[c], columns[c]), 16);
+				const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(columns[c], columns[c]), 16);
+
+				float* out = outBuffers[channel + c] + i;
+				_mm_storeu_ps(out, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale[c]));
+				_mm_storeu_ps(out + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale[c]));
+			}
+		}
+
+		for (int64 i = numTiledSamples; i < numSamples; i++)
+		{
+			const int16* in = inBuffer + i * numChannels + channel;
+
+			for (int c = 0; c < 8; c++)
+				outBuffers[channel + c][i] = in[c] * volts[channel + c];
+		}
+	}
+#endif
+
+	// Remaining channels: one interleaved pass, writing every channel per frame
+	if (channel < numChannels)
+	{
+		for (int64 i = 0; i < numSamples; i++)
+		{
+			const int16* in = inBuffer + i * numChannels;
+
+			for (int c = channel; c < numChannels; c++)
+				outBuffers[c][i] = in[c] * volts[c];
+		}
+	}
+}
@@ -66,12 +66,55 @@ namespace BinarySource
 		/** Convert nSamples of data from int16 to float */
 		void processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples) override;
 
+		/** Data is read directly from the memory-mapped .dat file */
+		bool canProvideDataViews() const override { return true; }
+
+		/** Returns a pointer into the memory-mapped .dat file */
+		const int16* getDataView(int64 sample, int numSamples) override;
+
+		/** Asks the OS to page in a range of the .dat file ahead of time */
+		void prefetch(int64 sample, int numSamples) override;
+
+		/** De-interleaves and scales all channels in a single pass */
+		void processBlockData(const int16* inBuffer, float* const* outBuffers, int64 numSamples) override;
+
 		/** Add info about events occurring within a sample range */
 		void processEventData(EventInfo &info, int64 startTimestamp, int64 stopTimestamp) override;
 
 		int64 loopCount;
 
 	private:
+
+		/** Events of one stream, in chronological order. TTL sample numbers and
+		    states are read directly from the memory-mapped .npy files. */
+		struct EventTable
+		{
+			std::unique_ptr<MemoryMappedFile> sampleNumbersFile;
+			std::unique_ptr<MemoryMappedFile> statesFile;
+
+			/** Only used if the files are not in chronological order */
+			std::vector<int64> sortedSampleNumbers;
+			std::vector<int16> sortedStates;
+
+			const int64* sampleNumbers = nullptr;
+			const int16* states = nullptr; // nullptr for text events
+			StringArray text;
+			int numEvents = 0;
+			int64 startSampleNumber = 0;
+
+			/** Index of the first event at or after nextSample (the end of the last range read) */
+			int cursor = 0;
+			int64 nextSample = -1;
+		};
+
+		/** Sorts a table whose files are not in chronological order */
+		static void sortEvents(EventTable& table);
+
+		/** Appends the events within [localStart, localStop) of the recording, shifted by offset */
+		void addEvents(EventTable& table, EventInfo& info, int64 localStart, int64 localStop, int64 offset);
+
+		/** Event tables by stream name */
+		std::map<String, EventTable> eventTables;
 		
 		int numActiveChannels;
 		Array<float> bitVolts;
@@ -36,7 +36,6 @@
 #include "../Events/Event.h"
 
 FileReader::FileReader() : GenericProcessor ("File Reader")
-    , Thread ("filereader_Async_Reader")
     , totalSamplesAcquired      (0)
     , currentSampleRate         (0)
     , currentNumChannels        (0)
@@ -47,12 +46,17 @@ FileReader::FileReader() : GenericProcessor ("File Reader")
     , stopSample                (0)
     , loopCount                 (0)
     , bufferCacheWindow         (0)
-    , m_shouldFillBackBuffer    (false)
 	, m_bufferSize              (1024)
 	, m_sysSampleRate           (44100)
     , playbackActive            (true)
     , gotNewFile                (true)
     , loopPlayback              (true)
+    , directReads               (false)
+    , readAheadTime             (DEFAULT_READ_AHEAD_SECONDS)
+    , blocksPerPrefetch         (1)
+    , sampleNumberOffset        (0)
+    , reachedEnd                (false)
+    , numSkippedBlocks          (0)
 {
 
 	/* Load any plugin file sources */
@@ -62,7 +66,8 @@ FileReader::FileReader() : GenericProcessor ("File Reader")
 
     for (int i = 0; i < numFileSources; ++i)
     {
-        Plugin::FileSourceInfo info = AccessClass::getPluginManager()->getFileSourceInfo (i);
+        // the extensions are in the plugin manifest, so the library isn't loaded until a file is opened
+        Plugin::FileSourceInfo info = AccessClass::getPluginManager()->getFileSourceInfo (i, false);
 
         LOGD("Plugin ", i + 1, ": ", info.name, " (", info.extensions, ")");
 
@@ -107,8 +112,7 @@ FileReader::FileReader() : GenericProcessor ("File Reader")
 
 FileReader::~FileReader()
 {
-    signalThreadShouldExit();
-    notify();
+    readAhead.clearSources();
 }
 
 AudioProcessorEditor* FileReader::createEditor()
@@ -181,8 +185,23 @@ bool FileReader::startAcquisition()
 
     static_cast<FileReaderEditor*> (getEditor())->startTimer(100);
 
+    /* When free-running, sample numbers match the original recording and playback stops at the end */
+    const bool freeRunning = CoreServices::isFreeRunning();
+
+    sampleNumberOffset = freeRunning ? input->getRecordStartTimestamp (input->getActiveRecord()) : 0;
+
+    for (auto stream : secondaryStreams)
+        stream->sampleNumberOffset = freeRunning ? stream->source->getRecordStartTimestamp (stream->source->getActiveRecord()) : -stream->startOffset;
+
+    reachedEnd = false;
+    numSkippedBlocks = 0;
+
     /* Start asynchronous file reading thread */
-	startThread(); 
+    if (!directReads)
+    {
+        readAhead.resetUnderruns();
+        readAhead.startThread();
+    }
 
 	return true;
 }
@@ -190,7 +209,14 @@ bool FileReader::startAcquisition()
 bool FileReader::stopAcquisition()
 {
 
-	stopThread(500);
+	readAhead.stopThread(500);
+
+    if (getNumUnderruns() > 0)
+        LOGC("File Reader: data was not read in time for ", getNumUnderruns(), " blocks.");
+
+    if (getNumSkippedBlocks() > 0)
+        LOGC("File Reader: skipped ", getNumSkippedBlocks(), " blocks while waiting for data.");
+
     static_cast<FileReaderEditor*> (getEditor())->stopTimer();
 	return true;
 }
@@ -213,20 +239,12 @@ bool FileReader::setFile (String fullpath)
 
     if (isExtensionSupported)
     {
-        const int index = supportedExtensions[ext] -1 ;
-		const int numPluginFileSources = AccessClass::getPluginManager()->getNumFileSources();
+        readAhead.clearSources();
+        secondaryStreams.clear();
+
+		input = createFileSource(ext);
+        LOGD("Found input.");
 
-		if (index < numPluginFileSources)
-		{
-			Plugin::FileSourceInfo sourceInfo = AccessClass::getPluginManager()->getFileSourceInfo(index);
-			input = sourceInfo.creator();
-            LOGD("Found input.");
-		}
-		else
-		{
-			input = createBuiltInFileSource(index - numPluginFileSources);
-            LOGD("Found input.");
-		}
 		if (!input)
 		{
 			LOGE("Error creating file source for extension ", ext);
@@ -265,10 +283,33 @@ bool FileReader::setFile (String fullpath)
     return true;
 }
 
+FileSource* FileReader::createFileSource (const String& extension) const
+{
+    const int index = supportedExtensions[extension] - 1;
+
+    if (index < 0)
+        return nullptr;
+
+    const int numPluginFileSources = AccessClass::getPluginManager()->getNumFileSources();
+
+    if (index < numPluginFileSources)
+    {
+        Plugin::FileSourceInfo sourceInfo = AccessClass::getPluginManager()->getFileSourceInfo(index);
+
+        if (sourceInfo.creator == nullptr)
+            return nullptr;
+
+        return sourceInfo.creator();
+    }
+
+    return createBuiltInFileSource(index - numPluginFileSources);
+}
+
 void FileReader::setActiveRecording (int index)
 {
     if (!input) { return; }
 
+    readAhead.clearSources();
     input->setActiveRecord (index);
 
     currentNumChannels       = input->getActiveNumChannels();
@@ -290,12 +331,164 @@ void FileReader::setActiveRecording (int index)
 
     static_cast<FileReaderEditor*> (getEditor())->setTotalTime (samplesToMilliseconds (currentNumTotalSamples));
 	input->seekTo(startSample);
+
+    createSecondaryStreams();
     
     gotNewFile = true;
 
    
 }
 
+void FileReader::createSecondaryStreams()
+{
+    readAhead.clearSources();
+    secondaryStreams.clear();
+
+    const File file (input->getFileName());
+    const String ext = file.getFileExtension().toLowerCase().substring (1);
+
+    /* Sample numbers count from the start of acquisition at each stream's own rate */
+    const double startTime = double (input->getRecordStartTimestamp (input->getActiveRecord())) / currentSampleRate;
+
+    for (int record = 0; record < input->getNumRecords(); record++)
+    {
+        if (record == input->getActiveRecord())
+            continue;
+
+        std::unique_ptr<FileSource> source (createFileSource (ext));
+
+        if (source == nullptr || ! source->openFile (file) || record >= source->getNumRecords())
+        {
+            LOGE("Unable to open ", input->getRecordName (record), " for playback.");
+            continue;
+        }
+
+        source->setActiveRecord (record);
+
+        SecondaryStream* stream = new SecondaryStream();
+        stream->numChannels = source->getActiveNumChannels();
+        stream->sampleRate = source->getActiveSampleRate();
+        stream->rateRatio = stream->sampleRate / currentSampleRate;
+        stream->startOffset = int64 (std::round (startTime * stream->sampleRate)) - source->getRecordStartTimestamp (record);
+        stream->currentSample = 0;
+        stream->totalSamplesAcquired = 0;
+        stream->fraction = 0.0;
+        stream->sampleNumberOffset = -stream->startOffset;
+        stream->source = std::move (source);
+
+        secondaryStreams.add (stream);
+    }
+}
+
+void FileReader::resetSecondaryStreams()
+{
+    for (auto stream : secondaryStreams)
+    {
+        stream->currentSample = toStreamSample (stream, startSample);
+        stream->totalSamplesAcquired = stream->currentSample;
+        stream->fraction = 0.0;
+    }
+}
+
+void FileReader::updatePlayheads()
+{
+    if (directReads)
+        return;
+
+    readAhead.setPlayhead (0, currentSample, startSample, stopSample);
+
+    for (int s = 0; s < secondaryStreams.size(); s++)
+    {
+        SecondaryStream* stream = secondaryStreams[s];
+
+        int64 recordedStart, recordedStop;
+        getRecordedRange (stream, recordedStart, recordedStop);
+
+        // before the stream's recording starts, the first recorded samples are needed next
+        const int64 position = stream->currentSample < recordedStart || stream->currentSample >= recordedStop
+                             ? recordedStart : stream->currentSample;
+
+        readAhead.setPlayhead (s + 1, position, recordedStart, recordedStop);
+    }
+}
+
+int64 FileReader::toStreamSample (const SecondaryStream* stream, int64 sample) const
+{
+    return int64 (std::floor (double (sample) * stream->rateRatio)) + stream->startOffset;
+}
+
+void FileReader::getRecordedRange (const SecondaryStream* stream, int64& start, int64& stop) const
+{
+    const int64 streamLength = stream->source->getActiveNumSamples();
+
+    start = jlimit (int64 (0), streamLength, toStreamSample (stream, startSample));
+    stop = jlimit (start, streamLength, toStreamSample (stream, stopSample));
+}
+
+void FileReader::readSecondary (int streamIndex, AudioBuffer<float>& buffer, int channelOffset,
+                                int numSamples, bool waitForData)
+{
+    SecondaryStream* stream = secondaryStreams[streamIndex];
+
+    const int64 start = toStreamSample (stream, startSample);
+    const int64 stop = toStreamSample (stream, stopSample);
+
+    int64 recordedStart, recordedStop;
+    getRecordedRange (stream, recordedStart, recordedStop);
+
+    int samplesRead = 0;
+
+    while (samplesRead < numSamples)
+    {
+        if (stop <= start)
+        {
+            for (int i = 0; i < stream->numChannels; ++i)
+                buffer.clear (channelOffset + i, samplesRead, numSamples - samplesRead);
+
+            break;
+        }
+
+        // wraps at the same time as the selected recording
+        if (stream->currentSample >= stop || stream->currentSample < start)
+            stream->currentSample = start;
+
+        const int64 position = stream->currentSample;
+        int samplesToRead = int (jmin (int64 (numSamples - samplesRead), stop - position));
+
+        if (position < recordedStart || position >= recordedStop)
+        {
+            // not recorded by this stream
+            const int64 gapEnd = position < recordedStart ? recordedStart : stop;
+            samplesToRead = int (jmin (int64 (samplesToRead), gapEnd - position));
+
+            for (int i = 0; i < stream->numChannels; ++i)
+                buffer.clear (channelOffset + i, samplesRead, samplesToRead);
+
+            stream->currentSample += samplesToRead;
+        }
+        else
+        {
+            samplesToRead = int (jmin (int64 (samplesToRead), recordedStop - position));
+
+            if (directReads)
+            {
+                readDirect (stream->source.get(), stream->currentSample, recordedStart, recordedStop,
+                            buffer, channelOffset, stream->numChannels, samplesToRead, samplesRead);
+            }
+            else
+            {
+                for (int i = 0; i < stream->numChannels; ++i)
+                    channelPointers[i] = buffer.getWritePointer (channelOffset + i, samplesRead);
+
+                readAhead.read (streamIndex + 1, stream->currentSample, recordedStart, recordedStop,
+                                channelPointers, samplesToRead, waitForData);
+            }
+        }
+
+        samplesRead += samplesToRead;
+    }
+}
+
 int64 FileReader::getCurrentSample()
 {
     return currentSample;
@@ -306,16 +499,13 @@ void FileReader::setPlaybackStart(int64 startSample)
     this->startSample = startSample;
     this->totalSamplesAcquired = startSample;
 
-    input->seekTo(startSample);
     currentSample = startSample;
 
-    switchBuffer();
+    resetSecondaryStreams();
 
-    if (CoreServices::getAcquisitionStatus() && !isThreadRunning())
-    {
-        m_shouldFillBackBuffer.set(true);
-        startThread();
-    }
+    /* Recently visited regions are still cached, so scrubbing back to them is instant */
+    updatePlayheads();
+    bufferCacheWindow = 0;
     
 }
 
@@ -323,6 +513,28 @@ void FileReader::setPlaybackStop(int64 stopSample)
 {
     this->stopSample = stopSample;
     currentNumScrubbedSamples = stopSample - startSample;
+
+    updatePlayheads();
+}
+
+void FileReader::setReadAheadTime (float seconds)
+{
+    readAheadTime = jmax (0.1f, seconds);
+}
+
+float FileReader::getReadAheadTime() const
+{
+    return readAheadTime;
+}
+
+int FileReader::getNumUnderruns() const
+{
+    return readAhead.getNumUnderruns();
+}
+
+int FileReader::getNumSkippedBlocks() const
+{
+    return numSkippedBlocks.load();
 }
 
 String FileReader::getFile() const
@@ -333,6 +545,61 @@ String FileReader::getFile() const
         return String();
 }
 
+void FileReader::addStream (FileSource* source, const Array<RecordedChannelInfo>& channels)
+{
+    String streamName = source->getRecordName(source->getActiveRecord());
+
+     /* Only use the original stream name (FileReader-100.example_data -> example_data) */
+    StringArray tokens;
+    tokens.addTokens (source->getRecordName(source->getActiveRecord()), ".");
+    if ( tokens.size() )
+        streamName = tokens[tokens.size()-1];
+
+    DataStream::Settings streamSettings{
+
+        streamName,
+        "A description of the File Reader Stream",
+        "identifier",
+        source->getActiveSampleRate()
+
+    };
+
+    LOGD("File Reader adding data stream ", streamName);
+
+    dataStreams.add(new DataStream(streamSettings));
+    dataStreams.getLast()->addProcessor(processorInfo.get());
+
+    for (int i = 0; i < channels.size(); i++)
+    {
+        ContinuousChannel::Settings channelSettings
+        {
+            ContinuousChannel::Type::ELECTRODE,
+            channels[i].name,
+            "description",
+            "filereader.stream",
+            channels[i].bitVolts, // BITVOLTS VALUE
+            dataStreams.getLast()
+        };
+
+        continuousChannels.add(new ContinuousChannel(channelSettings));
+        continuousChannels.getLast()->addProcessor(processorInfo.get());
+    }
+
+    EventChannel::Settings eventSettings{
+        EventChannel::Type::TTL,
+        "All TTL events",
+        "All TTL events loaded for this stream",
+        "filereader.events",
+        dataStreams.getLast()
+    };
+
+    EventChannel* events = new EventChannel(eventSettings);
+    String id = "sourceevent";
+    events->setIdentifier(id);
+    events->addProcessor(processorInfo.get());
+    eventChannels.add(events);
+}
+
 void FileReader::updateSettings()
 {
 
@@ -354,60 +621,18 @@ void FileReader::updateSettings()
         continuousChannels.clear();
         eventChannels.clear();
 
-        String streamName = input->getRecordName(input->getActiveRecord());
-
-         /* Only use the original stream name (FileReader-100.example_data -> example_data) */
-        StringArray tokens;
-        tokens.addTokens (input->getRecordName(input->getActiveRecord()), ".");
-        if ( tokens.size() )
-            streamName = tokens[tokens.size()-1];
-
-        DataStream::Settings streamSettings{
-
-            streamName,
-            "A description of the File Reader Stream",
-            "identifier",
-            getDefaultSampleRate()
-
-        };
-
-        LOGD("File Reader adding data stream.");
-
-        dataStreams.add(new DataStream(streamSettings));
-        dataStreams.getLast()->addProcessor(processorInfo.get());
+        /* The selected recording comes first, followed by the others in file order */
+        addStream (input.get(), channelInfo);
 
-        for (int i = 0; i < currentNumChannels; i++)
+        for (auto stream : secondaryStreams)
         {
-            ContinuousChannel::Settings channelSettings
-            {
-                ContinuousChannel::Type::ELECTRODE,
-                channelInfo[i].name,
-                "description",
-                "filereader.stream",
-                channelInfo[i].bitVolts, // BITVOLTS VALUE
-                dataStreams.getLast()
-            };
-
-            continuousChannels.add(new ContinuousChannel(channelSettings));
-            continuousChannels.getLast()->addProcessor(processorInfo.get());
-        }
+            Array<RecordedChannelInfo> info;
 
-        EventChannel* events;
+            for (int i = 0; i < stream->numChannels; i++)
+                info.add (stream->source->getChannelInfo (stream->source->getActiveRecord(), i));
 
-        EventChannel::Settings eventSettings{
-            EventChannel::Type::TTL,
-            "All TTL events",
-            "All TTL events loaded for the current input data source",
-            "filereader.events",
-            dataStreams.getLast()
-        };
-
-        //FIXME: Should add an event channel for each event channel detected in the current file source
-        events = new EventChannel(eventSettings);
-        String id = "sourceevent";
-        events->setIdentifier(id);
-        events->addProcessor(processorInfo.get());
-        eventChannels.add(events);
+            addStream (stream->source.get(), info);
+        }
 
         gotNewFile = false;
 
@@ -429,21 +654,61 @@ void FileReader::updateSettings()
     m_sysSampleRate = ads.sampleRate;
     m_bufferSize = ads.bufferSize;
     if (m_bufferSize == 0) m_bufferSize = 1024;
-    m_samplesPerBuffer.set(m_bufferSize * (getDefaultSampleRate() / m_sysSampleRate));
 
-    bufferA.malloc(currentNumChannels * m_bufferSize * BUFFER_WINDOW_CACHE_SIZE);
-    bufferB.malloc(currentNumChannels * m_bufferSize * BUFFER_WINDOW_CACHE_SIZE);
+    const double samplesPerBuffer = m_bufferSize * (getDefaultSampleRate() / m_sysSampleRate);
+    blocksPerPrefetch = jmax (1, int (readAheadTime * getDefaultSampleRate() / samplesPerBuffer / 2));
+
+    /* Secondary streams read their own number of samples per block, which must fit in the buffer */
+    for (auto stream : secondaryStreams)
+    {
+        const int maxSamplesPerBlock = int (std::ceil (samplesPerBuffer * stream->rateRatio));
+
+        if (maxSamplesPerBlock > int (m_bufferSize))
+        {
+            LOGE("File Reader: ", stream->source->getRecordName (stream->source->getActiveRecord()),
+                 " is sampled at ", stream->sampleRate, " Hz, above the audio device rate of ", m_sysSampleRate,
+                 " Hz, so its blocks do not fit in the buffer. Increase the device sample rate to play back this file.");
+
+            isEnabled = false;
+            return;
+        }
+    }
+
+    readAhead.clearSources();
+
+    directReads = input->canProvideDataViews();
+
+    int maxNumChannels = currentNumChannels;
+
+    for (auto stream : secondaryStreams)
+    {
+        directReads = directReads && stream->source->canProvideDataViews();
+        maxNumChannels = jmax (maxNumChannels, stream->numChannels);
+    }
+
+    channelPointers.malloc (maxNumChannels);
 
     /* Reset stream to start of playback */
-    input->seekTo(startSample);
     currentSample = startSample;
 
-    /* Pre-fills the front buffer with a blocking read */
-    readAndFillBufferCache(bufferA);
+    resetSecondaryStreams();
 
-    readBuffer = &bufferB;
     bufferCacheWindow = 0;
-    m_shouldFillBackBuffer.set(false);
+
+    /* Blocks are read from the mapped files when possible, so no cache is needed */
+    if (directReads)
+        return;
+
+    readAhead.addSource (input.get());
+
+    for (auto stream : secondaryStreams)
+        readAhead.addSource (stream->source.get());
+
+    readAhead.prepare (readAheadTime);
+
+    /* Pre-fills the start of playback with a blocking read */
+    updatePlayheads();
+    readAhead.prefill();
 
 }
 
@@ -480,6 +745,8 @@ String FileReader::handleConfigMessage(String msg)
         static_cast<FileReaderEditor*> (getEditor())->setPlaybackStartTime(std::stoi(tokens[1].toStdString()));
     else if (tokens[0] == "stop")
         static_cast<FileReaderEditor*> (getEditor())->setPlaybackStartTime(std::stoi(tokens[1].toStdString()));
+    else if (tokens[0] == "horizon")
+        setReadAheadTime(tokens[1].getFloatValue());
     else
         LOGD("Invalid key");
 
@@ -489,38 +756,58 @@ String FileReader::handleConfigMessage(String msg)
 void FileReader::process(AudioBuffer<float>& buffer)
 {
 
+    if (reachedEnd)
+    {
+        sendEmptyBlock();
+        return;
+    }
+
     bool switchNeeded = false;
 
     int samplesNeededPerBuffer = int (float (buffer.getNumSamples()) * (getDefaultSampleRate() / m_sysSampleRate));
 
-    if (!playbackActive && totalSamplesAcquired + samplesNeededPerBuffer > stopSample)
+    const bool stopAtEnd = !playbackActive || CoreServices::isFreeRunning();
+
+    if (stopAtEnd && totalSamplesAcquired + samplesNeededPerBuffer > stopSample)
     {
         samplesNeededPerBuffer = stopSample - totalSamplesAcquired;
         switchNeeded = true;
     }
-    else
-        m_samplesPerBuffer.set(samplesNeededPerBuffer);
     // FIXME: needs to account for the fact that the ratio might not be an exact
     //        integer value
     
-    // if cache window id == 0, we need to read and cache BUFFER_WINDOW_CACHE_SIZE more buffer windows
-    if (bufferCacheWindow == 0)
-    {
-        switchBuffer();
-    }
+    // direct reads only need a hint every so often; the scheduler follows the playheads by itself
+    if (directReads && bufferCacheWindow == 0)
+        prefetchWindows();
 
     //std::cout << "Reading " << samplesNeededPerBuffer << " samples. " << std::endl;
+
+    /* Nothing else paces a free-running graph, so it must not overtake the read-ahead */
+    const bool waitForData = CoreServices::isFreeRunning();
+
+    if (waitForData && !directReads && !waitForBlockData (samplesNeededPerBuffer))
+    {
+        // nothing is consumed, so the same data is read by the next block instead of zeros
+        numSkippedBlocks++;
+        sendEmptyBlock();
+        return;
+    }
     
-    for (int i = 0; i < currentNumChannels; ++i)
+    if (directReads)
+    {
+        readDirect(input.get(), currentSample, startSample, stopSample,
+                   buffer, 0, currentNumChannels, samplesNeededPerBuffer);
+    }
+    else if (samplesNeededPerBuffer > 0)
     {
-        // offset readBuffer index by current cache window count * buffer window size * num channels
-        input->processChannelData (*readBuffer + (samplesNeededPerBuffer * currentNumChannels * bufferCacheWindow),
-                                buffer.getWritePointer (i, 0),
-                                i,
-                                samplesNeededPerBuffer);
+        for (int i = 0; i < currentNumChannels; ++i)
+            channelPointers[i] = buffer.getWritePointer (i, 0);
+
+        readAhead.read(0, currentSample, startSample, stopSample,
+                       channelPointers, samplesNeededPerBuffer, waitForData);
     }
 
-    setTimestampAndSamples(totalSamplesAcquired, -1.0, samplesNeededPerBuffer, dataStreams[0]->getStreamId()); //TODO: Look at this
+    setTimestampAndSamples(totalSamplesAcquired + sampleNumberOffset, -1.0, samplesNeededPerBuffer, dataStreams[0]->getStreamId()); //TODO: Look at this
 
     int64 start = totalSamplesAcquired;
 
@@ -530,24 +817,111 @@ void FileReader::process(AudioBuffer<float>& buffer)
 
     int64 stop = totalSamplesAcquired;
 
-    addEventsInRange(start, stop);
+    addEventsInRange(input.get(), 0, start, stop);
+
+    /* Secondary streams read their own number of samples per block */
+    int channelOffset = currentNumChannels;
+
+    for (int s = 0; s < secondaryStreams.size(); s++)
+    {
+        SecondaryStream* stream = secondaryStreams[s];
+
+        // blocks differ by at most one sample, so the stream never drifts from the selected one
+        // (updateSettings() rejects streams whose blocks would not fit in the buffer)
+        const double exactSamples = jmax (0, samplesNeededPerBuffer) * stream->rateRatio + stream->fraction;
+        const int numSamples = int (exactSamples);
+        stream->fraction = exactSamples - numSamples;
+
+        jassert (numSamples <= buffer.getNumSamples());
+
+        readSecondary (s, buffer, channelOffset, numSamples, waitForData);
+
+        setTimestampAndSamples(stream->totalSamplesAcquired + stream->sampleNumberOffset, -1.0, numSamples, dataStreams[s + 1]->getStreamId());
+
+        // the stream has no events before its recording started
+        const int64 eventStart = jmax (int64 (0), stream->totalSamplesAcquired);
+        const int64 eventStop = stream->totalSamplesAcquired + numSamples;
+
+        if (eventStop > eventStart)
+            addEventsInRange(stream->source.get(), s + 1, eventStart, eventStop);
+
+        stream->totalSamplesAcquired += numSamples;
+        channelOffset += stream->numChannels;
+    }
 
     bufferCacheWindow += 1;
-    bufferCacheWindow %= BUFFER_WINDOW_CACHE_SIZE;
+    bufferCacheWindow %= blocksPerPrefetch;
 
     if (switchNeeded)
     {
         bufferCacheWindow = 0;
-        this->stopThread(100);
+
+        if (CoreServices::isFreeRunning())
+        {
+            LOGC("File Reader reached the end of playback; stopping acquisition.");
+
+            reachedEnd = true;
+            MessageManager::callAsync ([] { CoreServices::setAcquisitionStatus (false); });
+        }
     }
 
 }
 
-void FileReader::addEventsInRange(int64 start, int64 stop)
+bool FileReader::waitForBlockData (int samplesNeededPerBuffer)
 {
+    if (! readAhead.waitUntilLoaded (0, currentSample, startSample, stopSample, samplesNeededPerBuffer, 1000))
+        return false;
+
+    for (int s = 0; s < secondaryStreams.size(); s++)
+    {
+        SecondaryStream* stream = secondaryStreams[s];
+
+        // same number of samples as process() will read
+        int numSamples = int (jmax (0, samplesNeededPerBuffer) * stream->rateRatio + stream->fraction);
+
+        int64 recordedStart, recordedStop;
+        getRecordedRange (stream, recordedStart, recordedStop);
+
+        // only the recorded part of the block has to be loaded
+        int64 position = stream->currentSample;
+
+        if (position < recordedStart)
+        {
+            numSamples -= int (jmin (int64 (numSamples), recordedStart - position));
+            position = recordedStart;
+        }
+
+        if (numSamples > 0 && position < recordedStop
+            && ! readAhead.waitUntilLoaded (s + 1, position, recordedStart, recordedStop,
+                                            int (jmin (int64 (numSamples), recordedStop - position)), 1000))
+            return false;
+    }
+
+    return true;
+}
+
+void FileReader::sendEmptyBlock()
+{
+    setTimestampAndSamples(totalSamplesAcquired + sampleNumberOffset, -1.0, 0, dataStreams[0]->getStreamId());
+
+    for (int s = 0; s < secondaryStreams.size(); s++)
+        setTimestampAndSamples(secondaryStreams[s]->totalSamplesAcquired + secondaryStreams[s]->sampleNumberOffset,
+                               -1.0, 0, dataStreams[s + 1]->getStreamId());
+}
+
+void FileReader::addEventsInRange(FileSource* source, int streamIndex, int64 start, int64 stop)
+{
+
+    EventInfo& events = blockEvents;
+
+    const int64 offset = streamIndex == 0 ? sampleNumberOffset : secondaryStreams[streamIndex - 1]->sampleNumberOffset;
 
-    EventInfo events;
-    input->processEventData(events, start, stop);
+    events.channels.clear();
+    events.channelStates.clear();
+    events.timestamps.clear();
+    events.text.clear();
+
+    source->processEventData(events, start, stop);
 
     for (int i = 0; i < events.channels.size(); i++) 
     { 
@@ -555,6 +929,10 @@ void FileReader::addEventsInRange(int64 start, int64 stop)
         juce::int64 absoluteCurrentTimestamp = events.timestamps[i] + loopCount * (stopSample - startSample);
         if (events.text.size() && !events.text[i].isEmpty())
         {
+            /* Every source sees the same messages; only the selected one sends them */
+            if (streamIndex > 0)
+                continue;
+
             String msg = events.text[i];
             LOGD("Broadcasting message: ", msg, " at timestamp: ", absoluteCurrentTimestamp, " channel: ", events.channels[i]);
             broadcastMessage(msg);
@@ -563,12 +941,63 @@ void FileReader::addEventsInRange(int64 start, int64 stop)
         {
             uint8 ttlBit = events.channels[i];
             bool state = events.channelStates[i] > 0;
-            TTLEventPtr event = TTLEvent::createTTLEvent(eventChannels[0], events.timestamps[i], ttlBit, state);
+            TTLEventPtr event = TTLEvent::createTTLEvent(eventChannels[streamIndex], events.timestamps[i] + offset, ttlBit, state);
             addEvent(event, absoluteCurrentTimestamp); 
         }
     }
 }
 
+void FileReader::readDirect (FileSource* source, int64& position, int64 start, int64 stop,
+                             AudioBuffer<float>& buffer, int channelOffset, int numChannels, int numSamples,
+                             int bufferIndex)
+{
+    int samplesRead = 0;
+
+    while (samplesRead < numSamples)
+    {
+        if (stop <= start)
+        {
+            for (int i = 0; i < numChannels; ++i)
+                buffer.clear (channelOffset + i, bufferIndex + samplesRead, numSamples - samplesRead);
+
+            break;
+        }
+
+        // reached end of playback: resume from the start
+        if (position >= stop || position < start)
+            position = start;
+
+        const int samplesToRead = int (jmin (int64 (numSamples - samplesRead), stop - position));
+
+        for (int i = 0; i < numChannels; ++i)
+            channelPointers[i] = buffer.getWritePointer (channelOffset + i, bufferIndex + samplesRead);
+
+        if (const int16* data = source->getDataView (position, samplesToRead))
+        {
+            source->processBlockData (data, channelPointers, samplesToRead);
+        }
+        else
+        {
+            for (int i = 0; i < numChannels; ++i)
+                buffer.clear (channelOffset + i, bufferIndex + samplesRead, samplesToRead);
+        }
+
+        position += samplesToRead;
+        samplesRead += samplesToRead;
+    }
+}
+
+void FileReader::prefetchWindows()
+{
+    // hinted twice as often as the horizon is played, so the data ahead is always requested
+    const int horizonSamples = int (readAheadTime * currentSampleRate);
+
+    input->prefetch (currentSample, horizonSamples);
+
+    for (auto stream : secondaryStreams)
+        stream->source->prefetch (jmax (int64 (0), stream->currentSample), int (horizonSamples * stream->rateRatio) + 1);
+}
+
 void FileReader::setParameter (int parameterIndex, float newValue)
 {
     switch (parameterIndex)
@@ -606,88 +1035,6 @@ int64 FileReader::millisecondsToSamples (unsigned int ms) const
     return (int64) (currentSampleRate * float (ms) / 1000.f);
 }
 
-void FileReader::switchBuffer()
-{
-    if (readBuffer == &bufferA)
-        readBuffer = &bufferB;
-    else
-        readBuffer = &bufferA;
-    
-    m_shouldFillBackBuffer.set(true);
-    notify();
-}
-
-HeapBlock<int16>* FileReader::getFrontBuffer()
-{
-    return readBuffer;
-}
-
-HeapBlock<int16>* FileReader::getBackBuffer()
-{
-    if (readBuffer == &bufferA) return &bufferB;
-    
-    return &bufferA;
-}
-
-void FileReader::run()
-{
-    while (!threadShouldExit())
-    {
-        if (m_shouldFillBackBuffer.compareAndSetBool(false, true))
-        {
-            readAndFillBufferCache(*getBackBuffer());
-        }
-        
-        wait(30);
-    }
-}
-
-void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
-{
-
-    const int samplesNeededPerBuffer = m_samplesPerBuffer.get();
-    const int samplesNeeded = samplesNeededPerBuffer * BUFFER_WINDOW_CACHE_SIZE;
-    
-    int samplesRead = 0;
-    
-    // should only loop if reached end of file and resuming from start
-    while (samplesRead < samplesNeeded)
-    {
-        
-        if (samplesRead < 0)
-            return;
-
-        int samplesToRead = samplesNeeded - samplesRead;
-        
-        // if reached end of file stream
-        if ( (currentSample + samplesToRead) > stopSample)
-        {
-            samplesToRead = stopSample - currentSample;
-            if (samplesToRead > 0)
-                input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
-
-            if (startSample != 0)
-            {
-                startSample = 0;
-            }
-            
-            // reset stream to beginning
-            input->seekTo (startSample);
-            currentSample = startSample;
-
-        }
-        else // else read the block needed
-        {
-            input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
-            
-            currentSample += samplesToRead;
-        }
-        
-        samplesRead += samplesToRead;
-
-    }
-}
-
 StringArray FileReader::getSupportedExtensions() const
 {
 	StringArray extensions;
@@ -30,21 +30,25 @@
 
 #include "../GenericProcessor/GenericProcessor.h"
 #include "FileSource.h"
+#include "ReadAheadScheduler.h"
 
 #include "../../Utils/Utils.h"
 
 
-#define BUFFER_WINDOW_CACHE_SIZE 10
+#define DEFAULT_READ_AHEAD_SECONDS 2.0f
 
 
 /**
   Reads data from a file.
 
+  All recordings (streams) in the file are played back at the
+  same time, each at its own sample rate. The recording selected
+  in the editor drives the playback window; the others follow
+  it in proportion to their sample rates.
+
   @see GenericProcessor
 */
-class FileReader : 
-    public GenericProcessor,
-    private Thread
+class FileReader : public GenericProcessor
 {
 public:
 
@@ -135,16 +139,111 @@ public:
     /** Converts milliseconds to samples using current stream's sample rate */
     int64 millisecondsToSamples (unsigned int ms) const;
 
-        /** Swaps the backbuffer to the front and flags the background readerthread to update the new backbuffer */
-    void switchBuffer();
+    /** Sets how far ahead of playback data is read, in seconds (applied at the next update) */
+    void setReadAheadTime (float seconds);
+
+    /** Returns how far ahead of playback data is read, in seconds */
+    float getReadAheadTime() const;
+
+    /** Returns the number of blocks since the start of acquisition whose data had not been read in time */
+    int getNumUnderruns() const;
+
+    /** Returns the number of blocks skipped while free-running, because their data had not been read in time */
+    int getNumSkippedBlocks() const;
 
 private:
 
     /** Currently only support one event channel per stream */
     ScopedPointer<EventChannel> eventChannel;
 
+    /** A recording other than the selected one. Each has its own FileSource
+        (and therefore its own file mapping), and is read ahead by the same
+        scheduler as the selected recording. */
+    struct SecondaryStream
+    {
+        std::unique_ptr<FileSource> source;
+        int numChannels;
+        float sampleRate;
+
+        /** Sample rate relative to the selected recording */
+        double rateRatio;
+
+        /** Samples this stream recorded before the first sample of the selected recording
+            (negative if it started later), from the recordings' start sample numbers */
+        int64 startOffset;
+
+        /** Read position */
+        int64 currentSample;
+
+        /** Sample number of the next block sent downstream */
+        int64 totalSamplesAcquired;
+
+        /** Fractional samples carried over to the next block */
+        double fraction;
+
+        /** Added to sample numbers sent downstream (either the stream's first sample number, or
+            -startOffset, so that all streams share the selected recording's timeline) */
+        int64 sampleNumberOffset;
+    };
+
+    OwnedArray<SecondaryStream> secondaryStreams;
+
+    /** Adds a data stream, with its continuous channels and a TTL channel, for a recording */
+    void addStream (FileSource* source, const Array<RecordedChannelInfo>& channels);
+
+    /** Opens every recording other than the selected one */
+    void createSecondaryStreams();
+
+    /** Moves the secondary streams to the current playback start */
+    void resetSecondaryStreams();
+
+    /** Moves the read-ahead playheads of all streams to their current positions */
+    void updatePlayheads();
+
+    /** Converts a sample number of the selected recording into one of a secondary stream,
+        at the same time. The result may be outside the stream's recording. */
+    int64 toStreamSample (const SecondaryStream* stream, int64 sample) const;
+
+    /** Returns the part of the playback range that a secondary stream has recorded */
+    void getRecordedRange (const SecondaryStream* stream, int64& start, int64& stop) const;
+
+    /** Reads the next numSamples of a secondary stream into buffer channels [channelOffset,
+        channelOffset + numChannels). Samples outside the stream's recording are zero, so the
+        stream stays aligned with the selected one. */
+    void readSecondary (int streamIndex, AudioBuffer<float>& buffer, int channelOffset,
+                        int numSamples, bool waitForData);
+
+    /** Creates a FileSource for a file extension (nullptr if not supported) */
+    FileSource* createFileSource (const String& extension) const;
+
     /** Generates any events found within the current continuous buffer interval */
-    void addEventsInRange(int64 start, int64 stop);
+    void addEventsInRange(FileSource* source, int streamIndex, int64 start, int64 stop);
+
+    /** Converts numSamples samples, read straight from the source's data views, into
+        buffer channels [channelOffset, channelOffset + numChannels), starting at bufferIndex.
+        The position wraps from stop back to start. */
+    void readDirect (FileSource* source, int64& position, int64 start, int64 stop,
+                     AudioBuffer<float>& buffer, int channelOffset, int numChannels, int numSamples,
+                     int bufferIndex = 0);
+
+    /** Hints every source to page in the data within the read-ahead horizon */
+    void prefetchWindows();
+
+    /** True if every source provides data views, so that blocks are converted directly
+        from the file, without the read-ahead scheduler */
+    bool directReads;
+
+    /** Read-ahead horizon, in seconds */
+    float readAheadTime;
+
+    /** Number of blocks between two prefetch hints when reading directly */
+    int blocksPerPrefetch;
+
+    /** Output channel pointers for FileSource::processBlockData */
+    HeapBlock<float*> channelPointers;
+
+    /** Events found in the current block (reused, so its storage is only allocated once) */
+    EventInfo blockEvents;
 
     /** Flag if a new file has been loaded */
     bool gotNewFile;
@@ -161,34 +260,36 @@ private:
     int64 currentNumScrubbedSamples;
     int64 startSample;
     int64 stopSample;
-    int64 bufferCacheWindow; // the current buffer window to read from readBuffer
+    int64 bufferCacheWindow; // blocks since the last prefetch hint
     Array<RecordedChannelInfo> channelInfo;
     int64 loopCount;
     bool playbackActive;
 
     ScopedPointer<FileSource> input;
 
-    /* Pointer to current front buffer */
-    HeapBlock<int16> * readBuffer;      
-    HeapBlock<int16> bufferA;
-    HeapBlock<int16> bufferB;
+    /** Reads ahead for sources without data views (declared after the sources, so that it stops first) */
+    ReadAheadScheduler readAhead;
 
     HashMap<String, int> supportedExtensions;
-    
-    Atomic<int> m_shouldFillBackBuffer;
-    Atomic<int> m_samplesPerBuffer;
+
+    /** Added to sample numbers sent downstream (the recording's first sample number
+        when free-running, so that re-recorded data keeps its original sample numbers) */
+    int64 sampleNumberOffset;
+
+    /** Set once a free-running playback has reached the end of the file */
+    bool reachedEnd;
+
+    /** Returns false if the data for the next block of every stream is not loaded after a second */
+    bool waitForBlockData (int samplesNeededPerBuffer);
+
+    /** Sends a block without samples on every stream */
+    void sendEmptyBlock();
+
+    /** Blocks skipped while free-running (see waitForBlockData) */
+    std::atomic<int> numSkippedBlocks;
 
 	unsigned int m_bufferSize;
 	float m_sysSampleRate;
-    
-    HeapBlock<int16>* getFrontBuffer();
-    HeapBlock<int16>* getBackBuffer();
-    
-    /** Executes the background thread task */
-    void run() override;
-    
-    /** Reads a chunk of the file that fills an entire buffer cache. */
-    void readAndFillBufferCache(HeapBlock<int16> &cacheBuffer);
 
 	/** Returns the number of included file sources */
 	int getNumBuiltInFileSources() const;
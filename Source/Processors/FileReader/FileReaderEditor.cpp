@@ -358,11 +358,6 @@ void ZoomTimeline::mouseUp(const MouseEvent& event)
     rightSliderIsSelected = false;
     playbackRegionIsSelected = false;
 
-    if (fileReader->playbackIsActive())
-    {
-        fileReader->switchBuffer();
-    }
-
     static_cast<FileReaderEditor*>(fileReader->getEditor())->updatePlaybackTimes(); 
     
 }
@@ -732,8 +727,6 @@ void FileReaderEditor::buttonClicked (Button* button)
 void FileReaderEditor::updatePlaybackTimes()
 {
 
-    //fileReader->switchBuffer();
-
     int64 startTimestamp = float(getFullTimelineStartPosition()) / fullTimeline->getWidth() * fileReader->getCurrentNumTotalSamples();
     startTimestamp += float(getZoomTimelineStartPosition()) / zoomTimeline->getWidth() * fileReader->getCurrentSampleRate() * 30.0f;
     fileReader->setPlaybackStart(startTimestamp);
@@ -81,6 +81,12 @@ int64 FileSource::getRecordNumSamples (int index) const
 }
 
 
+int64 FileSource::getRecordStartTimestamp (int index) const
+{
+    return infoArray[index].startTimestamp;
+}
+
+
 int64 FileSource::getActiveNumSamples() const
 {
     return getRecordNumSamples (activeRecord.get());
@@ -146,3 +152,25 @@ bool FileSource::isReady()
     return true;
 }
 
+bool FileSource::canProvideDataViews() const
+{
+    return false;
+}
+
+const int16* FileSource::getDataView (int64 sample, int numSamples)
+{
+    return nullptr;
+}
+
+void FileSource::prefetch (int64 sample, int numSamples)
+{
+}
+
+void FileSource::processBlockData (const int16* inBuffer, float* const* outBuffers, int64 numSamples)
+{
+    const int numChannels = getActiveNumChannels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        processChannelData (const_cast<int16*> (inBuffer), outBuffers[channel], channel, numSamples);
+}
+
@@ -117,6 +117,9 @@ public:
     /** Returns the number of samples in a recording, by index */
     int64 getRecordNumSamples   (int index) const;
 
+    /** Returns the sample number of the first sample of a recording, by index */
+    int64 getRecordStartTimestamp (int index) const;
+
     /** Returns the sample rate of the recording that's currently being read in*/
     float getActiveSampleRate() const;
 
@@ -147,6 +150,29 @@ public:
     /** Keep track of how many times the recording has looped */
     int64 loopCount;
 
+    // ------------------------------------------------------------
+    //                     DATA VIEW METHODS
+    //       (can optionally be overriden by sub-classes)
+    // ------------------------------------------------------------
+
+    /** Return true if getDataView() can return pointers into the file itself
+        (e.g. a memory-mapped file). The File Reader then reads blocks directly,
+        without a cache or a reader thread. */
+    virtual bool canProvideDataViews() const;
+
+    /** Returns a pointer to numSamples interleaved samples of the active recording,
+        starting at a sample number, or nullptr if they are not available. The pointer
+        remains valid until the active recording changes. */
+    virtual const int16* getDataView (int64 sample, int numSamples);
+
+    /** Hints that a range of samples of the active recording will be read soon */
+    virtual void prefetch (int64 sample, int numSamples);
+
+    /** Converts numSamples of interleaved data for all channels to float, one output
+        array per channel. The default implementation calls processChannelData() for
+        each channel. */
+    virtual void processBlockData (const int16* inBuffer, float* const* outBuffers, int64 numSamples);
+
 protected:
 
     /** Holds the name of the current stream */
@@ -159,7 +185,7 @@ protected:
         Array<RecordedChannelInfo> channels;
         int64 numSamples;
         float sampleRate;
-        int64 startTimestamp;
+        int64 startTimestamp = 0;
     };
     Array<RecordInfo> infoArray;
 
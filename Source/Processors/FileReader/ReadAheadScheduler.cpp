@@ -0,0 +1,411 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ReadAheadScheduler.h"
+
+ReadAheadScheduler::ReadAheadScheduler()
+    : Thread ("File Reader read-ahead"),
+      useCounter (0),
+      numUnderruns (0)
+{
+
+}
+
+ReadAheadScheduler::~ReadAheadScheduler()
+{
+    stopThread (1000);
+}
+
+void ReadAheadScheduler::clearSources()
+{
+    stopThread (1000);
+
+    sources.clear();
+}
+
+void ReadAheadScheduler::addSource (FileSource* source)
+{
+    jassert (! isThreadRunning());
+
+    Source* s = new Source();
+    s->source = source;
+    s->numChannels = source->getActiveNumChannels();
+    s->numSamples = source->getActiveNumSamples();
+
+    sources.add (s);
+}
+
+void ReadAheadScheduler::prepare (float horizonSeconds)
+{
+    jassert (! isThreadRunning());
+
+    int maxNumChannels = 1;
+
+    for (auto s : sources)
+    {
+        const double horizonSamples = double (horizonSeconds) * s->source->getActiveSampleRate();
+
+        // one extra chunk, as the playhead is usually part-way through the first one
+        s->numAheadChunks = jmax (2, int (std::ceil (horizonSamples / READ_AHEAD_SAMPLES_PER_CHUNK)) + 1);
+
+        const int numChunks = 2 * s->numAheadChunks;
+
+        s->chunks.clear();
+
+        for (int i = 0; i < numChunks; i++)
+        {
+            Chunk* chunk = new Chunk();
+            chunk->data.malloc (READ_AHEAD_SAMPLES_PER_CHUNK * s->numChannels);
+            s->chunks.add (chunk);
+        }
+
+        maxNumChannels = jmax (maxNumChannels, s->numChannels);
+    }
+
+    outputPointers.malloc (maxNumChannels);
+}
+
+void ReadAheadScheduler::setPlayhead (int sourceIndex, int64 position, int64 start, int64 stop)
+{
+    if (Source* s = sources[sourceIndex])
+    {
+        const ScopedLock sl (lock);
+
+        s->playhead = position;
+        s->start = start;
+        s->stop = stop;
+    }
+
+    notify();
+}
+
+void ReadAheadScheduler::prefill()
+{
+    jassert (! isThreadRunning());
+
+    for (int i = 0; i < sources.size(); i++)
+        loadNextChunk();
+}
+
+void ReadAheadScheduler::read (int sourceIndex, int64& position, int64 start, int64 stop,
+                               float* const* outputs, int numSamples, bool waitForData)
+{
+    Source* s = sources[sourceIndex];
+
+    if (s == nullptr)
+        return;
+
+    const int64 previousChunk = position / READ_AHEAD_SAMPLES_PER_CHUNK;
+    bool underrun = false;
+    int samplesRead = 0;
+
+    while (samplesRead < numSamples)
+    {
+        if (stop <= start)
+        {
+            for (int c = 0; c < s->numChannels; c++)
+                FloatVectorOperations::clear (outputs[c] + samplesRead, numSamples - samplesRead);
+
+            break;
+        }
+
+        // reached end of playback: resume from the start
+        if (position >= stop || position < start)
+            position = start;
+
+        const int64 index = position / READ_AHEAD_SAMPLES_PER_CHUNK;
+        const int offset = int (position - index * READ_AHEAD_SAMPLES_PER_CHUNK);
+
+        const int samplesToRead = int (jmin (int64 (numSamples - samplesRead),
+                                             stop - position,
+                                             int64 (READ_AHEAD_SAMPLES_PER_CHUNK - offset)));
+
+        for (int c = 0; c < s->numChannels; c++)
+            outputPointers[c] = outputs[c] + samplesRead;
+
+        bool converted = false;
+
+        while (true)
+        {
+            {
+                const ScopedLock sl (lock);
+
+                Chunk* chunk = findChunk (*s, index);
+
+                if (chunk != nullptr && chunk->numSamples >= offset + samplesToRead)
+                {
+                    chunk->lastUsed = ++useCounter;
+
+                    s->source->processBlockData (chunk->data + offset * s->numChannels,
+                                                 outputPointers,
+                                                 samplesToRead);
+                    converted = true;
+                }
+                else
+                {
+                    s->playhead = position;
+                    s->start = start;
+                    s->stop = stop;
+                }
+            }
+
+            if (converted || ! waitForData || ! isThreadRunning())
+                break;
+
+            notify();
+
+            if (! chunkLoaded.wait (1000))
+                break;
+        }
+
+        if (! converted)
+        {
+            for (int c = 0; c < s->numChannels; c++)
+                FloatVectorOperations::clear (outputPointers[c], samplesToRead);
+
+            underrun = true;
+        }
+
+        position += samplesToRead;
+        samplesRead += samplesToRead;
+    }
+
+    {
+        const ScopedLock sl (lock);
+
+        s->playhead = position;
+        s->start = start;
+        s->stop = stop;
+    }
+
+    if (underrun)
+        numUnderruns++;
+
+    if (underrun || position / READ_AHEAD_SAMPLES_PER_CHUNK != previousChunk)
+        notify();
+}
+
+bool ReadAheadScheduler::waitUntilLoaded (int sourceIndex, int64 position, int64 start, int64 stop,
+                                          int numSamples, int timeoutMs)
+{
+    Source* s = sources[sourceIndex];
+
+    if (s == nullptr)
+        return true;
+
+    const uint32 endTime = Time::getMillisecondCounter() + uint32 (timeoutMs);
+
+    while (true)
+    {
+        {
+            const ScopedLock sl (lock);
+
+            if (isLoaded (*s, position, start, stop, numSamples))
+                return true;
+
+            s->playhead = position;
+            s->start = start;
+            s->stop = stop;
+        }
+
+        const int remaining = int (endTime - Time::getMillisecondCounter());
+
+        if (remaining <= 0 || ! isThreadRunning())
+            return false;
+
+        notify();
+        chunkLoaded.wait (remaining);
+    }
+}
+
+bool ReadAheadScheduler::isLoaded (Source& source, int64 position, int64 start, int64 stop, int numSamples)
+{
+    // follows the same path through the loop range as read()
+    while (numSamples > 0 && stop > start)
+    {
+        if (position >= stop || position < start)
+            position = start;
+
+        const int64 index = position / READ_AHEAD_SAMPLES_PER_CHUNK;
+        const int offset = int (position - index * READ_AHEAD_SAMPLES_PER_CHUNK);
+
+        const int samplesToRead = int (jmin (int64 (numSamples),
+                                             stop - position,
+                                             int64 (READ_AHEAD_SAMPLES_PER_CHUNK - offset)));
+
+        const Chunk* chunk = findChunk (source, index);
+
+        if (chunk == nullptr || chunk->numSamples < offset + samplesToRead)
+            return false;
+
+        position += samplesToRead;
+        numSamples -= samplesToRead;
+    }
+
+    return true;
+}
+
+int ReadAheadScheduler::getNumUnderruns() const
+{
+    return numUnderruns.load();
+}
+
+void ReadAheadScheduler::resetUnderruns()
+{
+    numUnderruns = 0;
+}
+
+void ReadAheadScheduler::run()
+{
+    while (! threadShouldExit())
+    {
+        // woken by read(), setPlayhead() or stopThread()
+        if (! loadNextChunk())
+            wait (-1);
+    }
+}
+
+ReadAheadScheduler::Chunk* ReadAheadScheduler::findChunk (Source& source, int64 index)
+{
+    for (auto chunk : source.chunks)
+    {
+        if (chunk->index == index)
+            return chunk;
+    }
+
+    return nullptr;
+}
+
+int64 ReadAheadScheduler::getChunkAhead (const Source& source, int distance)
+{
+    const int64 stop = jmin (source.stop, source.numSamples);
+
+    if (stop <= source.start || distance >= source.numAheadChunks)
+        return -1;
+
+    const int64 playhead = (source.playhead >= source.start && source.playhead < stop) ? source.playhead : source.start;
+
+    const int64 firstChunk = playhead / READ_AHEAD_SAMPLES_PER_CHUNK;
+    const int64 startChunk = source.start / READ_AHEAD_SAMPLES_PER_CHUNK;
+    const int64 lastChunk = (stop - 1) / READ_AHEAD_SAMPLES_PER_CHUNK;
+
+    if (firstChunk + distance <= lastChunk)
+        return firstChunk + distance;
+
+    // continue from the start of the loop
+    return startChunk + (distance - (lastChunk - firstChunk + 1)) % (lastChunk - startChunk + 1);
+}
+
+bool ReadAheadScheduler::isWithinHorizon (const Source& source, int64 index)
+{
+    for (int distance = 0; distance < source.numAheadChunks; distance++)
+    {
+        if (getChunkAhead (source, distance) == index)
+            return true;
+    }
+
+    return false;
+}
+
+bool ReadAheadScheduler::loadNextChunk()
+{
+    Source* target = nullptr;
+    Chunk* chunk = nullptr;
+    int64 index = -1;
+
+    {
+        const ScopedLock sl (lock);
+
+        int maxAheadChunks = 0;
+
+        for (auto s : sources)
+            maxAheadChunks = jmax (maxAheadChunks, s->numAheadChunks);
+
+        // nearest chunks first, alternating between sources
+        for (int distance = 0; distance < maxAheadChunks && target == nullptr; distance++)
+        {
+            for (auto s : sources)
+            {
+                const int64 candidate = getChunkAhead (*s, distance);
+
+                if (candidate >= 0 && findChunk (*s, candidate) == nullptr)
+                {
+                    target = s;
+                    index = candidate;
+                    break;
+                }
+            }
+        }
+
+        if (target == nullptr)
+            return false;
+
+        // an empty chunk, or else the least recently used one outside the horizon
+        for (auto c : target->chunks)
+        {
+            if (c->index < 0)
+            {
+                chunk = c;
+                break;
+            }
+
+            if ((chunk == nullptr || c->lastUsed < chunk->lastUsed) && ! isWithinHorizon (*target, c->index))
+                chunk = c;
+        }
+
+        if (chunk == nullptr)
+            return false;
+
+        chunk->index = -1;
+    }
+
+    const int64 firstSample = index * READ_AHEAD_SAMPLES_PER_CHUNK;
+    const int samplesNeeded = int (jmin (int64 (READ_AHEAD_SAMPLES_PER_CHUNK), target->numSamples - firstSample));
+
+    target->source->seekTo (firstSample);
+
+    int samplesRead = 0;
+
+    while (samplesRead < samplesNeeded)
+    {
+        const int samples = target->source->readData (chunk->data + samplesRead * target->numChannels,
+                                                      samplesNeeded - samplesRead);
+
+        if (samples <= 0)
+            break;
+
+        samplesRead += samples;
+    }
+
+    {
+        const ScopedLock sl (lock);
+
+        chunk->index = index;
+        chunk->numSamples = samplesRead;
+        chunk->lastUsed = ++useCounter;
+    }
+
+    chunkLoaded.signal();
+
+    return true;
+}
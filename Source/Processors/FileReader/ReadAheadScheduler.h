@@ -0,0 +1,149 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef READAHEADSCHEDULER_H_INCLUDED
+#define READAHEADSCHEDULER_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "FileSource.h"
+
+#include <atomic>
+
+#define READ_AHEAD_SAMPLES_PER_CHUNK 4096
+
+/**
+
+    Reads ahead of playback for FileSources that cannot provide data views.
+
+    Each source is cached in fixed-size chunks of samples. A background thread
+    keeps every chunk within the read-ahead horizon of each source's playhead
+    loaded, and sleeps until a playhead moves. Chunks that have already been
+    played stay in the cache until they are the least recently used, so that
+    returning to a recently visited region does not touch the file again.
+
+*/
+class ReadAheadScheduler : public Thread
+{
+public:
+
+    /** Constructor */
+    ReadAheadScheduler();
+
+    /** Destructor */
+    ~ReadAheadScheduler();
+
+    /** Stops the thread and removes all sources */
+    void clearSources();
+
+    /** Adds a source; the reader thread must be stopped */
+    void addSource (FileSource* source);
+
+    /** Allocates the cache of every source for a read-ahead horizon, in seconds.
+        The chunks of recently visited regions get the same amount of space. */
+    void prepare (float horizonSeconds);
+
+    /** Moves the playhead and loop range of a source, and wakes the reader thread */
+    void setPlayhead (int sourceIndex, int64 position, int64 start, int64 stop);
+
+    /** Loads the first chunk ahead of every playhead, without the reader thread */
+    void prefill();
+
+    /** Converts numSamples from the cache of a source into one output array per channel.
+        The position advances, wrapping from stop back to start. Samples that are not
+        loaded yet are zero-filled and counted as an underrun, unless waitForData is
+        true, in which case the reader thread is given up to a second to load them. */
+    void read (int sourceIndex, int64& position, int64 start, int64 stop,
+               float* const* outputs, int numSamples, bool waitForData);
+
+    /** Moves the playhead of a source, and waits for up to timeoutMs until the next
+        numSamples are loaded. Returns false if they are still missing. */
+    bool waitUntilLoaded (int sourceIndex, int64 position, int64 start, int64 stop,
+                          int numSamples, int timeoutMs);
+
+    /** Returns the number of blocks that were not (fully) loaded when they were read */
+    int getNumUnderruns() const;
+
+    /** Resets the underrun counter */
+    void resetUnderruns();
+
+    /** Loads chunks until the horizon of every playhead is cached */
+    void run() override;
+
+private:
+
+    struct Chunk
+    {
+        HeapBlock<int16> data;
+
+        /** Index of the chunk within the recording (-1 if empty) */
+        int64 index = -1;
+        int numSamples = 0;
+        uint32 lastUsed = 0;
+    };
+
+    struct Source
+    {
+        FileSource* source;
+        int numChannels;
+        int64 numSamples;
+        int numAheadChunks = 0;
+
+        OwnedArray<Chunk> chunks;
+
+        int64 playhead = 0;
+        int64 start = 0;
+        int64 stop = 0;
+    };
+
+    /** Returns the loaded chunk with an index, or nullptr */
+    static Chunk* findChunk (Source& source, int64 index);
+
+    /** Returns the index of the chunk a number of chunks ahead of the playhead (-1 if none) */
+    static int64 getChunkAhead (const Source& source, int distance);
+
+    /** Returns true if a chunk is within the read-ahead horizon of its source */
+    static bool isWithinHorizon (const Source& source, int64 index);
+
+    /** Returns true if every chunk needed to read numSamples from a position is loaded */
+    static bool isLoaded (Source& source, int64 position, int64 start, int64 stop, int numSamples);
+
+    /** Loads the missing chunk nearest to any playhead; returns false if there is none */
+    bool loadNextChunk();
+
+    OwnedArray<Source> sources;
+
+    /** Protects the chunk indices and playheads */
+    CriticalSection lock;
+
+    /** Signalled whenever a chunk has been loaded */
+    WaitableEvent chunkLoaded;
+
+    HeapBlock<float*> outputPointers;
+
+    uint32 useCounter;
+    std::atomic<int> numUnderruns;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReadAheadScheduler);
+};
+
+#endif  // READAHEADSCHEDULER_H_INCLUDED
@@ -63,6 +63,7 @@ GenericProcessor::GenericProcessor(const String& name)
 	, sendSampleCount(true)
 	, m_name(name)
 	, m_paramsWereLoaded(false)
+	, processingObserver(nullptr)
 
 {
 	latencyMeter = std::make_unique<LatencyMeter>(this);
@@ -396,7 +397,23 @@ void GenericProcessor::parameterChangeRequest(Parameter* param)
 
 	setParameter(-1, 0.0f);
 
-	getEditor()->updateView();
+	param->notifyListeners();
+
+	if (editorUpdatesDeferred)
+		editorNeedsUpdate = true;
+	else
+		getEditor()->updateView();
+}
+
+void GenericProcessor::setEditorUpdatesDeferred(bool shouldDefer)
+{
+	editorUpdatesDeferred = shouldDefer;
+
+	if (!shouldDefer && editorNeedsUpdate)
+	{
+		editorNeedsUpdate = false;
+		getEditor()->updateView();
+	}
 }
 
 void GenericProcessor::setParameter(int parameterIndex, float newValue)
@@ -555,6 +572,75 @@ void GenericProcessor::setStreamEnabled(uint16 streamId, bool isEnabled)
     getDataStream(streamId)->getParameter("enable_stream")->setNextValue(isEnabled);
 }
 
+void GenericProcessor::addStreamParameters(DataStream* stream)
+{
+    for (auto param : availableParameters)
+    {
+        if (param->getScope() == Parameter::STREAM_SCOPE)
+        {
+            if (param->getType() == Parameter::BOOLEAN_PARAM)
+            {
+                BooleanParameter* p = (BooleanParameter*)param;
+                p->setDataStream(stream);
+                stream->addParameter(new BooleanParameter(*p));
+            }
+            else if (param->getType() == Parameter::STRING_PARAM)
+            {
+                StringParameter* p = (StringParameter*)param;
+                p->setDataStream(stream);
+                stream->addParameter(new StringParameter(*p));
+            }
+            else if (param->getType() == Parameter::INT_PARAM)
+            {
+                IntParameter* p = (IntParameter*)param;
+                p->setDataStream(stream);
+                stream->addParameter(new IntParameter(*p));
+            }
+            else if (param->getType() == Parameter::FLOAT_PARAM)
+            {
+                FloatParameter* p = (FloatParameter*)param;
+                p->setDataStream(stream);
+                stream->addParameter(new FloatParameter(*p));
+            }
+            else if (param->getType() == Parameter::CATEGORICAL_PARAM)
+            {
+                CategoricalParameter* p = (CategoricalParameter*)param;
+                p->setDataStream(stream);
+                stream->addParameter(new CategoricalParameter(*p));
+            }
+            else if (param->getType() == Parameter::SELECTED_CHANNELS_PARAM)
+            {
+                SelectedChannelsParameter* p = (SelectedChannelsParameter*)param;
+                SelectedChannelsParameter* p2 = new SelectedChannelsParameter(this,
+                                                                      p->getScope(),
+                                                                      p->getName(),
+                                                                      p->getDescription(),
+                                                                      p->getValue(),
+                                                                      p->getMaxSelectableChannels(),
+                                                                      p->shouldDeactivateDuringAcquisition());
+                
+                p2->setChannelCount(stream->getChannelCount());
+                p2->setDataStream(stream);
+                //LOGD("GenericProcessor::update() Adding SelectedChannelsParameter to stream ", stream->getStreamId(), " with ", stream->getChannelCount(), " channels");
+
+                stream->addParameter(p2);
+            }
+            else if (param->getType() == Parameter::MASK_CHANNELS_PARAM)
+            {
+                MaskChannelsParameter* p = (MaskChannelsParameter*)param;
+                MaskChannelsParameter* p2 = new MaskChannelsParameter(this,
+                                                                      p->getScope(),
+                                                                      p->getName(),
+                                                                      p->getDescription(),
+                                                                      p->shouldDeactivateDuringAcquisition());
+                p2->setChannelCount(stream->getChannelCount());
+                p2->setDataStream(stream);
+                stream->addParameter(p2);
+            }
+        }
+    }
+}
+
 int GenericProcessor::findMatchingStreamParameters(DataStream* stream)
 {
 
@@ -819,8 +905,17 @@ void GenericProcessor::update()
 
 	clearSettings();
 
-	processorInfo.reset();
-	processorInfo = std::unique_ptr<ProcessorInfoObject>(new ProcessorInfoObject(this));
+	// The info object is only replaced when it changes, because downstream
+	// processors that ProcessorGraph::updateSettings() skips still point to it
+	std::unique_ptr<ProcessorInfoObject> info = std::make_unique<ProcessorInfoObject>(this);
+
+	if (processorInfo == nullptr
+		|| processorInfo->getNodeId() != info->getNodeId()
+		|| processorInfo->getName() != info->getName()
+		|| processorInfo->getType() != info->getType())
+	{
+		processorInfo = std::move(info);
+	}
    
     if (!isMerger()) // only has one source
     {
@@ -911,73 +1006,7 @@ void GenericProcessor::update()
 
         if (stream->numParameters() == 0)
         {
-            //std::cout << "No parameters found, adding..." << std::endl;
-            
-            for (auto param : availableParameters)
-            {
-                if (param->getScope() == Parameter::STREAM_SCOPE)
-                {
-                    if (param->getType() == Parameter::BOOLEAN_PARAM)
-                    {
-                        BooleanParameter* p = (BooleanParameter*)param;
-                        p->setDataStream(stream);
-                        stream->addParameter(new BooleanParameter(*p));
-                    }
-                    else if (param->getType() == Parameter::STRING_PARAM)
-                    {
-                        StringParameter* p = (StringParameter*)param;
-                        p->setDataStream(stream);
-                        stream->addParameter(new StringParameter(*p));
-                    }
-                    else if (param->getType() == Parameter::INT_PARAM)
-                    {
-                        IntParameter* p = (IntParameter*)param;
-                        p->setDataStream(stream);
-                        stream->addParameter(new IntParameter(*p));
-                    }
-                    else if (param->getType() == Parameter::FLOAT_PARAM)
-                    {
-                        FloatParameter* p = (FloatParameter*)param;
-                        p->setDataStream(stream);
-                        stream->addParameter(new FloatParameter(*p));
-                    }
-                    else if (param->getType() == Parameter::CATEGORICAL_PARAM)
-                    {
-                        CategoricalParameter* p = (CategoricalParameter*)param;
-                        p->setDataStream(stream);
-                        stream->addParameter(new CategoricalParameter(*p));
-                    }
-                    else if (param->getType() == Parameter::SELECTED_CHANNELS_PARAM)
-                    {
-                        SelectedChannelsParameter* p = (SelectedChannelsParameter*)param;
-                        SelectedChannelsParameter* p2 = new SelectedChannelsParameter(this,
-                                                                              p->getScope(),
-                                                                              p->getName(),
-                                                                              p->getDescription(),
-                                                                              p->getValue(),
-                                                                              p->getMaxSelectableChannels(),
-                                                                              p->shouldDeactivateDuringAcquisition());
-                        
-                        p2->setChannelCount(stream->getChannelCount());
-                        p2->setDataStream(stream);
-                        //LOGD("GenericProcessor::update() Adding SelectedChannelsParameter to stream ", stream->getStreamId(), " with ", stream->getChannelCount(), " channels");
-
-                        stream->addParameter(p2);
-                    }
-                    else if (param->getType() == Parameter::MASK_CHANNELS_PARAM)
-                    {
-                        MaskChannelsParameter* p = (MaskChannelsParameter*)param;
-                        MaskChannelsParameter* p2 = new MaskChannelsParameter(this,
-                                                                              p->getScope(),
-                                                                              p->getName(),
-                                                                              p->getDescription(),
-                                                                              p->shouldDeactivateDuringAcquisition());
-                        p2->setChannelCount(stream->getChannelCount());
-                        p2->setDataStream(stream);
-                        stream->addParameter(p2);
-                    }
-                }
-            }
+            addStreamParameters(stream);
         }
         else
         {
@@ -1076,9 +1105,161 @@ void GenericProcessor::update()
 
 	editor->update(isEnabled); // allow the editor to update its settings
 
+	settingsFingerprint = computeSettingsFingerprint();
+	inputFingerprint = (sourceNode != nullptr) ? sourceNode->getSettingsFingerprint() : 0;
+
     LOGG("    TOTAL TIME: ", MS_FROM_START, " milliseconds");
 }
 
+namespace
+{
+	/** Accumulates a 64-bit FNV-1a hash of processor settings */
+	class SettingsHasher
+	{
+	public:
+		void addBytes(const void* data, size_t numBytes)
+		{
+			const uint8* bytes = static_cast<const uint8*>(data);
+
+			for (size_t i = 0; i < numBytes; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+		}
+
+		template<typename T>
+		void addValue(T value)
+		{
+			addBytes(&value, sizeof(T));
+		}
+
+		void addString(const String& text)
+		{
+			addBytes(text.toRawUTF8(), text.getNumBytesAsUTF8() + 1);
+		}
+
+		/** Adds the fields an InfoObject carries downstream. Pointers to
+		    upstream objects are included by identity, so that a processor
+		    that recreates them invalidates its downstream copies. */
+		void addInfoObject(const InfoObject* object)
+		{
+			addValue((int) object->getType());
+			addString(object->getName());
+			addString(object->getDescription());
+			addString(object->getIdentifier());
+			addString(object->getHistoryString());
+			addValue(object->getNodeId());
+			addString(object->getNodeName());
+			addValue(object->getSourceNodeId());
+			addString(object->getSourceNodeName());
+			addValue(object->getLocalIndex());
+			addValue(object->getGlobalIndex());
+
+			addString(object->group.name);
+			addValue(object->group.number);
+			addValue(object->position.x);
+			addValue(object->position.y);
+			addValue(object->position.z);
+			addString(object->position.description);
+
+			for (auto processor : object->processorChain)
+				addValue(processor);
+
+			for (int i = 0; i < object->getMetadataCount(); i++)
+			{
+				const MetadataDescriptor* descriptor = object->getMetadataDescriptor(i);
+				const MetadataValue* value = object->getMetadataValue(i);
+
+				addString(descriptor->getIdentifier());
+				addValue((int) descriptor->getType());
+				addValue(descriptor->getLength());
+				addBytes(value->getRawValuePointer(), value->getDataSize());
+			}
+		}
+
+		int64 getHash() const { return (int64) hash; }
+
+	private:
+		uint64 hash = 14695981039346656037ull;
+	};
+}
+
+int64 GenericProcessor::computeSettingsFingerprint() const
+{
+	SettingsHasher hasher;
+
+	hasher.addValue(isEnabled);
+
+	if (messageChannel != nullptr)
+		hasher.addInfoObject(messageChannel.get());
+
+	for (auto configurationObject : configurationObjects)
+	{
+		hasher.addInfoObject(configurationObject);
+		hasher.addValue(configurationObject->getSource());
+	}
+
+	for (auto stream : dataStreams)
+	{
+		hasher.addInfoObject(stream);
+		hasher.addValue(stream->getStreamId());
+		hasher.addValue(stream->getSampleRate());
+		hasher.addValue(stream->getChannelCount());
+		hasher.addValue(stream->device);
+
+		for (auto channel : stream->getContinuousChannels())
+		{
+			hasher.addInfoObject(channel);
+			hasher.addValue(channel->getBitVolts());
+			hasher.addString(channel->getUnits());
+			hasher.addValue((int) channel->getChannelType());
+			hasher.addValue(channel->isRecorded);
+		}
+
+		for (auto channel : stream->getEventChannels())
+		{
+			hasher.addInfoObject(channel);
+			hasher.addValue((int) channel->getType());
+			hasher.addValue((int) channel->getBinaryDataType());
+			hasher.addValue(channel->getLength());
+			hasher.addValue(channel->getMaxTTLBits());
+			hasher.addValue(channel->isRecorded);
+
+			for (int i = 0; i < channel->getEventMetadataCount(); i++)
+				hasher.addString(channel->getEventMetadataDescriptor(i)->getIdentifier());
+		}
+
+		for (auto channel : stream->getSpikeChannels())
+		{
+			hasher.addInfoObject(channel);
+			hasher.addValue((int) channel->getChannelType());
+			hasher.addValue(channel->getPrePeakSamples());
+			hasher.addValue(channel->getPostPeakSamples());
+			hasher.addValue(channel->getNumChannels());
+			hasher.addValue(channel->isRecorded);
+
+			for (auto source : channel->getSourceChannels())
+				hasher.addValue(source != nullptr ? source->getLocalIndex() : -1);
+		}
+	}
+
+	return hasher.getHash();
+}
+
+int64 GenericProcessor::getSettingsFingerprint() const
+{
+	return settingsFingerprint;
+}
+
+bool GenericProcessor::hasStaleInputs() const
+{
+	if (sourceNode == nullptr)
+		return false;
+
+	return sourceNode->getSettingsFingerprint() != inputFingerprint;
+}
+
 void GenericProcessor::updateChannelIndexMaps()
 {
 	continuousChannelMap.clear();
@@ -1134,6 +1315,9 @@ void GenericProcessor::updateChannelIndexMaps()
 		dataStreamMap[streamId] = stream;
 	}
 	
+    for (auto stream : dataStreams)
+        ttlWords[stream->getStreamId()];
+
     if (latencyMeter != nullptr)
         latencyMeter->update(getDataStreams());
 }
@@ -1245,7 +1429,7 @@ int GenericProcessor::processEventBuffer()
                 uint8 eventBit = *reinterpret_cast<const uint8*>(dataptr + 24);
                 bool eventState = *reinterpret_cast<const bool*>(dataptr + 25);
                 
-                getEditor()->setTTLState(sourceStreamId, eventBit, eventState);
+                updateTTLWord(sourceStreamId, eventBit, eventState);
                 
             } else if (static_cast<Event::Type> (*dataptr) == Event::Type::PROCESSOR_EVENT
             && static_cast<EventChannel::Type>(*(dataptr + 1) == EventChannel::Type::TEXT))
@@ -1336,9 +1520,7 @@ void GenericProcessor::addEvent(const Event* event, int sampleNum)
             
             const uint8* dataptr = reinterpret_cast<const uint8*>(event->getRawDataPointer());
             
-            getEditor()->setTTLState(event->getStreamId(),
-                                     *(dataptr),
-                                     *(dataptr+1));
+            updateTTLWord(event->getStreamId(), *(dataptr), *(dataptr+1));
         }
     }
     
@@ -1445,10 +1627,54 @@ void GenericProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& even
 	processEventBuffer(); // extract buffer sizes and timestamps,
 
 	process(buffer);
+
+	publishTTLWords();
     
 	latencyMeter->setLatestLatency(processStartTimes);
 }
 
+void GenericProcessor::updateTTLWord(uint16 streamId, int bit, bool state)
+{
+    if (bit < 0 || bit >= 64)
+        return;
+
+    auto it = ttlWords.find(streamId);
+
+    if (it == ttlWords.end())
+        return;
+
+    const uint64 mask = uint64(1) << bit;
+
+    if (state)
+        it->second.word |= mask;
+    else
+        it->second.word &= ~mask;
+
+    it->second.changed = true;
+}
+
+void GenericProcessor::publishTTLWords()
+{
+    for (auto& entry : ttlWords)
+    {
+        if (entry.second.changed)
+        {
+            entry.second.published.store(entry.second.word, std::memory_order_relaxed);
+            entry.second.changed = false;
+        }
+    }
+}
+
+uint64 GenericProcessor::getTTLWord(uint16 streamId) const
+{
+    auto it = ttlWords.find(streamId);
+
+    if (it == ttlWords.end())
+        return 0;
+
+    return it->second.published.load(std::memory_order_relaxed);
+}
+
 Array<const EventChannel*> GenericProcessor::getEventChannels()
 {
 	Array<const EventChannel*> channels;
@@ -1970,6 +2196,17 @@ int GenericProcessor::getNumDataStreams() const { return dataStreams.size(); }
 
 GenericEditor* GenericProcessor::getEditor() const { return editor.get(); }
 
+void GenericProcessor::setProcessingObserver(ProcessingObserver* observer) { processingObserver = observer; }
+ProcessingObserver* GenericProcessor::getProcessingObserver() const       { return processingObserver.load(); }
+
+float GenericProcessor::getMeanLatency(uint16 streamId) const
+{
+	if (latencyMeter == nullptr)
+		return 0.0f;
+
+	return latencyMeter->getMeanLatency(streamId);
+}
+
 AudioBuffer<float>* GenericProcessor::getContinuousBuffer() const { return 0; }
 MidiBuffer* GenericProcessor::getEventBuffer() const             { return 0; }
 
@@ -2009,12 +2246,26 @@ LatencyMeter::LatencyMeter(GenericProcessor* processor_)
 void LatencyMeter::update(Array<const DataStream*>dataStreams)
 {
 	latencies.clear();
+	meanLatencies.clear();
 
 	for (auto dataStream : dataStreams)
+	{
 		latencies[dataStream->getStreamId()].insertMultiple(0, 0, 5);
+		meanLatencies[dataStream->getStreamId()] = 0.0f;
+	}
 
 }
 
+float LatencyMeter::getMeanLatency(uint16 streamId) const
+{
+	auto it = meanLatencies.find(streamId);
+
+	if (it == meanLatencies.end())
+		return 0.0f;
+
+	return it->second.load();
+}
+
 void LatencyMeter::setLatestLatency(std::map<uint16, juce::int64>& processStartTimes)
 {
 
@@ -2047,7 +2298,13 @@ void LatencyMeter::setLatestLatency(std::map<uint16, juce::int64>& processStartT
 					/ float(Time::getHighResolutionTicksPerSecond())
 					* 1000.0f;
 
-				processor->getEditor()->setMeanLatencyMs(it->first, totalLatency);
+				auto mean = meanLatencies.find(it->first);
+
+				if (mean != meanLatencies.end())
+					mean->second = totalLatency;
+
+				if (ProcessingObserver* observer = processor->getProcessingObserver())
+					observer->meanLatencyChanged(it->first, totalLatency);
 
 				it++;
 
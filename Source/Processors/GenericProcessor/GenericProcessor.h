@@ -43,6 +43,9 @@
 #include "../Events/Event.h"
 #include "../Events/Spike.h"
 
+#include "ProcessingObserver.h"
+
+#include <atomic>
 #include <time.h>
 #include <stdio.h>
 #include <map>
@@ -136,6 +139,21 @@ public:
     /** Returns a pointer to the processor's editor. */
     GenericEditor* getEditor() const;
 
+    /** Sets the object that is notified by the processing path (nullptr to detach).*/
+    void setProcessingObserver(ProcessingObserver* observer);
+
+    /** Returns the object that is notified by the processing path (may be nullptr).*/
+    ProcessingObserver* getProcessingObserver() const;
+
+    /** Returns the most recent mean processing latency of a data stream (in ms),
+        or 0 if none has been measured yet. Safe to call from any thread.*/
+    float getMeanLatency(uint16 streamId) const;
+
+    /** Returns the state of the TTL lines of a data stream at the end of the most
+        recent block (bit n = line n, lines 64 and above are not tracked).
+        Safe to call from any thread.*/
+    uint64 getTTLWord(uint16 streamId) const;
+
     /** Returns the sample rate for a given data stream.*/
     virtual float getSampleRate(int streamIndex) const;
 
@@ -349,6 +367,10 @@ public:
     /** Initiates parameter value update */
     void parameterChangeRequest(Parameter*);
 
+    /** While deferred, parameter changes do not refresh the editor; it is refreshed
+        once when updates are no longer deferred (used to apply many changes at once) */
+    void setEditorUpdatesDeferred(bool shouldDefer);
+
     /** Called when a parameter value is updated, to allow plugin-specific responses*/
     virtual void parameterValueChanged(Parameter*) { }
 
@@ -389,6 +411,14 @@ public:
     /** Method for updating settings, called by ProcessorGraph.*/
     void update();
 
+    /** Returns a fingerprint of the settings this processor passes downstream
+        (streams, channels and configuration objects), as of its last update.*/
+    int64 getSettingsFingerprint() const;
+
+    /** Returns true if the settings of this processor's source have changed
+        since this processor was last updated.*/
+    bool hasStaleInputs() const;
+
     // --------------------------------------------
     //     LOADING / SAVING SETTINGS
     // --------------------------------------------
@@ -609,12 +639,25 @@ protected:
     /** Sets whether or not a given stream is enabled*/
     void setStreamEnabled(uint16 streamId, bool isEnabled);
 
+    /** Adds this processor's stream-scoped parameters to a stream.
+        Call this for streams created inside updateSettings(), after adding their channels.*/
+    void addStreamParameters(DataStream* stream);
+
     /** Updates the data channel map objects*/
 	void updateChannelIndexMaps();
 
     /** Holds info about this processor.*/
     std::unique_ptr<ProcessorInfoObject> processorInfo;
 
+    /** Hashes the settings passed downstream (see getSettingsFingerprint)*/
+    int64 computeSettingsFingerprint() const;
+
+    /** Settings fingerprint after the last update*/
+    int64 settingsFingerprint = 0;
+
+    /** Fingerprint of the source node's settings at the last update*/
+    int64 inputFingerprint = 0;
+
     /** Holds info about available devices.*/
     OwnedArray<DeviceInfo> devices;
 
@@ -719,9 +762,33 @@ private:
 
     Parameter* currentParameter;
 
+    bool editorUpdatesDeferred = false;
+    bool editorNeedsUpdate = false;
+
     EventChannel* ttlEventChannel;
     Array<bool> ttlLineStates;
 
+    std::atomic<ProcessingObserver*> processingObserver;
+
+    /** TTL line states of one data stream, updated for every TTL event
+        and published once per block*/
+    struct TTLWordState
+    {
+        uint64 word = 0;
+        bool changed = false;
+        std::atomic<uint64> published { 0 };
+    };
+
+    /** Entries are added when streams are updated and never removed, so the
+        audio thread can look them up while other threads read them*/
+    std::map<uint16, TTLWordState> ttlWords;
+
+    /** Sets or clears one bit of a stream's working TTL word (audio thread)*/
+    void updateTTLWord(uint16 streamId, int bit, bool state);
+
+    /** Makes the TTL words that changed during this block visible to getTTLWord()*/
+    void publishTTLWords();
+
     bool wasConnected;
 
     std::unique_ptr<LatencyMeter> latencyMeter;
@@ -746,10 +813,14 @@ public:
     /** Updates the available data streams */
     void update(Array<const DataStream*>);
 
+    /** Returns the most recent mean latency of a data stream (in ms) */
+    float getMeanLatency(uint16 streamId) const;
+
 private:
     int counter;
 
     std::map<uint16, Array<int>> latencies;
+    std::map<uint16, std::atomic<float>> meanLatencies;
     GenericProcessor* processor;
 };
 
@@ -0,0 +1,54 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PROCESSINGOBSERVER_H_3C9D2E71__
+#define __PROCESSINGOBSERVER_H_3C9D2E71__
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+    Receives notifications from the processing path of a GenericProcessor,
+    such as the measured processing latency. (TTL line states are not
+    pushed; they are published once per block and polled with
+    GenericProcessor::getTTLWord().)
+
+    The hooks are called on the audio thread, so implementations must
+    return quickly and must not block. A processor's editor observes it
+    unless the GUI is running headless, in which case nothing is attached
+    and the processing path never touches UI code.
+
+    @see GenericProcessor, GenericEditor
+*/
+class PLUGIN_API ProcessingObserver
+{
+public:
+
+    /** Destructor */
+    virtual ~ProcessingObserver() { }
+
+    /** Called with the mean processing latency of a data stream (in ms) */
+    virtual void meanLatencyChanged (uint16 streamId, float latencyMs) { }
+};
+
+#endif  // __PROCESSINGOBSERVER_H_3C9D2E71__
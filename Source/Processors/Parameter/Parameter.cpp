@@ -24,6 +24,32 @@
 #include "Parameter.h"
 #include "../GenericProcessor/GenericProcessor.h"
 
+namespace
+{
+    /** Listeners are registered for all parameters at once, so that they
+        also hear about parameters of processors added later */
+    ListenerList<Parameter::Listener, Array<Parameter::Listener*, CriticalSection>>& getParameterListeners()
+    {
+        static ListenerList<Parameter::Listener, Array<Parameter::Listener*, CriticalSection>> listeners;
+        return listeners;
+    }
+}
+
+void Parameter::addListener(Listener* listener)
+{
+    getParameterListeners().add(listener);
+}
+
+void Parameter::removeListener(Listener* listener)
+{
+    getParameterListeners().remove(listener);
+}
+
+void Parameter::notifyListeners()
+{
+    getParameterListeners().call([this](Listener& l) { l.parameterChanged(this); });
+}
+
 String Parameter::getParameterTypeString() const
 {
     if (m_parameterType == Parameter::BOOLEAN_PARAM)
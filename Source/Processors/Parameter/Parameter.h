@@ -120,6 +120,32 @@ public:
     /** Destructor */
     virtual ~Parameter() { }
 
+    /**
+        Receives a notification whenever the value of any Parameter
+        changes, e.g. to mirror parameter state outside the GUI.
+
+        Callbacks are made on the thread that applied the change (usually
+        the message thread), after the owning processor has handled it.
+    */
+    class PLUGIN_API Listener
+    {
+    public:
+        /** Destructor */
+        virtual ~Listener() { }
+
+        /** Called after a parameter has taken on a new value */
+        virtual void parameterChanged(Parameter* parameter) = 0;
+    };
+
+    /** Registers a listener for changes to all parameters */
+    static void addListener(Listener* listener);
+
+    /** Unregisters a listener */
+    static void removeListener(Listener* listener);
+
+    /** Notifies all listeners that this parameter has changed (called by GenericProcessor::parameterChangeRequest)*/
+    void notifyListeners();
+
     /** Returns the name of the parameter.*/
     String getName() const noexcept { return m_name; }
 
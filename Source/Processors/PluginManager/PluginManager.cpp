@@ -29,6 +29,8 @@
 #endif
 
 #include "PluginManager.h"
+#include <map>
+#include <vector>
 #include "../../UI/ProcessorList.h"
 #include "../../UI/ControlPanel.h"
 
@@ -93,6 +95,151 @@ static void errorMsg(const char *file, int line, const char *msg) {
 
 #define ERROR_MSG(msg) errorMsg(__FILE__, __LINE__, msg)
 
+typedef decltype(LoadedLibInfo::handle) LibraryHandle;
+
+/*
+	Opens a plugin library. Must be called on the message thread, as
+	it runs the library's static initializers.
+*/
+static LibraryHandle openLibrary(const String& pluginLoc)
+{
+#ifdef _WIN32
+	HINSTANCE handle;
+	const wchar_t* processorLocLPCWSTR = pluginLoc.toWideCharPointer();
+	handle = LoadLibraryW(processorLocLPCWSTR);
+#elif defined(__APPLE__)
+	CF::CFStringRef processorLocCFString = pluginLoc.toCFString();
+	CF::CFURLRef bundleURL = CF::CFURLCreateWithFileSystemPath(CF::kCFAllocatorDefault, 
+															   processorLocCFString,
+															   CF::kCFURLPOSIXPathStyle,
+															   true);
+															   
+	assert(bundleURL);
+	CF::CFBundleRef handle = CF::CFBundleCreate(CF::kCFAllocatorDefault, bundleURL);
+	CF::CFRelease(bundleURL);
+	CF::CFRelease(processorLocCFString);
+#else
+	// Clear errors
+	dlerror();
+
+	/*
+	Load in the selected processor. This takes the
+	dynamic object (.so) and maps it into memory.
+	Dynamic linker requires a C-style string, so we
+	we have to convert first.
+	*/
+	const char* processorLocCString = pluginLoc.toRawUTF8();
+
+	/*
+	Changing this to resolve all variables immediately upon loading.
+	This will provide for quicker testing of the custom
+	processor stability and to ensure that it doesn't crash due
+	to memory mishaps.
+	*/
+	void *handle = 0;
+	handle = dlopen(processorLocCString, RTLD_GLOBAL|RTLD_NOW);
+#endif
+
+	if (!handle)
+		ERROR_MSG("Failed to load plugin DLL.");
+
+	return handle;
+}
+
+static PluginInfoFunction getPluginInfoFunction(LibraryHandle handle)
+{
+#ifdef _WIN32
+	return (PluginInfoFunction)GetProcAddress(handle, "getPluginInfo");
+#elif defined(__APPLE__)
+    return (PluginInfoFunction)CFBundleGetFunctionPointerForName(handle, CFSTR("getPluginInfo"));
+#else
+    dlerror();
+	return (PluginInfoFunction)(dlsym(handle, "getPluginInfo"));
+#endif
+}
+
+/* Adds the plugin libraries in a directory to an array */
+static void findPluginFiles(const File& pluginPath, Array<File>& foundDLLs)
+{
+#ifdef _WIN32
+    String pluginExt("*.dll");
+#elif defined(__APPLE__)
+    String pluginExt("*.bundle");
+#else
+    String pluginExt("*.so");
+#endif
+    
+#ifdef __APPLE__
+    pluginPath.findChildFiles(foundDLLs, File::findDirectories, false, pluginExt);
+#else
+	pluginPath.findChildFiles(foundDLLs, File::findFiles, true, pluginExt);
+#endif
+}
+
+/* Returns the file holding a library's code (which is inside the bundle on macOS) */
+static File getLibraryBinary(const File& library)
+{
+#ifdef __APPLE__
+	return library.getChildFile("Contents/MacOS").getChildFile(library.getFileNameWithoutExtension());
+#else
+	return library;
+#endif
+}
+
+/* Runs job(0) ... job(numJobs - 1) on a pool of threads and waits for all of them */
+static void runInParallel(int numJobs, const std::function<void(int)>& job)
+{
+	if (numJobs == 0)
+		return;
+
+	ThreadPool pool(jlimit(1, numJobs, SystemStats::getNumCpus()));
+
+	std::atomic<int> remaining(numJobs);
+	WaitableEvent finished;
+
+	for (int i = 0; i < numJobs; i++)
+	{
+		pool.addJob([&, i]
+		{
+			job(i);
+
+			if (--remaining == 0)
+				finished.signal();
+		});
+	}
+
+	finished.wait();
+}
+
+/* Sets the creator of a plugin once its library has been loaded */
+template<class T, class Creator>
+static void setPluginCreator(Array<LoadedPluginInfo<T>>& plugins, int libIndex, int libPluginIndex, Creator creator)
+{
+	for (auto& plugin : plugins)
+	{
+		if (plugin.libIndex == libIndex && plugin.libPluginIndex == libPluginIndex)
+			plugin.creator = creator;
+	}
+}
+
+/* Removes the plugins of a library, and shifts the library indices of those after it */
+template<class T>
+static void removeLibraryPlugins(Array<LoadedPluginInfo<T>>& plugins, int libIndex)
+{
+	for (int j = plugins.size() - 1; j >= 0; j--)
+	{
+		if (plugins[j].libIndex == libIndex)
+		{
+			LOGD("Removing plugin: ", plugins[j].name);
+			plugins.remove(j);
+		}
+		else if (plugins[j].libIndex > libIndex)
+		{
+			plugins.getReference(j).setLibIndex(plugins[j].libIndex - 1);
+		}
+	}
+}
+
 
 PluginManager::PluginManager()
 {
@@ -107,6 +254,10 @@ PluginManager::PluginManager()
 							.getChildFile("Open Ephys")
 							.getChildFile("shared-api" + String(PLUGIN_API_VER));
 
+	manifestFile = File::getSpecialLocation(File::userApplicationDataDirectory)
+					.getChildFile("Open Ephys")
+					.getChildFile("plugin-manifest-api" + String(PLUGIN_API_VER) + ".xml");
+
 	if(appDir.contains("plugin-GUI\\Build\\"))
 	{
 		SetDllDirectory(sharedPath.getFullPathName().toRawUTF8());
@@ -129,6 +280,8 @@ PluginManager::PluginManager()
 	if (!installSharedPath.isDirectory()) {
         installSharedPath.createDirectory();
     }
+
+	manifestFile = installSharedPath.getSiblingFile("plugin-manifest-api" + String(PLUGIN_API_VER) + ".xml");
 #else
 	File installSharedPath = File::getSpecialLocation(File::userApplicationDataDirectory)
 							.getChildFile("Application Support/open-ephys")
@@ -137,6 +290,8 @@ PluginManager::PluginManager()
 	if (!installSharedPath.isDirectory()) {
         installSharedPath.createDirectory();
     }
+
+	manifestFile = installSharedPath.getSiblingFile("plugin-manifest-api" + String(PLUGIN_API_VER) + ".xml");
 #endif
 }
 
@@ -178,47 +333,127 @@ void PluginManager::loadAllPlugins()
 	}	
 #endif
 
+    Array<File> pluginFiles;
+
     for (auto &pluginPath : paths) {
         if (!pluginPath.isDirectory()) {
 			LOGD("Plugin path not found: ", pluginPath.getFullPathName(), "\nCreating new plugins directory...");
 			pluginPath.createDirectory();
         } else {
-            loadPlugins(pluginPath);
+            findPluginFiles(pluginPath, pluginFiles);
         }
     }
+
+    loadPluginFiles(pluginFiles);
 }
 
 void PluginManager::loadPlugins(const File &pluginPath) {
     Array<File> foundDLLs;
-    
-#ifdef _WIN32
-    String pluginExt("*.dll");
-#elif defined(__APPLE__)
-    String pluginExt("*.bundle");
-#else
-    String pluginExt("*.so");
-#endif
-    
-#ifdef __APPLE__
-    pluginPath.findChildFiles(foundDLLs, File::findDirectories, false, pluginExt);
-#else
-	pluginPath.findChildFiles(foundDLLs, File::findFiles, true, pluginExt);
-#endif
+    findPluginFiles(pluginPath, foundDLLs);
+    loadPluginFiles(foundDLLs);
+}
+
+void PluginManager::loadPluginFiles(const Array<File>& pluginFiles)
+{
+	const int numFiles = pluginFiles.size();
+
+	std::unique_ptr<XmlElement> manifest = parseXMLIfTagMatches(manifestFile, "PLUGINMANIFEST");
+
+	if (manifest != nullptr && manifest->getIntAttribute("apiVersion") != PLUGIN_API_VER)
+		manifest.reset();
 
-	for (int i = 0; i < foundDLLs.size(); i++)
+	std::map<String, const XmlElement*> manifestEntries;
+
+	if (manifest != nullptr)
 	{
-		LOGD("Loading Plugin: ", foundDLLs[i].getFileNameWithoutExtension(), "... ");
-		
-		int res = loadPlugin(foundDLLs[i].getFullPathName());
-		
-		if (res < 0)
+		for (auto* entry : manifest->getChildIterator())
+			manifestEntries[entry->getStringAttribute("path")] = entry;
+	}
+
+	std::vector<int64> modificationTimes(numFiles);
+	std::vector<int64> sizes(numFiles);
+	std::vector<String> hashes(numFiles);
+	std::vector<const XmlElement*> cachedEntries(numFiles, nullptr);
+
+	/*
+	Checking a library against the manifest means hashing it, which is done
+	for all libraries at once. Libraries that aren't in the manifest (or have
+	changed) are opened afterwards, on this thread.
+	*/
+	runInParallel(numFiles, [&](int i)
+	{
+		const File binary = getLibraryBinary(pluginFiles[i]);
+
+		modificationTimes[i] = binary.getLastModificationTime().toMilliseconds();
+		sizes[i] = binary.getSize();
+		hashes[i] = MD5(binary).toHexString();
+
+		auto entry = manifestEntries.find(pluginFiles[i].getFullPathName());
+
+		if (entry != manifestEntries.end()
+			&& entry->second->getStringAttribute("modified").getLargeIntValue() == modificationTimes[i]
+			&& entry->second->getStringAttribute("size").getLargeIntValue() == sizes[i]
+			&& entry->second->getStringAttribute("hash") == hashes[i])
 		{
-			LOGE(foundDLLs[i].getFileName(), " Load FAILED");
+			cachedEntries[i] = entry->second;
+		}
+	});
+
+	std::unique_ptr<XmlElement> newManifest = std::make_unique<XmlElement>("PLUGINMANIFEST");
+	newManifest->setAttribute("apiVersion", PLUGIN_API_VER);
+
+	bool manifestChanged = false;
+
+	// Libraries are registered in order, so plugin indices don't depend on the manifest
+	for (int i = 0; i < numFiles; i++)
+	{
+		const String path = pluginFiles[i].getFullPathName();
+
+		LOGD("Loading Plugin: ", pluginFiles[i].getFileNameWithoutExtension(), "... ");
+
+		int res;
+
+		if (cachedEntries[i] != nullptr)
+		{
+			res = registerCachedLibrary(*cachedEntries[i], path);
 		}
 		else
 		{
-			LOGD("  Loaded with ", res, " plugin", (res > 1 ? "s" : ""));
+			res = registerLibrary(openLibrary(path), path);
+			manifestChanged = true;
+		}
+
+		manifestEntries.erase(path);
+
+		if (res < 0)
+		{
+			LOGE(pluginFiles[i].getFileName(), " Load FAILED");
+			continue;
 		}
+
+		LOGD("  ", (cachedEntries[i] != nullptr ? "Found in manifest" : "Loaded"), " with ", res, " plugin", (res > 1 ? "s" : ""));
+
+		XmlElement* entry = createManifestEntry(libArray.size() - 1);
+		entry->setAttribute("path", path);
+		entry->setAttribute("modified", String(modificationTimes[i]));
+		entry->setAttribute("size", String(sizes[i]));
+		entry->setAttribute("hash", hashes[i]);
+		newManifest->addChildElement(entry);
+	}
+
+	// Keep the entries of libraries in other directories, unless they have been deleted
+	for (auto& entry : manifestEntries)
+	{
+		if (File(entry.first).exists())
+			newManifest->addChildElement(new XmlElement(*entry.second));
+		else
+			manifestChanged = true;
+	}
+
+	if (manifest == nullptr || manifestChanged)
+	{
+		if (!newManifest->writeTo(manifestFile))
+			LOGE("Unable to write plugin manifest to ", manifestFile.getFullPathName());
 	}
 }
 
@@ -232,48 +467,13 @@ void PluginManager::loadPlugins(const File &pluginPath) {
 
 int PluginManager::loadPlugin(const String& pluginLoc) {
 
-#ifdef _WIN32
-	HINSTANCE handle;
-	const wchar_t* processorLocLPCWSTR = pluginLoc.toWideCharPointer();
-	handle = LoadLibraryW(processorLocLPCWSTR);
-#elif defined(__APPLE__)
-	CF::CFStringRef processorLocCFString = pluginLoc.toCFString();
-	CF::CFURLRef bundleURL = CF::CFURLCreateWithFileSystemPath(CF::kCFAllocatorDefault, 
-															   processorLocCFString,
-															   CF::kCFURLPOSIXPathStyle,
-															   true);
-															   
-	assert(bundleURL);
-	CF::CFBundleRef handle = CF::CFBundleCreate(CF::kCFAllocatorDefault, bundleURL);
-	CF::CFRelease(bundleURL);
-	CF::CFRelease(processorLocCFString);
-#else
-	// Clear errors
-	dlerror();
-
-	/*
-	Load in the selected processor. This takes the
-	dynamic object (.so) and copies it into RAM
-	Dynamic linker requires a C-style string, so we
-	we have to convert first.
-	*/
-	const char* processorLocCString = pluginLoc.toRawUTF8();
-
-	/*
-	Changing this to resolve all variables immediately upon loading.
-	This will provide for quicker testing of the custom
-	processor stability and to ensure that it doesn't crash due
-	to memory mishaps.
-	*/
-	void *handle = 0;
-	handle = dlopen(processorLocCString,RTLD_GLOBAL|RTLD_NOW);
-#endif
+	return registerLibrary(openLibrary(pluginLoc), pluginLoc);
+}
 
-	if (!handle) {
-		ERROR_MSG("Failed to load plugin DLL.");
-		closeHandle(handle);
+int PluginManager::registerLibrary(LibraryHandle handle, const String& path)
+{
+	if (!handle)
 		return -1;
-	}
 
 	LibraryInfoFunction infoFunction = 0;
 #ifdef _WIN32
@@ -302,15 +502,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 		return -1;
 	}
 
-	PluginInfoFunction piFunction = 0;
-#ifdef _WIN32
-	piFunction = (PluginInfoFunction)GetProcAddress(handle, "getPluginInfo");
-#elif defined(__APPLE__)
-    piFunction = (PluginInfoFunction)CFBundleGetFunctionPointerForName(handle, CFSTR("getPluginInfo"));
-#else
-    dlerror();
-	piFunction = (PluginInfoFunction)(dlsym(handle, "getPluginInfo"));
-#endif
+	PluginInfoFunction piFunction = getPluginInfoFunction(handle);
 
 	if (!piFunction)
 	{
@@ -325,6 +517,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 	lib.libVersion = libInfo.libVersion;
 	lib.numPlugins = libInfo.numPlugins;
 	lib.handle = handle;
+	lib.path = path;
 
 	libArray.add(lib);
 
@@ -343,6 +536,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 			info.name = pInfo.processor.name;
 			info.type = pInfo.processor.type;
 			info.libIndex = libArray.size()-1;
+			info.libPluginIndex = i;
 			processorPlugins.add(info);
 
 			break;
@@ -354,6 +548,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 			info.creator = pInfo.recordEngine.creator;
 			info.name = pInfo.recordEngine.name;
 			info.libIndex = libArray.size() - 1;
+			info.libPluginIndex = i;
 			recordEnginePlugins.add(info);
 			
 			break;
@@ -365,6 +560,7 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 			info.creator = pInfo.dataThread.creator;
 			info.name = pInfo.dataThread.name;
 			info.libIndex = libArray.size() - 1;
+			info.libPluginIndex = i;
 			dataThreadPlugins.add(info);
 			
 			break;
@@ -376,14 +572,15 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 			info.creator = pInfo.fileSource.creator;
 			info.name = pInfo.fileSource.name;
 			info.extensions = pInfo.fileSource.extensions;
-			info.libIndex = libArray.size();
+			info.libIndex = libArray.size() - 1;
+			info.libPluginIndex = i;
 			fileSourcePlugins.add(info);
 			
 			break;
 		}
 		default:
 		{
-			std::cerr << pluginLoc << " invalid plugin type: " << pInfo.type << std::endl;
+			std::cerr << path << " invalid plugin type: " << pInfo.type << std::endl;
 			break;
 		}
 		}
@@ -391,6 +588,184 @@ int PluginManager::loadPlugin(const String& pluginLoc) {
 	return lib.numPlugins;
 }
 
+int PluginManager::registerCachedLibrary(const XmlElement& entry, const String& path)
+{
+	LoadedLibInfo lib{};
+	lib.apiVersion = PLUGIN_API_VER;
+	lib.name = cachedStrings.getPooledString(entry.getStringAttribute("name")).toRawUTF8();
+	lib.libVersion = cachedStrings.getPooledString(entry.getStringAttribute("version")).toRawUTF8();
+	lib.numPlugins = entry.getIntAttribute("numPlugins");
+	lib.handle = nullptr;
+	lib.path = path;
+
+	libArray.add(lib);
+
+	const int libIndex = libArray.size() - 1;
+
+	for (auto* plugin : entry.getChildIterator())
+	{
+		const char* name = cachedStrings.getPooledString(plugin->getStringAttribute("name")).toRawUTF8();
+		const int libPluginIndex = plugin->getIntAttribute("index");
+
+		switch (plugin->getIntAttribute("type"))
+		{
+		case Plugin::PROCESSOR:
+		{
+			LoadedPluginInfo<Plugin::ProcessorInfo> info;
+			info.creator = nullptr;
+			info.name = name;
+			info.type = (Plugin::Processor::Type) plugin->getIntAttribute("processorType");
+			info.libIndex = libIndex;
+			info.libPluginIndex = libPluginIndex;
+			processorPlugins.add(info);
+
+			break;
+		}
+		case Plugin::RECORD_ENGINE:
+		{
+			LoadedPluginInfo<Plugin::RecordEngineInfo> info;
+			info.creator = nullptr;
+			info.name = name;
+			info.libIndex = libIndex;
+			info.libPluginIndex = libPluginIndex;
+			recordEnginePlugins.add(info);
+
+			break;
+		}
+		case Plugin::DATA_THREAD:
+		{
+			LoadedPluginInfo<Plugin::DataThreadInfo> info;
+			info.creator = nullptr;
+			info.name = name;
+			info.libIndex = libIndex;
+			info.libPluginIndex = libPluginIndex;
+			dataThreadPlugins.add(info);
+
+			break;
+		}
+		case Plugin::FILE_SOURCE:
+		{
+			LoadedPluginInfo<Plugin::FileSourceInfo> info;
+			info.creator = nullptr;
+			info.name = name;
+			info.extensions = cachedStrings.getPooledString(plugin->getStringAttribute("extensions")).toRawUTF8();
+			info.libIndex = libIndex;
+			info.libPluginIndex = libPluginIndex;
+			fileSourcePlugins.add(info);
+
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	return lib.numPlugins;
+}
+
+XmlElement* PluginManager::createManifestEntry(int libIndex) const
+{
+	const LoadedLibInfo lib = libArray[libIndex];
+
+	XmlElement* entry = new XmlElement("LIBRARY");
+	entry->setAttribute("name", lib.name);
+	entry->setAttribute("version", lib.libVersion);
+	entry->setAttribute("numPlugins", lib.numPlugins);
+
+	auto addPlugin = [entry](Plugin::Type type, int libPluginIndex, const char* name) -> XmlElement*
+	{
+		XmlElement* plugin = entry->createNewChildElement("PLUGIN");
+		plugin->setAttribute("index", libPluginIndex);
+		plugin->setAttribute("type", (int) type);
+		plugin->setAttribute("name", name);
+		return plugin;
+	};
+
+	for (const auto& info : processorPlugins)
+		if (info.libIndex == libIndex)
+			addPlugin(Plugin::PROCESSOR, info.libPluginIndex, info.name)->setAttribute("processorType", (int) info.type);
+
+	for (const auto& info : recordEnginePlugins)
+		if (info.libIndex == libIndex)
+			addPlugin(Plugin::RECORD_ENGINE, info.libPluginIndex, info.name);
+
+	for (const auto& info : dataThreadPlugins)
+		if (info.libIndex == libIndex)
+			addPlugin(Plugin::DATA_THREAD, info.libPluginIndex, info.name);
+
+	for (const auto& info : fileSourcePlugins)
+		if (info.libIndex == libIndex)
+			addPlugin(Plugin::FILE_SOURCE, info.libPluginIndex, info.name)->setAttribute("extensions", info.extensions);
+
+	return entry;
+}
+
+bool PluginManager::loadLibrary(int libIndex)
+{
+	const ScopedLock lock(loadLock);
+
+	if (libIndex < 0 || libIndex >= libArray.size())
+		return false;
+
+	LoadedLibInfo& lib = libArray.getReference(libIndex);
+
+	if (lib.handle)
+		return true;
+
+	LOGD("Loading plugin library ", lib.name, " on first use");
+
+	LibraryHandle handle = openLibrary(lib.path);
+
+	if (!handle)
+		return false;
+
+	PluginInfoFunction piFunction = getPluginInfoFunction(handle);
+
+	if (!piFunction)
+	{
+		ERROR_MSG("Failed to load function 'getPluginInfo'.");
+		closeHandle(handle);
+		return false;
+	}
+
+	lib.handle = handle;
+
+	Plugin::PluginInfo pInfo;
+	for (int i = 0; i < lib.numPlugins; i++)
+	{
+		if (piFunction(i, &pInfo))
+			break;
+
+		switch (pInfo.type)
+		{
+		case Plugin::PROCESSOR:
+			setPluginCreator(processorPlugins, libIndex, i, pInfo.processor.creator);
+			break;
+		case Plugin::RECORD_ENGINE:
+			setPluginCreator(recordEnginePlugins, libIndex, i, pInfo.recordEngine.creator);
+			break;
+		case Plugin::DATA_THREAD:
+			setPluginCreator(dataThreadPlugins, libIndex, i, pInfo.dataThread.creator);
+			break;
+		case Plugin::FILE_SOURCE:
+			setPluginCreator(fileSourcePlugins, libIndex, i, pInfo.fileSource.creator);
+			break;
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool PluginManager::isLibraryLoaded(int libIndex) const
+{
+	if (libIndex < 0 || libIndex >= libArray.size())
+		return false;
+
+	return libArray[libIndex].handle != nullptr;
+}
+
 int PluginManager::getNumProcessors() const
 {
 	return processorPlugins.size();
@@ -411,64 +786,96 @@ int PluginManager::getNumFileSources() const
 	return fileSourcePlugins.size();
 }
 
-Plugin::ProcessorInfo PluginManager::getProcessorInfo(int index) const
+Plugin::ProcessorInfo PluginManager::getProcessorInfo(int index, bool shouldLoadLibrary)
 {
 	if (index < processorPlugins.size())
+	{
+		if (shouldLoadLibrary)
+			loadLibrary(processorPlugins[index].libIndex);
+
 		return processorPlugins[index];
+	}
 	else
 		return getEmptyProcessorInfo();
 }
 
-Plugin::DataThreadInfo PluginManager::getDataThreadInfo(int index) const
+Plugin::DataThreadInfo PluginManager::getDataThreadInfo(int index, bool shouldLoadLibrary)
 {
 	if (index < dataThreadPlugins.size())
+	{
+		if (shouldLoadLibrary)
+			loadLibrary(dataThreadPlugins[index].libIndex);
+
 		return dataThreadPlugins[index];
+	}
 	else
 		return getEmptyDatathreadInfo();
 }
 
-Plugin::RecordEngineInfo PluginManager::getRecordEngineInfo(int index) const
+Plugin::RecordEngineInfo PluginManager::getRecordEngineInfo(int index, bool shouldLoadLibrary)
 {
 	if (index < recordEnginePlugins.size())
+	{
+		if (shouldLoadLibrary)
+			loadLibrary(recordEnginePlugins[index].libIndex);
+
 		return recordEnginePlugins[index];
-	else 
+	}
+	else
 		return getEmptyRecordengineInfo();
 }
 
-Plugin::FileSourceInfo PluginManager::getFileSourceInfo(int index) const
+Plugin::FileSourceInfo PluginManager::getFileSourceInfo(int index, bool shouldLoadLibrary)
 {
 	if (index < fileSourcePlugins.size())
+	{
+		if (shouldLoadLibrary)
+			loadLibrary(fileSourcePlugins[index].libIndex);
+
 		return fileSourcePlugins[index];
+	}
 	else
 		return getEmptyFileSourceInfo();
 }
 
-Plugin::ProcessorInfo PluginManager::getProcessorInfo(String name, String libName) const
+Plugin::ProcessorInfo PluginManager::getProcessorInfo(String name, String libName)
 {
-	Plugin::ProcessorInfo i = getEmptyProcessorInfo();
-	findPlugin<Plugin::ProcessorInfo>(name, libName, processorPlugins, i);
-	return i;
+	const int index = findPlugin<Plugin::ProcessorInfo>(name, libName, processorPlugins);
+
+	if (index < 0)
+		return getEmptyProcessorInfo();
+
+	return getProcessorInfo(index);
 }
 
-Plugin::DataThreadInfo PluginManager::getDataThreadInfo(String name, String libName) const
+Plugin::DataThreadInfo PluginManager::getDataThreadInfo(String name, String libName)
 {
-	Plugin::DataThreadInfo i = getEmptyDatathreadInfo();
-	findPlugin<Plugin::DataThreadInfo>(name, libName, dataThreadPlugins, i);
-	return i;
+	const int index = findPlugin<Plugin::DataThreadInfo>(name, libName, dataThreadPlugins);
+
+	if (index < 0)
+		return getEmptyDatathreadInfo();
+
+	return getDataThreadInfo(index);
 }
 
-Plugin::RecordEngineInfo PluginManager::getRecordEngineInfo(String name, String libName) const
+Plugin::RecordEngineInfo PluginManager::getRecordEngineInfo(String name, String libName)
 {
-	Plugin::RecordEngineInfo i = getEmptyRecordengineInfo();
-	findPlugin<Plugin::RecordEngineInfo>(name, libName, recordEnginePlugins, i);
-	return i;
+	const int index = findPlugin<Plugin::RecordEngineInfo>(name, libName, recordEnginePlugins);
+
+	if (index < 0)
+		return getEmptyRecordengineInfo();
+
+	return getRecordEngineInfo(index);
 }
 
-Plugin::FileSourceInfo PluginManager::getFileSourceInfo(String name, String libName) const
+Plugin::FileSourceInfo PluginManager::getFileSourceInfo(String name, String libName)
 {
-	Plugin::FileSourceInfo i = getEmptyFileSourceInfo();
-	findPlugin<Plugin::FileSourceInfo>(name, libName, fileSourcePlugins, i);
-	return i;
+	const int index = findPlugin<Plugin::FileSourceInfo>(name, libName, fileSourcePlugins);
+
+	if (index < 0)
+		return getEmptyFileSourceInfo();
+
+	return getFileSourceInfo(index);
 }
 
 String PluginManager::getLibraryName(int index) const
@@ -538,7 +945,7 @@ Plugin::FileSourceInfo PluginManager::getEmptyFileSourceInfo()
 }
 
 template<class T>
-bool PluginManager::findPlugin(String name, String libName, const Array<LoadedPluginInfo<T>>& pluginArray, T& pluginInfo) const
+int PluginManager::findPlugin(String name, String libName, const Array<LoadedPluginInfo<T>>& pluginArray) const
 {
 	for (int i = 0; i < pluginArray.size(); i++)
 	{
@@ -549,12 +956,11 @@ bool PluginManager::findPlugin(String name, String libName, const Array<LoadedPl
 			LOGC ("Found plugin: ", name, " in pluginArray");
 			if ((libName.isEmpty()) || (libName == String(libArray[pluginArray[i].libIndex].name)))
 			{
-				pluginInfo = pluginArray[i];
-				return true;
+				return i;
 			}
 		}
 	}
-	return false;
+	return -1;
 }
 
 bool PluginManager::removePlugin(String libName)
@@ -575,103 +981,11 @@ bool PluginManager::removePlugin(String libName)
 
 	LoadedLibInfo lib = libArray[indexToRemove];
 
-	PluginInfoFunction piFunction = 0;
-#ifdef _WIN32
-	piFunction = (PluginInfoFunction)GetProcAddress(lib.handle, "getPluginInfo");
-#elif defined(__APPLE__)
-    piFunction = (PluginInfoFunction)CFBundleGetFunctionPointerForName(lib.handle, CFSTR("getPluginInfo"));
-#else
-    dlerror();
-	piFunction = (PluginInfoFunction)(dlsym(lib.handle, "getPluginInfo"));
-#endif
-
-	if (!piFunction)
-	{
-        ERROR_MSG("Failed to load function 'getPluginInfo'");
-		closeHandle(lib.handle);
-		return -1;
-	}
-
-	Plugin::PluginInfo pInfo;
-	for (int i = 0; i < lib.numPlugins; i++)
-	{
-		if (piFunction(i, &pInfo)) //if somehow there are fewer plugins than stated, stop removing
-			break;
-
-		int pluginIndex = -1;
-		switch (pInfo.type)
-		{
-			case Plugin::PROCESSOR:
-			{
-				LOGD("Removing processor plugin: ", pInfo.processor.name);
-				for(int j = 0; j < processorPlugins.size(); j++)
-				{
-					if(processorPlugins[j].name == pInfo.processor.name)
-						pluginIndex = j;
-					
-					if (processorPlugins[j].libIndex > indexToRemove)
-						processorPlugins[j].setLibIndex(processorPlugins[j].libIndex - 1);
-				}
-				if(pluginIndex != -1)
-					processorPlugins.remove(pluginIndex);
-
-				break;
-			}
-			case Plugin::RECORD_ENGINE:
-			{
-				LOGD("Removing record engine plugin: ", pInfo.recordEngine.name);
-				for(int j = 0; j < recordEnginePlugins.size(); j++)
-				{
-					if(recordEnginePlugins[j].name == pInfo.recordEngine.name)
-						pluginIndex = j;
-					
-					if (recordEnginePlugins[j].libIndex > indexToRemove)
-						recordEnginePlugins[j].setLibIndex(recordEnginePlugins[j].libIndex - 1);
-				}
-				if(pluginIndex != -1)
-					recordEnginePlugins.remove(pluginIndex);
-
-				break;
-			}
-			case Plugin::DATA_THREAD:
-			{
-				LOGD("Removing data thread plugin: ", pInfo.dataThread.name);
-				for(int j = 0; j < dataThreadPlugins.size(); j++)
-				{
-					if(dataThreadPlugins[j].name == pInfo.dataThread.name)
-						pluginIndex = j;
-					
-					if (dataThreadPlugins[j].libIndex > indexToRemove)
-						dataThreadPlugins[j].setLibIndex(dataThreadPlugins[j].libIndex - 1);
-				}
-				if(pluginIndex != -1)
-					dataThreadPlugins.remove(pluginIndex);
-
-				break;
-			}
-			case Plugin::FILE_SOURCE:
-			{
-				LOGD("Removing file source plugin: ", pInfo.fileSource.name);
-				for(int j = 0; j < fileSourcePlugins.size(); j++)
-				{
-					if(fileSourcePlugins[j].name == pInfo.fileSource.name)
-						pluginIndex = j;
-					
-					if (fileSourcePlugins[j].libIndex > indexToRemove)
-						fileSourcePlugins[j].setLibIndex(fileSourcePlugins[j].libIndex - 1);
-				}
-				if(pluginIndex != -1)
-					fileSourcePlugins.remove(pluginIndex);
-
-				break;
-			}
-			default:
-			{
-				LOGE("Invalid plugin");
-				break;
-			}
-		}
-	}
+	// Plugins are matched by library, as the library may never have been loaded
+	removeLibraryPlugins(processorPlugins, indexToRemove);
+	removeLibraryPlugins(recordEnginePlugins, indexToRemove);
+	removeLibraryPlugins(dataThreadPlugins, indexToRemove);
+	removeLibraryPlugins(fileSourcePlugins, indexToRemove);
 
 	closeHandle(lib.handle);
 	libArray.remove(indexToRemove);
@@ -49,6 +49,9 @@ struct LoadedLibInfo : public Plugin::LibraryInfo
 #else
 	void* handle;
 #endif
+
+	/** Location of the library, used to load it on first use */
+	String path;
 };
 
 template<class T>
@@ -56,6 +59,9 @@ struct LoadedPluginInfo : public T
 {
 	int libIndex;
 
+	/** Position of the plugin within its library */
+	int libPluginIndex;
+
 	// Setter function to modify the libIndex
 	void setLibIndex(int index)
 	{
@@ -70,6 +76,11 @@ class GenericProcessor;
 * 
 	Retrieves information about available plugins
 
+	Descriptions of the plugins found at startup are kept in a manifest,
+	keyed by each library's path, modification time, size and hash. Libraries
+	listed in the manifest are not loaded until one of their plugins is
+	needed; the rest are loaded at startup and added to the manifest.
+
  */
 class PluginManager {
 
@@ -90,6 +101,9 @@ public:
 	/** Loads a plugin at a particular path*/
 	int loadPlugin(const String&);
 
+	/** Returns true if a library's code has been loaded (rather than just its description) */
+	bool isLibraryLoaded(int libIndex) const;
+
 	/** Unloads a plugin (not implemented yet) */
 	//void unloadPlugin(Plugin *);
 
@@ -108,29 +122,30 @@ public:
 	/** Returns the total number of file source plugins*/
 	int getNumFileSources() const;
 
-	/** Returns info about a processor plugin at a given index */
-	Plugin::ProcessorInfo getProcessorInfo(int index) const;
+	/** Returns info about a processor plugin at a given index. Unless shouldLoadLibrary
+	    is false, the plugin's library is loaded first, so that the creator is valid. */
+	Plugin::ProcessorInfo getProcessorInfo(int index, bool shouldLoadLibrary = true);
 
 	/** Returns info about a processor plugin with a given name */
-	Plugin::ProcessorInfo getProcessorInfo(String name, String libName = String()) const;
+	Plugin::ProcessorInfo getProcessorInfo(String name, String libName = String());
 
-	/** Returns info about a data thread plugin at a given index */
-	Plugin::DataThreadInfo getDataThreadInfo(int index) const;
+	/** Returns info about a data thread plugin at a given index (see getProcessorInfo) */
+	Plugin::DataThreadInfo getDataThreadInfo(int index, bool shouldLoadLibrary = true);
 
 	/** Returns info about a data thread plugin with a given name */
-	Plugin::DataThreadInfo getDataThreadInfo(String name, String libName = String()) const;
+	Plugin::DataThreadInfo getDataThreadInfo(String name, String libName = String());
 
-	/** Returns info about a record engine plugin at a given index */
-	Plugin::RecordEngineInfo getRecordEngineInfo(int index) const;
+	/** Returns info about a record engine plugin at a given index (see getProcessorInfo) */
+	Plugin::RecordEngineInfo getRecordEngineInfo(int index, bool shouldLoadLibrary = true);
 
 	/** Returns info about a record engine plugin with a given name */
-	Plugin::RecordEngineInfo getRecordEngineInfo(String name, String libName = String()) const;
+	Plugin::RecordEngineInfo getRecordEngineInfo(String name, String libName = String());
 
-	/** Returns info about a file source plugin at a given index */
-	Plugin::FileSourceInfo getFileSourceInfo(int index) const;
+	/** Returns info about a file source plugin at a given index (see getProcessorInfo) */
+	Plugin::FileSourceInfo getFileSourceInfo(int index, bool shouldLoadLibrary = true);
 
 	/** Returns info about a file source plugin with a given name */
-	Plugin::FileSourceInfo getFileSourceInfo(String name, String libName = String()) const;
+	Plugin::FileSourceInfo getFileSourceInfo(String name, String libName = String());
 
 	/** Returns the library name for a plugin at a given index */
 	String getLibraryName(int index) const;
@@ -151,8 +166,31 @@ private:
 	Array<LoadedPluginInfo<Plugin::RecordEngineInfo>> recordEnginePlugins;
 	Array<LoadedPluginInfo<Plugin::FileSourceInfo>> fileSourcePlugins;
 
+	/** Plugin manifest for the current API version */
+	File manifestFile;
+
+	/** Holds the names of plugins whose libraries haven't been loaded */
+	StringPool cachedStrings;
+
+	CriticalSection loadLock;
+
+	/** Loads the given plugin files, using the manifest where possible */
+	void loadPluginFiles(const Array<File>& pluginFiles);
+
+	/** Adds the plugins of an opened library, returning the number of plugins (or -1 on failure) */
+	int registerLibrary(decltype(LoadedLibInfo::handle) handle, const String& path);
+
+	/** Adds the plugins of a library from its manifest entry, without loading it */
+	int registerCachedLibrary(const XmlElement& entry, const String& path);
+
+	/** Creates the manifest entry for a registered library */
+	XmlElement* createManifestEntry(int libIndex) const;
+
+	/** Loads a library that was registered from the manifest */
+	bool loadLibrary(int libIndex);
+
 	template<class T>
-	bool findPlugin(String name, String libName, const Array<LoadedPluginInfo<T>>& pluginArray, T& pluginInfo) const;
+	int findPlugin(String name, String libName, const Array<LoadedPluginInfo<T>>& pluginArray) const;
 
 	/* Making the info structures have a constructor complicates the DLL interface. 
 	It's easier to just add some static methods to create empty structures for when the calls fail*/
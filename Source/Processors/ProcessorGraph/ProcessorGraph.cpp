@@ -226,6 +226,10 @@ GenericProcessor* ProcessorGraph::createProcessor(Plugin::Description& descripti
 
         GenericEditor* editor = (GenericEditor*)addedProc->createEditor();
 
+        // without a visible editor, the processing path has no one to notify
+        if (!CoreServices::isHeadless())
+            addedProc->setProcessingObserver(editor);
+
         if (!signalChainIsLoading)
         {
             addedProc->initialize(false);
@@ -499,10 +503,24 @@ void ProcessorGraph::updateSettings(GenericProcessor* processor, bool signalChai
 
     Array<Splitter*> splitters;
 
+    int numSkipped = 0;
+
     while ((processor != nullptr) || (splitters.size() > 0))
     {
         if (processor != nullptr)
         {
+            // Mergers have two inputs, so they are always updated when reached
+            if (!signalChainIsLoading
+                && processor != processorToUpdate
+                && !processor->isMerger()
+                && !processor->hasStaleInputs())
+            {
+                // nothing this processor receives has changed, so neither has anything below it
+                numSkipped++;
+                processor = nullptr;
+                continue;
+            }
+
             processor->update();
 
             if (signalChainIsLoading && processor->getSourceNode() != nullptr)
@@ -526,6 +544,9 @@ void ProcessorGraph::updateSettings(GenericProcessor* processor, bool signalChai
         }
     }
 
+    if (numSkipped > 0)
+        LOGD("Skipped ", numSkipped, " processor(s) with unchanged inputs");
+
     updateViews(processorToUpdate, true);
 
     if(!signalChainIsLoading)
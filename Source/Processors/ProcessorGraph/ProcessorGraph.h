@@ -115,7 +115,9 @@ public:
     /* Returns a list of processor editors that are currently visible*/
     Array<GenericEditor*> getVisibleEditors(GenericProcessor* processor);
 
-    /* Updates the settings of all processors downstream of the specified processor*/
+    /* Updates the settings of the specified processor and of the processors downstream of it.
+       Downstream processors whose inputs haven't changed are skipped, along with everything
+       below them (unless the signal chain is loading, in which case all are updated).*/
     void updateSettings(GenericProcessor* processor, bool signalChainIsLoading = false);
 
     /* Updates the views (EditorViewport and GraphView) of all processors downstream of the specified processor*/
@@ -172,14 +172,15 @@ namespace ProcessorManager
         }
         case Plugin::PROCESSOR:
         {
-            Plugin::ProcessorInfo info = AccessClass::getPluginManager()->getProcessorInfo(index);
+            // Only the description is needed, so the library isn't loaded yet
+            Plugin::ProcessorInfo info = AccessClass::getPluginManager()->getProcessorInfo(index, false);
             description.name = info.name;
             description.processorType = info.type;
             break;
         }
 		case Plugin::DATA_THREAD:
         {
-            Plugin::DataThreadInfo info = AccessClass::getPluginManager()->getDataThreadInfo(index);
+            Plugin::DataThreadInfo info = AccessClass::getPluginManager()->getDataThreadInfo(index, false);
             description.name = info.name;
             description.processorType = Plugin::Processor::SOURCE;
             break;
@@ -222,6 +223,8 @@ namespace ProcessorManager
             case Plugin::PROCESSOR:
             {
                 Plugin::ProcessorInfo info = AccessClass::getPluginManager()->getProcessorInfo(description.index);
+                if (info.creator == nullptr)
+                    return nullptr;
                 GenericProcessor* proc = info.creator();
                 proc->setPluginData(Plugin::PROCESSOR, description.index);
                 proc->setProcessorType(description.processorType);
@@ -230,6 +233,8 @@ namespace ProcessorManager
             case Plugin::DATA_THREAD:
             {
                 Plugin::DataThreadInfo info = AccessClass::getPluginManager()->getDataThreadInfo(description.index);
+                if (info.creator == nullptr)
+                    return nullptr;
                 GenericProcessor* proc = new SourceNode(info.name, info.creator);
                 proc->setPluginData(Plugin::DATA_THREAD, description.index);
                 proc->setProcessorType(Plugin::Processor::SOURCE);
@@ -255,7 +260,7 @@ namespace ProcessorManager
             {
                 for (int i = 0; i < pm->getNumProcessors(); i++)
                 {
-                    Plugin::ProcessorInfo info = pm->getProcessorInfo(i);
+                    Plugin::ProcessorInfo info = pm->getProcessorInfo(i, false);
                     
                     if (description.name.equalsIgnoreCase(info.name))
                     {
@@ -263,6 +268,9 @@ namespace ProcessorManager
                         
                         if (description.libName.equalsIgnoreCase(pm->getLibraryName(libIndex)))
                         {
+                            info = pm->getProcessorInfo(i);
+                            if (info.creator == nullptr)
+                                break;
                             proc = info.creator();
                             proc->setPluginData(Plugin::PROCESSOR, i);
                             proc->setProcessorType(description.processorType);
@@ -275,12 +283,15 @@ namespace ProcessorManager
             {
                 for (int i = 0; i < pm->getNumDataThreads(); i++)
                 {
-                    Plugin::DataThreadInfo info = pm->getDataThreadInfo(i);
+                    Plugin::DataThreadInfo info = pm->getDataThreadInfo(i, false);
                     if (description.name.equalsIgnoreCase(info.name))
                     {
                         int libIndex = pm->getLibraryIndexFromPlugin(Plugin::DATA_THREAD, i);
                         if (description.libName.equalsIgnoreCase(pm->getLibraryName(libIndex)))
                         {
+                            info = pm->getDataThreadInfo(i);
+                            if (info.creator == nullptr)
+                                break;
                             proc = new SourceNode(info.name, info.creator);
                             proc->setPluginData(Plugin::DATA_THREAD, i);
                             return std::unique_ptr<GenericProcessor>(proc);
@@ -40,6 +40,19 @@ int DataQueue::getBlockSize()
 	return m_blockSize;
 }
 
+float DataQueue::getUsage() const
+{
+	float usage = 0.0f;
+
+	for (auto fifo : m_fifos)
+		usage = jmax(usage, 1.0f - (float)fifo->getFreeSpace() / (float)fifo->getTotalSize());
+
+	for (auto fifo : m_FTSFifos)
+		usage = jmax(usage, 1.0f - (float)fifo->getFreeSpace() / (float)fifo->getTotalSize());
+
+	return usage;
+}
+
 void DataQueue::setTimestampStreamCount(int nStreams)
 {
 	if (m_readInProgress)
@@ -88,6 +88,9 @@ public:
 	/** Returns the current block size*/
 	int getBlockSize();
 
+	/** Returns the fill level (0-1) of the fullest buffer */
+	float getUsage() const;
+
 private:
 
 	/** Fills the sample number buffer for a given channel */
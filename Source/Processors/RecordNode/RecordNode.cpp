@@ -730,6 +730,14 @@ bool RecordNode::getRecordingStatus() const
 	return isRecording;
 }
 
+float RecordNode::getRecordBufferUsage() const
+{
+	if (!isRecording)
+		return 0.0f;
+
+	return dataQueue->getUsage();
+}
+
 void RecordNode::setRecordEvents(bool recordEvents)
 {
 	this->recordEvents = recordEvents;
@@ -5,6 +5,7 @@
 #include <chrono>
 #include <math.h>
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <map>
 
@@ -166,6 +167,10 @@ public:
 	/** Returns true if this Record Node is writing data*/
 	bool getRecordingStatus() const;
 
+	/** Returns the fill level (0-1) of the fullest record buffer, or 0 if not recording.
+	    Unlike fifoUsage, this also changes while no blocks are being processed. */
+	float getRecordBufferUsage() const;
+
 	/** Get the last settings.xml in string form. Since the string will be large, returns a const ref.*/
 	const String &getLastSettingsXml() const;
 
@@ -252,7 +257,10 @@ private:
 	OwnedArray<RecordEngine> engineArray;
 
     bool isProcessing;
-	bool isRecording;
+
+	/** Written by the message thread, also read by the free-running driver */
+	std::atomic<bool> isRecording;
+
 	bool hasRecorded;
 	bool settingsNeeded;
     bool shouldRecord;
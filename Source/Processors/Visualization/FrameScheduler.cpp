@@ -0,0 +1,345 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "FrameScheduler.h"
+
+#include <algorithm>
+
+namespace
+{
+    /** Interval between ticks (about 60 Hz)*/
+    const int TICK_INTERVAL_MS = 16;
+
+    /** Time per tick that may be spent rendering; the rest is left for painting and input*/
+    const float FRAME_BUDGET_MS = 8.0f;
+
+    /** Number of ticks in a row a degradable client may be deferred*/
+    const int MAX_DEFERRALS = 3;
+
+    /** Largest factor by which a client's rate is reduced*/
+    const int MAX_RATE_DIVIDER = 8;
+
+    /** Consecutive ticks over budget before a client is slowed down*/
+    const int OVERLOAD_TICKS = 10;
+
+    /** Consecutive ticks under half the budget before a client is sped up again*/
+    const int RECOVERY_TICKS = 60;
+
+    /** Smoothing applied to render-time averages*/
+    const float SMOOTHING = 0.1f;
+
+    /** Window over which the maximum frame time is taken*/
+    const double STATISTICS_WINDOW_MS = 1000.0;
+}
+
+JUCE_IMPLEMENT_SINGLETON (FrameScheduler)
+
+FrameScheduler::Client::~Client()
+{
+    if (FrameScheduler* scheduler = FrameScheduler::getInstanceWithoutCreating())
+        scheduler->removeClient (this);
+}
+
+FrameScheduler::FrameScheduler() :
+    windowMaxFrameMs (0.0f),
+    windowStartMs (Time::getMillisecondCounterHiRes()),
+    ticksOverBudget (0),
+    ticksUnderBudget (0)
+{
+    statistics.budgetMs = FRAME_BUDGET_MS;
+}
+
+FrameScheduler::~FrameScheduler()
+{
+    stopTimer();
+
+    clearSingletonInstance();
+}
+
+FrameScheduler::ClientInfo* FrameScheduler::findClient (Client* client) const
+{
+    for (auto info : clients)
+    {
+        if (info->client == client)
+            return info;
+    }
+
+    return nullptr;
+}
+
+void FrameScheduler::addClient (Client* client, float rateHz, bool canDegrade)
+{
+    jassert (rateHz > 0.0f);
+
+    ClientInfo* info = findClient (client);
+
+    if (info == nullptr)
+    {
+        info = clients.add (new ClientInfo());
+
+        info->client = client;
+        info->frameRequested = false;
+        info->averageRenderMs = 0.0f;
+        info->framesRendered = 0;
+        info->framesDeferred = 0;
+    }
+
+    info->rateHz = rateHz;
+    info->canDegrade = canDegrade;
+    info->rateDivider = 1;
+    info->consecutiveDeferrals = 0;
+    info->nextDueMs = Time::getMillisecondCounterHiRes();
+
+    if (!isTimerRunning())
+        startTimer (TICK_INTERVAL_MS);
+}
+
+void FrameScheduler::removeClient (Client* client)
+{
+    if (ClientInfo* info = findClient (client))
+        clients.removeObject (info);
+}
+
+void FrameScheduler::requestFrame (Client* client)
+{
+    ClientInfo* info = findClient (client);
+
+    if (info == nullptr)
+    {
+        // one-off client, removed again once rendered
+        info = clients.add (new ClientInfo());
+
+        info->client = client;
+        info->rateHz = 0.0f;
+        info->canDegrade = false;
+        info->rateDivider = 1;
+        info->consecutiveDeferrals = 0;
+        info->nextDueMs = 0.0;
+        info->averageRenderMs = 0.0f;
+        info->framesRendered = 0;
+        info->framesDeferred = 0;
+    }
+
+    info->frameRequested = true;
+
+    if (!isTimerRunning())
+        startTimer (TICK_INTERVAL_MS);
+}
+
+bool FrameScheduler::isRegistered (Client* client) const
+{
+    ClientInfo* info = findClient (client);
+
+    return info != nullptr && info->rateHz > 0.0f;
+}
+
+FrameScheduler::Statistics FrameScheduler::getStatistics() const
+{
+    Statistics result = statistics;
+
+    result.maxFrameMs = jmax (statistics.maxFrameMs, windowMaxFrameMs);
+
+    for (auto info : clients)
+    {
+        if (info->rateHz > 0.0f)
+        {
+            result.numClients++;
+
+            if (info->rateDivider > 1)
+                result.numDegradedClients++;
+        }
+    }
+
+    return result;
+}
+
+FrameScheduler::ClientStatistics FrameScheduler::getClientStatistics (Client* client) const
+{
+    ClientStatistics result;
+
+    if (ClientInfo* info = findClient (client))
+    {
+        result.targetRateHz = info->rateHz;
+        result.effectiveRateHz = info->rateHz / info->rateDivider;
+        result.averageRenderMs = info->averageRenderMs;
+        result.framesRendered = info->framesRendered;
+        result.framesDeferred = info->framesDeferred;
+    }
+
+    return result;
+}
+
+void FrameScheduler::timerCallback()
+{
+    const double now = Time::getMillisecondCounterHiRes();
+
+    dueClients.clearQuick();
+
+    for (auto info : clients)
+    {
+        if (info->frameRequested || (info->rateHz > 0.0f && now >= info->nextDueMs))
+            dueClients.add (info);
+    }
+
+    if (dueClients.isEmpty())
+    {
+        if (clients.isEmpty())
+            stopTimer();
+
+        return;
+    }
+
+    // clients that cannot be degraded go first, then the most overdue ones
+    std::stable_sort (dueClients.begin(), dueClients.end(), [] (const ClientInfo* a, const ClientInfo* b)
+    {
+        if (a->canDegrade != b->canDegrade)
+            return !a->canDegrade;
+
+        return a->nextDueMs < b->nextDueMs;
+    });
+
+    float frameMs = 0.0f;
+
+    for (auto info : dueClients)
+    {
+        // an earlier client may have deleted this one
+        if (!clients.contains (info))
+            continue;
+
+        const bool fitsInBudget = frameMs + info->averageRenderMs <= FRAME_BUDGET_MS;
+
+        if (!fitsInBudget && info->canDegrade && frameMs > 0.0f
+            && info->consecutiveDeferrals < MAX_DEFERRALS)
+        {
+            info->consecutiveDeferrals++;
+            info->framesDeferred++;
+            statistics.framesDeferred++;
+            continue;
+        }
+
+        frameMs += render (info, now);
+    }
+
+    statistics.framesRendered++;
+    statistics.averageFrameMs += SMOOTHING * (frameMs - statistics.averageFrameMs);
+    windowMaxFrameMs = jmax (windowMaxFrameMs, frameMs);
+
+    if (now - windowStartMs >= STATISTICS_WINDOW_MS)
+    {
+        statistics.maxFrameMs = windowMaxFrameMs;
+        windowMaxFrameMs = 0.0f;
+        windowStartMs = now;
+    }
+
+    adjustRates (frameMs);
+}
+
+float FrameScheduler::render (ClientInfo* info, double now)
+{
+    info->frameRequested = false;
+    info->consecutiveDeferrals = 0;
+
+    if (info->rateHz > 0.0f)
+    {
+        const double interval = 1000.0 / info->rateHz * info->rateDivider;
+
+        // keep the average rate exact, but don't try to catch up on missed frames
+        info->nextDueMs += interval;
+
+        if (info->nextDueMs <= now)
+            info->nextDueMs = now + interval;
+    }
+
+    Client* client = info->client;
+
+    const double start = Time::getMillisecondCounterHiRes();
+
+    client->renderFrame();
+
+    const float elapsed = float (Time::getMillisecondCounterHiRes() - start);
+
+    // the client may have removed itself
+    if (clients.contains (info))
+    {
+        info->averageRenderMs += SMOOTHING * (elapsed - info->averageRenderMs);
+        info->framesRendered++;
+
+        if (info->rateHz <= 0.0f && !info->frameRequested)
+            clients.removeObject (info);
+    }
+
+    return elapsed;
+}
+
+void FrameScheduler::adjustRates (float frameMs)
+{
+    if (frameMs > FRAME_BUDGET_MS)
+    {
+        ticksUnderBudget = 0;
+
+        if (++ticksOverBudget < OVERLOAD_TICKS)
+            return;
+
+        ticksOverBudget = 0;
+
+        // halve the rate of the most expensive client that can still be slowed down
+        ClientInfo* mostExpensive = nullptr;
+
+        for (auto info : clients)
+        {
+            if (info->canDegrade && info->rateHz > 0.0f && info->rateDivider < MAX_RATE_DIVIDER
+                && (mostExpensive == nullptr || info->averageRenderMs > mostExpensive->averageRenderMs))
+                mostExpensive = info;
+        }
+
+        if (mostExpensive != nullptr)
+            mostExpensive->rateDivider *= 2;
+    }
+    else if (frameMs < FRAME_BUDGET_MS / 2.0f)
+    {
+        ticksOverBudget = 0;
+
+        if (++ticksUnderBudget < RECOVERY_TICKS)
+            return;
+
+        ticksUnderBudget = 0;
+
+        // restore the cheapest degraded client first
+        ClientInfo* cheapest = nullptr;
+
+        for (auto info : clients)
+        {
+            if (info->rateDivider > 1
+                && (cheapest == nullptr || info->averageRenderMs < cheapest->averageRenderMs))
+                cheapest = info;
+        }
+
+        if (cheapest != nullptr)
+            cheapest->rateDivider /= 2;
+    }
+    else
+    {
+        ticksOverBudget = 0;
+        ticksUnderBudget = 0;
+    }
+}
@@ -0,0 +1,156 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __FRAMESCHEDULER_H_8A3F61D2__
+#define __FRAMESCHEDULER_H_8A3F61D2__
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "../PluginManager/OpenEphysPlugin.h"
+
+/**
+
+  Drives every periodic display update from a single message-thread timer.
+
+  Instead of running their own Timer, clients register a target rate. On each
+  tick, the clients that are due are rendered in order of lateness until the
+  frame's time budget is used up. Clients that do not fit are deferred to the
+  next tick (but never more than a few ticks in a row, so latency is bounded).
+  When frames keep running over budget, the most expensive degradable client
+  is rendered at a fraction of its rate until there is room again.
+
+  One-off updates can be requested with requestFrame(); any number of requests
+  made between two ticks result in a single render.
+
+  @see Visualizer
+
+*/
+
+class PLUGIN_API FrameScheduler : private Timer,
+                                  public DeletedAtShutdown
+{
+public:
+
+    /** Anything that needs periodic updates on the message thread */
+    class PLUGIN_API Client
+    {
+    public:
+
+        /** Destructor (unregisters the client) */
+        virtual ~Client();
+
+        /** Called on the message thread whenever the client is due */
+        virtual void renderFrame() = 0;
+    };
+
+    /** Overall frame-time statistics (times in milliseconds) */
+    struct Statistics
+    {
+        float budgetMs = 0.0f;
+        float averageFrameMs = 0.0f;
+        float maxFrameMs = 0.0f;
+        int64 framesRendered = 0;
+        int64 framesDeferred = 0;
+        int numClients = 0;
+        int numDegradedClients = 0;
+    };
+
+    /** Frame-time statistics of a single client (times in milliseconds) */
+    struct ClientStatistics
+    {
+        float targetRateHz = 0.0f;
+        float effectiveRateHz = 0.0f;
+        float averageRenderMs = 0.0f;
+        int64 framesRendered = 0;
+        int64 framesDeferred = 0;
+    };
+
+    /** Returns the shared scheduler (message thread only) */
+    JUCE_DECLARE_SINGLETON_SINGLETHREADED_MINIMAL (FrameScheduler)
+
+    /** Renders the client at (up to) rateHz until it is removed. Clients that
+        cannot be degraded are always rendered first and are never slowed down.
+        Calling this again for the same client changes its rate. */
+    void addClient (Client* client, float rateHz, bool canDegrade = true);
+
+    /** Stops periodic updates for a client */
+    void removeClient (Client* client);
+
+    /** Renders the client once on the next tick */
+    void requestFrame (Client* client);
+
+    /** Returns true if the client receives periodic updates */
+    bool isRegistered (Client* client) const;
+
+    /** Returns the overall statistics, with the maximum taken over the last second */
+    Statistics getStatistics() const;
+
+    /** Returns the statistics of a registered client */
+    ClientStatistics getClientStatistics (Client* client) const;
+
+private:
+
+    /** Constructor */
+    FrameScheduler();
+
+    /** Destructor */
+    ~FrameScheduler();
+
+    struct ClientInfo
+    {
+        Client* client;
+        float rateHz;
+        bool canDegrade;
+        bool frameRequested;
+        int rateDivider;
+        int consecutiveDeferrals;
+        double nextDueMs;
+        float averageRenderMs;
+        int64 framesRendered;
+        int64 framesDeferred;
+    };
+
+    void timerCallback() override;
+
+    ClientInfo* findClient (Client* client) const;
+
+    /** Renders a client and returns the time it took */
+    float render (ClientInfo* info, double now);
+
+    /** Slows down or restores degradable clients after a frame */
+    void adjustRates (float frameMs);
+
+    OwnedArray<ClientInfo> clients;
+
+    Array<ClientInfo*> dueClients;
+
+    Statistics statistics;
+
+    float windowMaxFrameMs;
+    double windowStartMs;
+    int ticksOverBudget;
+    int ticksUnderBudget;
+
+    JUCE_DECLARE_NON_COPYABLE (FrameScheduler)
+};
+
+#endif  // __FRAMESCHEDULER_H_8A3F61D2__
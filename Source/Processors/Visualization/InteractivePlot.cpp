@@ -24,6 +24,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "InteractivePlot.h"
 
 #include <math.h>
+#include <algorithm>
+
+namespace
+{
+	/** Lines with fewer points are always drawn point by point */
+	const int MIN_POINTS_TO_DECIMATE = 1024;
+}
 
 InteractivePlot::InteractivePlot() :
 	backgroundColour(Colours::darkgrey),
@@ -174,7 +181,25 @@ void InteractivePlot::plot(std::vector<float> x,
 	PlotType type)
 {
 
-	XYLine* line = new XYLine(x, y);
+	XYLine* line = new XYLine(std::move(x), std::move(y));
+	line->setColour(c);
+	line->setWidth(width);
+	line->setOpacity(opacity);
+	line->setType(type);
+
+	drawComponent->add(line);
+}
+
+void InteractivePlot::plot(const float* x,
+	const float* y,
+	int numPoints,
+	Colour c,
+	float width,
+	float opacity,
+	PlotType type)
+{
+
+	XYLine* line = new XYLine(x, y, numPoints);
 	line->setColour(c);
 	line->setWidth(width);
 	line->setOpacity(opacity);
@@ -429,11 +454,31 @@ void YAxis::paint(Graphics& g)
 
 
 XYLine::XYLine(std::vector<float> x_, std::vector<float> y_) : 
-	x(x_), y(y_), 
+	x(std::move(x_)), y(std::move(y_)), 
 	colour(Colours::white), 
 	width(1.0f), 
-	opacity(1.0f), 
-	type(PlotType::LINE)
+	type(PlotType::LINE), 
+	opacity(1.0f)
+{
+	xData = x.data();
+	yData = y.data();
+	numPoints = int(MIN(x.size(), y.size()));
+
+	initialise();
+}
+
+XYLine::XYLine(const float* x_, const float* y_, int numPoints_) :
+	xData(x_), yData(y_),
+	numPoints(numPoints_),
+	colour(Colours::white),
+	width(1.0f),
+	type(PlotType::LINE),
+	opacity(1.0f)
+{
+	initialise();
+}
+
+void XYLine::initialise()
 {
 
 	range.xmin = 1e10;
@@ -441,16 +486,51 @@ XYLine::XYLine(std::vector<float> x_, std::vector<float> y_) :
 	range.ymin = 1e10;
 	range.ymax = -1e10;
 
-	for (int i = 0; i < x.size(); i++)
+	xIsSorted = true;
+
+	for (int i = 0; i < numPoints; i++)
 	{
-		range.xmin = MIN(x[i], range.xmin);
-		range.xmax = MAX(x[i], range.xmax);
+		range.xmin = MIN(xData[i], range.xmin);
+		range.xmax = MAX(xData[i], range.xmax);
+		range.ymin = MIN(yData[i], range.ymin);
+		range.ymax = MAX(yData[i], range.ymax);
+
+		if (i > 0 && xData[i] < xData[i - 1])
+			xIsSorted = false;
 	}
 
-	for (int i = 0; i < y.size(); i++)
+	minLevels.clear();
+	maxLevels.clear();
+
+	if (!xIsSorted || numPoints < MIN_POINTS_TO_DECIMATE)
+		return;
+
+	// each level halves the previous one (the last block of a level may be partial)
+	const float* previousMin = yData;
+	const float* previousMax = yData;
+	int previousSize = numPoints;
+
+	while (previousSize > 1)
 	{
-		range.ymin = MIN(y[i], range.ymin);
-		range.ymax = MAX(y[i], range.ymax);
+		const int size = (previousSize + 1) / 2;
+
+		minLevels.emplace_back(size);
+		maxLevels.emplace_back(size);
+
+		std::vector<float>& mins = minLevels.back();
+		std::vector<float>& maxs = maxLevels.back();
+
+		for (int i = 0; i < size; i++)
+		{
+			const int second = MIN(2 * i + 1, previousSize - 1);
+
+			mins[i] = MIN(previousMin[2 * i], previousMin[second]);
+			maxs[i] = MAX(previousMax[2 * i], previousMax[second]);
+		}
+
+		previousMin = mins.data();
+		previousMax = maxs.data();
+		previousSize = size;
 	}
 	
 	//range.print();
@@ -482,6 +562,94 @@ XYRange XYLine::getBounds()
 	return range;
 }
 
+void XYLine::getVisiblePoints(float xmin, float xmax, int& start, int& end) const
+{
+	start = 0;
+	end = numPoints;
+
+	if (!xIsSorted)
+		return;
+
+	start = int(std::lower_bound(xData, xData + numPoints, xmin) - xData) - 1;
+	end = int(std::upper_bound(xData, xData + numPoints, xmax) - xData) + 1;
+
+	start = MAX(start, 0);
+	end = MIN(end, numPoints);
+}
+
+void XYLine::drawDecimated(Graphics& g, XYRange& range, int start, int end, int plotWidth, int plotHeight)
+{
+	float yrange = range.ymax - range.ymin;
+	float xrange = range.xmax - range.xmin;
+
+	// coarsest level whose blocks are no wider than a pixel column
+	const int pointsPerColumn = (end - start) / plotWidth;
+	int level = 0;
+
+	while (level < int(minLevels.size()) && (2 << level) <= pointsPerColumn)
+		level++;
+
+	const int blockSize = 1 << level;
+	const float* mins = level == 0 ? yData : minLevels[level - 1].data();
+	const float* maxs = level == 0 ? yData : maxLevels[level - 1].data();
+
+	columnX.clear();
+	columnMin.clear();
+	columnMax.clear();
+
+	int currentColumn = 0;
+
+	for (int block = start / blockSize; block <= (end - 1) / blockSize; block++)
+	{
+		const int column = int(floor((xData[block * blockSize] - range.xmin) / xrange * plotWidth));
+
+		if (columnX.empty() || column != currentColumn)
+		{
+			columnX.push_back(float(column));
+			columnMin.push_back(mins[block]);
+			columnMax.push_back(maxs[block]);
+			currentColumn = column;
+		}
+		else
+		{
+			columnMin.back() = MIN(columnMin.back(), mins[block]);
+			columnMax.back() = MAX(columnMax.back(), maxs[block]);
+		}
+	}
+
+	auto toPixels = [&](float value) { return plotHeight - (value - range.ymin) / yrange * plotHeight; };
+
+	Path path;
+
+	if (type == PlotType::LINE)
+	{
+		path.startNewSubPath(columnX[0], toPixels(columnMin[0]));
+		path.lineTo(columnX[0], toPixels(columnMax[0]));
+
+		for (size_t i = 1; i < columnX.size(); i++)
+		{
+			path.lineTo(columnX[i], toPixels(columnMin[i]));
+			path.lineTo(columnX[i], toPixels(columnMax[i]));
+		}
+
+		g.strokePath(path, PathStrokeType(width));
+	}
+	else // FILLED: every column covers the span between zero and its extremes
+	{
+		path.startNewSubPath(columnX[0], toPixels(MAX(columnMax[0], 0.0f)));
+
+		for (size_t i = 1; i < columnX.size(); i++)
+			path.lineTo(columnX[i], toPixels(MAX(columnMax[i], 0.0f)));
+
+		for (int i = int(columnX.size()) - 1; i >= 0; i--)
+			path.lineTo(columnX[i], toPixels(MIN(columnMin[i], 0.0f)));
+
+		path.closeSubPath();
+
+		g.fillPath(path);
+	}
+}
+
 void XYLine::draw(Graphics &g, XYRange& range, int plotWidth, int plotHeight)
 {
 	
@@ -493,22 +661,36 @@ void XYLine::draw(Graphics &g, XYRange& range, int plotWidth, int plotHeight)
 
 	g.setColour(colour.withAlpha(opacity));
 
+	if (numPoints == 0 || plotWidth <= 0)
+		return;
+
+	int start, end;
+
+	if (type == PlotType::BAR)
+		getVisiblePoints(range.xmin - width / 2, range.xmax + width / 2, start, end);
+	else
+		getVisiblePoints(range.xmin, range.xmax, start, end);
+
+	if ((type == PlotType::LINE || type == PlotType::FILLED)
+		&& minLevels.size() > 0 && end - start > 2 * plotWidth)
+	{
+		drawDecimated(g, range, start, end, plotWidth, plotHeight);
+		return;
+	}
+
 	if (type == PlotType::LINE)
 	{
-		for (int i = 1; i < x.size(); i++)
+		for (int i = start + 1; i < end; i++)
 		{
-			float x_start = (x[i - 1] - range.xmin) / xrange;
-			float x_end = (x[i] - range.xmin) / xrange;
+			float x_start = (xData[i - 1] - range.xmin) / xrange;
+			float x_end = (xData[i] - range.xmin) / xrange;
 
 			if ((x_start < 0 && x_end < 0) ||
 				(x_start > 1 && x_end > 1))
 				continue;
 
-			if (i >= y.size())
-				continue;
-
-			float y_start = (y[i - 1] - range.ymin) / yrange;
-			float y_end = (y[i] - range.ymin) / yrange;
+			float y_start = (yData[i - 1] - range.ymin) / yrange;
+			float y_end = (yData[i] - range.ymin) / yrange;
 
 			if ((y_start < 0 && y_end < 0) ||
 				(y_start > 1 && y_end > 1))
@@ -549,18 +731,15 @@ void XYLine::draw(Graphics &g, XYRange& range, int plotWidth, int plotHeight)
 	if (type == PlotType::SCATTER)
 	{
 
-		for (int i = 0; i < x.size(); i++)
+		for (int i = start; i < end; i++)
 		{
-			float x_start = (x[i] - range.xmin) / xrange;
+			float x_start = (xData[i] - range.xmin) / xrange;
 
 			if ((x_start < 0) ||
 				(x_start > 1))
 				continue;
 
-			if (i >= y.size())
-				continue;
-
-			float y_start = (y[i] - range.ymin) / yrange;
+			float y_start = (yData[i] - range.ymin) / yrange;
 
 			if ((y_start < 0) ||
 				(y_start > 1))
@@ -590,7 +769,7 @@ void XYLine::draw(Graphics &g, XYRange& range, int plotWidth, int plotHeight)
 	{
 		Path path;
 
-		float x_start = (x[0] - range.xmin) / xrange;
+		float x_start = (xData[start] - range.xmin) / xrange;
 		float y_start = (0 - range.ymin) / yrange;
 
 		if (true)
@@ -605,14 +784,12 @@ void XYLine::draw(Graphics &g, XYRange& range, int plotWidth, int plotHeight)
 
 		path.startNewSubPath(x_start, y_start);
 
-		for (int i = 0; i < x.size(); i++)
+		for (int i = start; i < end; i++)
 		{
-			x_start = (x[i] - range.xmin) / xrange;
+			x_start = (xData[i] - range.xmin) / xrange;
 
-			if (i >= y.size())
-				continue;
 
-			y_start = (y[i] - range.ymin) / yrange;
+			y_start = (yData[i] - range.ymin) / yrange;
 
 			if (true)
 				x_start = x_start * plotWidth;
@@ -654,16 +831,14 @@ void XYLine::draw(Graphics &g, XYRange& range, int plotWidth, int plotHeight)
 		//else
 		//	y0 = y0 * plotHeight;
 
-		for (int i = 0; i < x.size(); i++)
+		for (int i = start; i < end; i++)
 		{
-			float x_start = (x[i] - range.xmin) / xrange;
+			float x_start = (xData[i] - range.xmin) / xrange;
 
-			if (i >= y.size())
-				continue;
 
-			float y_start = (y[i] - range.ymin) / yrange;
+			float y_start = (yData[i] - range.ymin) / yrange;
 
-			float barHeight = y[i] / yrange * plotHeight;
+			float barHeight = yData[i] / yrange * plotHeight;
 
 			if (true)
 				x_start = x_start * plotWidth;
@@ -675,7 +850,7 @@ void XYLine::draw(Graphics &g, XYRange& range, int plotWidth, int plotHeight)
 			//else
 			//	y_start = y_start * plotHeight;
 
-			if (y[i] > 0)
+			if (yData[i] > 0)
 			{
 				g.fillRect(x_start - barWidth / 2,
 					y_start,
@@ -59,15 +59,25 @@ struct PLUGIN_API XYRange
 /** 
 
 	Represents a line on a 2D plot
+
+	If the x values are in ascending order, only the points within
+	the displayed range are drawn. Long lines also keep the min/max
+	of y over blocks of 2, 4, 8... points, and are drawn with one
+	min/max pair per pixel column, so the cost of a redraw depends
+	on the width of the plot rather than on the number of points.
 	
 */
 class XYLine
 {
 public:
 
-	/** Creates a line from vectors of x and y values */
+	/** Creates a line that owns its x and y values */
 	XYLine(std::vector<float> x, std::vector<float> y);
 
+	/** Creates a line that refers to x and y values owned by the caller
+	    (they must remain valid for the lifetime of the line) */
+	XYLine(const float* x, const float* y, int numPoints);
+
 	/** Sets the colour of the line*/
 	void setColour(Colour c);
 
@@ -87,20 +97,44 @@ public:
 	    and only display points between [xmin and xmax] */
 	void draw(Graphics &g, XYRange& range, int width, int height);
 
-	/** The x values */
+	/** The x values (empty if the line refers to external data) */
 	std::vector<float> x;
 
-	/** The x values */
+	/** The y values (empty if the line refers to external data) */
 	std::vector<float> y;
 
 private:
 
+	/** Computes the bounds and the min/max levels */
+	void initialise();
+
+	/** Finds the points that fall within [xmin, xmax], plus one on either side */
+	void getVisiblePoints(float xmin, float xmax, int& start, int& end) const;
+
+	/** Draws points [start, end) of a line or filled area with one min/max pair per pixel column */
+	void drawDecimated(Graphics& g, XYRange& range, int start, int end, int plotWidth, int plotHeight);
+
+	/** The values being drawn (either x/y above, or external data) */
+	const float* xData;
+	const float* yData;
+	int numPoints;
+	bool xIsSorted;
+
+	/** Level k holds the y min/max of consecutive blocks of 2^(k+1) points */
+	std::vector<std::vector<float>> minLevels;
+	std::vector<std::vector<float>> maxLevels;
+
+	/** Per-column values used while drawing */
+	std::vector<float> columnX, columnMin, columnMax;
+
 	/** The parameters of this line */
 	Colour colour;
 	float width;
 	PlotType type;
 	float opacity;
 	XYRange range;
+
+	JUCE_DECLARE_NON_COPYABLE(XYLine);
 };
 
 
@@ -300,7 +334,7 @@ public:
 	/** Destructor */
     ~InteractivePlot() { }
 
-	/** Adds a line based on X and Y values */
+	/** Adds a line based on X and Y values (pass them with std::move to avoid a copy) */
 	void plot(std::vector<float> x, 
 			  std::vector<float> y, 
 			  Colour c = Colours::white,
@@ -308,6 +342,16 @@ public:
 			  float opacity = 1.0f,
 			  PlotType type = PlotType::LINE);
 
+	/** Adds a line that refers to existing X and Y values without copying them.
+	    The data must remain valid (and unchanged) until the plot is cleared. */
+	void plot(const float* x,
+			  const float* y,
+			  int numPoints,
+			  Colour c = Colours::white,
+			  float width = 1.0f,
+			  float opacity = 1.0f,
+			  PlotType type = PlotType::LINE);
+
 	/** Clears all lines from the plot */
 	void clear();
 
@@ -25,15 +25,23 @@
 
 void Visualizer::startCallbacks()
 {
-	startTimer(1/float(refreshRate)*1000.0f);
+	FrameScheduler::getInstance()->addClient(this, refreshRate);
 }
 
 void Visualizer::stopCallbacks()
 {
+	FrameScheduler::getInstance()->removeClient(this);
+
+	// sub-classes may still drive the timer themselves
 	stopTimer();
 }
 
 void Visualizer::timerCallback()
 {
 	refresh();
-}
\ No newline at end of file
+}
+
+void Visualizer::renderFrame()
+{
+	refresh();
+}
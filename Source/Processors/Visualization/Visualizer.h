@@ -26,6 +26,7 @@
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../PluginManager/OpenEphysPlugin.h"
+#include "FrameScheduler.h"
 
 /**
 
@@ -39,7 +40,8 @@
 */
 
 class PLUGIN_API Visualizer : public Component,
-                              public Timer
+                              public Timer,
+                              public FrameScheduler::Client
 
 {
 public:
@@ -100,7 +102,8 @@ public:
     //                     OTHER METHODS
     // ------------------------------------------------------------
 
-    /** Starts animation callbacks at refreshRate Hz. */
+    /** Starts animation callbacks at (up to) refreshRate Hz, driven
+        by the shared FrameScheduler. */
 	void startCallbacks();
 
     /** Stops animation callbacks. */
@@ -109,6 +112,9 @@ public:
     /** Calls refresh(). */
 	void timerCallback();
 
+    /** Calls refresh() (called by the FrameScheduler). */
+	void renderFrame() override;
+
 };
 
 
@@ -541,8 +541,7 @@ void ControlPanel::startAcquisition(bool recordingShouldAlsoStart)
             clock->start(); // starts the clock
             audioEditor->disable();
 
-            stopTimer();
-            startTimer(250); // refresh every 250 ms
+            FrameScheduler::getInstance()->addClient(this, 4.0f, false); // refresh every 250 ms
 
             recordSelector->setEnabled(false); // why is this outside the "if" statement?
             recordOptionsButton->setEnabled(false);
@@ -570,6 +569,8 @@ void ControlPanel::stopAcquisition()
     clock->stop();
     audioEditor->enable();
 
+    FrameScheduler::getInstance()->removeClient(this);
+
     stopTimer();
     startTimer(60000); // back to refresh every minute
     
@@ -599,6 +600,8 @@ void ControlPanel::updateRecordEngineList()
 	{
 		Plugin::RecordEngineInfo info;
 		info = AccessClass::getPluginManager()->getRecordEngineInfo(i);
+		if (info.creator == nullptr)
+			continue;
 		recordSelector->addItem(info.name, id++);
         LOGD("Adding Record Engine: ", info.name);
 		recordEngines.add(info.creator());
@@ -1074,6 +1077,7 @@ void ControlPanel::disableCallbacks()
         
         LOGD("Updating control panel.");
         refreshMeters();
+        FrameScheduler::getInstance()->removeClient(this);
         stopTimer();
         startTimer(60000); // back to refresh every 10 seconds
 
@@ -1092,6 +1096,11 @@ void ControlPanel::timerCallback()
     refreshMeters();
 }
 
+void ControlPanel::renderFrame()
+{
+    refreshMeters();
+}
+
 void ControlPanel::refreshMeters()
 {
     if (playButton->getToggleState())
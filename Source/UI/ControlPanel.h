@@ -34,6 +34,7 @@
 #include "../AccessClass.h"
 #include "../Processors/Editors/GenericEditor.h" // for UtilityButton
 #include "FilenameConfigWindow.h"
+#include "../Processors/Visualization/FrameScheduler.h"
 #include <queue>
 
 /** 
@@ -330,6 +331,7 @@ class UtilityButton;
 class ControlPanel : public Component,
     public Button::Listener,
     public Timer,
+    public FrameScheduler::Client,
     public Label::Listener,
     public ComboBox::Listener,
     public ComponentListener
@@ -518,6 +520,9 @@ private:
 
     void timerCallback();
 
+    /** Refreshes the meters while acquisition is running*/
+    void renderFrame() override;
+
     /** Updates the values displayed by the CPUMeter and DiskSpaceMeter.*/
     void refreshMeters();
 
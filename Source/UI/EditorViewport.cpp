@@ -63,10 +63,14 @@ EditorViewport::EditorViewport(SignalChainTabComponent* s_)
     editorNamingLabel.setColour(Label::textColourId, Colours::white);
     editorNamingLabel.addListener(this);
 
+    configWriter = std::make_unique<DeferredConfigWriter>([this] { return createSettingsXml(); });
+
 }
 
 EditorViewport::~EditorViewport()
 {
+    configWriter.reset();
+
     copyBuffer.clear();
 }
 
@@ -1386,6 +1390,9 @@ const String EditorViewport::saveState(File fileToUse, String* xmlText)
 
     String error;
 
+    // a direct save supersedes a pending background save of the same file
+    configWriter->cancelWrite(fileToUse);
+
     currentFile = fileToUse;
     
     std::unique_ptr<XmlElement> xml = createSettingsXml();
@@ -1403,6 +1410,11 @@ const String EditorViewport::saveState(File fileToUse, String* xmlText)
     
 }
     
+void EditorViewport::saveStateInBackground(File fileToUse, int delayMs)
+{
+    configWriter->scheduleWrite(fileToUse, delayMs);
+}
+
 std::unique_ptr<XmlElement> EditorViewport::createSettingsXml()
 {
     
@@ -32,6 +32,7 @@
 #include "../Processors/Merger/MergerEditor.h"
 
 #include "../Processors/PluginManager/OpenEphysPlugin.h"
+#include "../Utils/DeferredConfigWriter.h"
 
 #include "ControlPanel.h"
 #include "UIComponent.h"
@@ -134,6 +135,10 @@ public:
 
 	/** Save the current configuration as an XML file. Reference wrapper*/
 	const String saveState(File filename, String& xmlText);
+
+    /** Save the current configuration shortly, on a background thread. Calls
+        made within delayMs of each other result in a single write. */
+    void saveStateInBackground(File filename, int delayMs = 1000);
     
     /** Save the current configuration as an XML file. Reference wrapper*/
     std::unique_ptr<XmlElement> createSettingsXml();
@@ -252,6 +257,8 @@ private:
 
     OwnedArray<AddProcessor> orphanedActions;
 
+    std::unique_ptr<DeferredConfigWriter> configWriter;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EditorViewport);
 
 };
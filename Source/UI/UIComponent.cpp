@@ -106,6 +106,9 @@
 
 	processorGraph->updateBufferSize(); // needs to happen after processorGraph gets the right pointers
 
+	if (CoreServices::isHeadless())
+		return;
+
 #if JUCE_MAC
 	MenuBarModel::setMacMainMenu(this);
 	mainWindow->setMenuBar(0);
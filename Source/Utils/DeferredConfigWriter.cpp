@@ -0,0 +1,107 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "DeferredConfigWriter.h"
+
+#include "Utils.h"
+
+DeferredConfigWriter::DeferredConfigWriter(std::function<std::unique_ptr<XmlElement>()> createXml_)
+    : Thread("Config Writer"),
+      createXml(createXml_)
+{
+    startThread();
+}
+
+DeferredConfigWriter::~DeferredConfigWriter()
+{
+    stopTimer();
+
+    signalThreadShouldExit();
+    notify();
+    stopThread(5000);
+}
+
+void DeferredConfigWriter::scheduleWrite(const File& file, int delayMs)
+{
+    scheduledFile = file;
+    startTimer(delayMs);
+}
+
+void DeferredConfigWriter::cancelWrite(const File& file)
+{
+    if (isTimerRunning() && scheduledFile == file)
+        stopTimer();
+
+    {
+        const ScopedLock lock(queueLock);
+
+        if (queuedFile == file)
+            queuedXml.reset();
+    }
+
+    // wait for a write in progress
+    const ScopedLock lock(writeLock);
+}
+
+void DeferredConfigWriter::timerCallback()
+{
+    stopTimer();
+
+    std::unique_ptr<XmlElement> xml = createXml();
+
+    {
+        const ScopedLock lock(queueLock);
+
+        queuedXml = std::move(xml);
+        queuedFile = scheduledFile;
+    }
+
+    notify();
+}
+
+void DeferredConfigWriter::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(-1);
+
+        const ScopedLock writeGuard(writeLock);
+
+        std::unique_ptr<XmlElement> xml;
+        File file;
+
+        {
+            const ScopedLock lock(queueLock);
+
+            xml = std::move(queuedXml);
+            file = queuedFile;
+        }
+
+        if (xml == nullptr || threadShouldExit())
+            continue;
+
+        // XmlElement::writeTo() writes to a temporary file and then replaces the target
+        if (!xml->writeTo(file))
+            LOGE("Couldn't write ", file.getFullPathName());
+    }
+}
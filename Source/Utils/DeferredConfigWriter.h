@@ -0,0 +1,79 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __DEFERREDCONFIGWRITER_H_8A4C1E37__
+#define __DEFERREDCONFIGWRITER_H_8A4C1E37__
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+
+#include <functional>
+
+/**
+    Writes settings files shortly after they are requested, on a background thread.
+
+    Requests made within the delay of each other are combined, so a burst of
+    changes results in a single write. The settings are captured on the message
+    thread when the delay expires, and written to disk on the writer's thread.
+
+    @see EditorViewport::saveStateInBackground
+*/
+class DeferredConfigWriter : private Timer,
+                             private Thread
+{
+public:
+
+    /** Constructor -- createXml is called on the message thread to capture the settings */
+    explicit DeferredConfigWriter(std::function<std::unique_ptr<XmlElement>()> createXml);
+
+    /** Destructor -- pending writes are discarded */
+    ~DeferredConfigWriter();
+
+    /** Schedules a write of the settings to a file after a delay, replacing any pending write */
+    void scheduleWrite(const File& file, int delayMs);
+
+    /** Cancels pending writes of a file and waits for one in progress to finish,
+        so that the file can be written directly. */
+    void cancelWrite(const File& file);
+
+private:
+
+    /** Captures the settings once the delay has expired */
+    void timerCallback() override;
+
+    /** Writes captured settings */
+    void run() override;
+
+    std::function<std::unique_ptr<XmlElement>()> createXml;
+
+    File scheduledFile;
+
+    CriticalSection queueLock;
+    std::unique_ptr<XmlElement> queuedXml;
+    File queuedFile;
+
+    CriticalSection writeLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeferredConfigWriter);
+};
+
+#endif  // __DEFERREDCONFIGWRITER_H_8A4C1E37__
@@ -0,0 +1,101 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "EventStream.h"
+
+#include <chrono>
+
+EventStream::EventStream(size_t capacity_)
+    : capacity(capacity_),
+      nextId(1),
+      closed(false)
+{
+}
+
+uint64_t EventStream::publish(const std::string& type, const std::string& data)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const uint64_t id = nextId++;
+
+    // payloads are single-line JSON, so one data field is enough
+    entries.push_back({ id, "id: " + std::to_string(id) + "\nevent: " + type + "\ndata: " + data + "\n\n" });
+
+    if (entries.size() > capacity)
+        entries.pop_front();
+
+    eventPublished.notify_all();
+
+    return id;
+}
+
+uint64_t EventStream::getLatestId()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return nextId - 1;
+}
+
+bool EventStream::waitForEvents(uint64_t& lastId, std::string& output, int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    eventPublished.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                            [&] { return closed || nextId - 1 > lastId; });
+
+    if (closed)
+        return false;
+
+    if (nextId - 1 <= lastId)
+        return true;
+
+    if (entries.empty() || entries.front().id > lastId + 1)
+    {
+        // the events this client missed have already been dropped
+        lastId = nextId - 1;
+        output += "id: " + std::to_string(lastId) + "\nevent: resync\ndata: {}\n\n";
+        return true;
+    }
+
+    for (auto it = entries.begin() + (lastId + 1 - entries.front().id); it != entries.end(); ++it)
+        output += it->text;
+
+    lastId = nextId - 1;
+
+    return true;
+}
+
+void EventStream::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    closed = true;
+    eventPublished.notify_all();
+}
+
+void EventStream::reopen()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    closed = false;
+}
@@ -0,0 +1,86 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2022 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __EVENTSTREAM_H_5B1E9C42__
+#define __EVENTSTREAM_H_5B1E9C42__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+/**
+    A queue of Server-Sent Events shared by any number of HTTP clients.
+
+    Producers publish events from any thread; each client keeps the id of
+    the last event it received and waits for newer ones. The most recent
+    events are kept in a fixed-size ring, so a client that reconnects with
+    a Last-Event-ID header can pick up where it left off. A client that has
+    fallen further behind than the ring reaches receives a "resync" event
+    instead, telling it to fetch the full state again.
+
+    @see OpenEphysHttpServer
+*/
+class EventStream
+{
+public:
+
+    /** Constructor */
+    explicit EventStream(size_t capacity = 4096);
+
+    /** Publishes an event with a JSON payload and returns its id */
+    uint64_t publish(const std::string& type, const std::string& data);
+
+    /** Returns the id of the most recently published event */
+    uint64_t getLatestId();
+
+    /** Waits up to timeoutMs for events newer than lastId and appends them
+        to output in text/event-stream format, advancing lastId. Returns
+        false once the stream has been closed. */
+    bool waitForEvents(uint64_t& lastId, std::string& output, int timeoutMs);
+
+    /** Wakes up all waiting clients and makes further waits return false */
+    void close();
+
+    /** Re-opens a stream after close() */
+    void reopen();
+
+private:
+
+    struct Entry
+    {
+        uint64_t id;
+        std::string text;
+    };
+
+    std::deque<Entry> entries;
+    size_t capacity;
+    uint64_t nextId;
+    bool closed;
+
+    std::mutex mutex;
+    std::condition_variable eventPublished;
+};
+
+#endif  // __EVENTSTREAM_H_5B1E9C42__
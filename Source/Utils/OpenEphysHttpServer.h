@@ -26,6 +26,7 @@
 
 #include "../Processors/Parameter/Parameter.h"
 #include "../Processors/GenericProcessor/GenericProcessor.h"
+#include "../Processors/RecordNode/RecordNode.h"
 
 #include <sstream>
 #include "httplib.h"
@@ -37,11 +38,16 @@
 #include "../UI/EditorViewport.h"
 
 #include "Utils.h"
+#include "EventStream.h"
 
 using json = nlohmann::json;
 
 #define PORT 37497
 
+/* Each open event stream holds a worker thread, so they get their own share of the pool */
+#define MAX_EVENT_STREAMS 4
+#define NUM_CONTROL_WORKERS 8
+
 
 /**
  * HTTP server thread for controlling Processor Parameters via an HTTP API. This starts an HTTP server on port 37497
@@ -83,28 +89,268 @@ using json = nlohmann::json;
  * - GET /api/processors/<processor_id>/streams/<stream_index>/parameters
  * - GET /api/processors/<processor_id>/streams/<stream_index>/parameters/<parameter_name>
  * - PUT /api/processors/<processor_id>/streams/<stream_index>/parameters/<parameter_name>
+ * - PUT /api/parameters :
+ *          sets many parameters at once, e.g.:
+ *          {"updates" : [{"processor" : 101, "stream" : 0, "parameter" : "threshold", "value" : -50}, ...]}
+ *          ("stream" is omitted for global parameters). The body may also be MessagePack-encoded
+ *          (Content-Type: application/msgpack), in which case so is the response. Every update is
+ *          resolved and its value checked against the parameter's type and range first; if any fails,
+ *          none is applied and "errors" lists each failure by index. Otherwise all are applied in a
+ *          single pass on the message thread, and "results" holds each parameter's resulting value
+ *          (a processor can still restore a previous value it does not accept).
  * - PUT /api/processors/<processor_id>/config
  * - PUT /api/processors/add
  * - PUT /api/processors/delete
  * - PUT /api/window
  *
+ * - GET /api/events :
+ *          a Server-Sent Events (text/event-stream) stream of changes, so clients don't need to poll the
+ *          endpoints above. Each event has an "id", an event type and a JSON payload:
+ *          - status : the GUI's mode changed, e.g. {"mode" : "RECORD"} (also sent when a client connects)
+ *          - parameter : a parameter changed, e.g. {"processor" : 101, "stream" : 0, "name" : "threshold", ...}
+ *            ("stream" is null for global parameters)
+ *          - record_buffer : the fill level of a Record Node's buffer changed by at least 1%
+ *          - disk_space : the free space in a Record Node's directory changed by at least 16 MB
+ *          - latency : the mean processing latency of a stream changed by at least 0.1 ms
+ *          - resync : events were missed, so the client should fetch the full state again
+ *          Clients that reconnect with a Last-Event-ID header receive the events they missed. At most
+ *          MAX_EVENT_STREAMS streams can be open at once; further clients receive a 503 response.
+ *
  * All endpoints are JSON endpoints. The PUT endpoint expects two parameters: "channel" (an integer), and "value",
  * which should have a type matching the type of the parameter.
  */
-class OpenEphysHttpServer : juce::Thread {
+class OpenEphysHttpServer : juce::Thread, public Parameter::Listener {
 public:
 
-    explicit OpenEphysHttpServer(ProcessorGraph* graph) :
+    explicit OpenEphysHttpServer(ProcessorGraph* graph, int port = PORT) :
+        juce::Thread("HttpServer"),
         graph_(graph),
-        juce::Thread("HttpServer") {}
+        port_(port),
+        status_monitor_(*this) {}
+
+    ~OpenEphysHttpServer() {
+        Parameter::removeListener(this);
+        status_monitor_.stopThread(1000);
+    }
 
     void run() override {
         
+        svr_->Get("/api/events", [this](const httplib::Request& req, httplib::Response& res) {
+            if (++open_streams_ > MAX_EVENT_STREAMS) {
+                --open_streams_;
+                json ret;
+                ret["error"] = "Too many open event streams.";
+                res.status = 503;
+                res.set_header("Retry-After", "5");
+                res.set_content(ret.dump(), "application/json");
+                return;
+            }
+
+            const uint64_t latest_id = events_.getLatestId();
+            uint64_t last_id = latest_id;
+
+            std::string initial = "retry: 1000\n\n";
+
+            if (req.has_header("Last-Event-ID")) {
+                last_id = (uint64_t) String(req.get_header_value("Last-Event-ID")).getLargeIntValue();
+
+                if (last_id > latest_id) {
+                    // the id is from an earlier session
+                    last_id = latest_id;
+                    initial += "event: resync\ndata: {}\n\n";
+                }
+            }
+            else {
+                json status;
+                status_to_json(graph_, &status);
+                initial += "event: status\ndata: " + status.dump() + "\n\n";
+            }
+
+            res.set_header("Cache-Control", "no-cache");
+            res.set_chunked_content_provider("text/event-stream",
+                [this, last_id, initial](size_t, httplib::DataSink& sink) mutable {
+                    std::string chunk;
+                    chunk.swap(initial);
+
+                    if (!events_.waitForEvents(last_id, chunk, chunk.empty() ? 15000 : 0)) {
+                        sink.done();
+                        return true;
+                    }
+
+                    if (chunk.empty())
+                        chunk = ": keep-alive\n\n";
+
+                    return sink.write(chunk.data(), chunk.size());
+                },
+                [this](bool) { --open_streams_; });
+            });
+
+
         svr_->Get("/api/status", [this](const httplib::Request&, httplib::Response& res) {
             json ret;
             status_to_json(graph_, &ret);
             res.set_content(ret.dump(), "application/json");
             });
+
+        // Registered before the other PUT routes, which are matched in order
+        svr_->Put("/api/parameters", [this](const httplib::Request& req, httplib::Response& res) {
+            const bool is_msgpack = req.get_header_value("Content-Type").find("msgpack") != std::string::npos;
+            const bool reply_msgpack = is_msgpack || req.get_header_value("Accept").find("msgpack") != std::string::npos;
+
+            auto reply = [&](int status, const json& body) {
+                res.status = status;
+
+                if (reply_msgpack) {
+                    const std::vector<uint8_t> bytes = json::to_msgpack(body);
+                    res.set_content(std::string(bytes.begin(), bytes.end()), "application/msgpack");
+                }
+                else {
+                    res.set_content(body.dump(), "application/json");
+                }
+            };
+
+            json request_json;
+            try {
+                request_json = is_msgpack ? json::from_msgpack(req.body) : json::parse(req.body);
+            }
+            catch (json::exception& e) {
+                reply(400, { {"error", e.what()} });
+                return;
+            }
+
+            if (request_json.is_object() && request_json.contains("updates")) {
+                json updates = std::move(request_json["updates"]);
+                request_json = std::move(updates);
+            }
+
+            if (!request_json.is_array()) {
+                reply(400, { {"error", "Request must contain an array of updates."} });
+                return;
+            }
+
+            /* Values are converted before taking the lock */
+            std::vector<var> values;
+            values.reserve(request_json.size());
+
+            for (size_t i = 0; i < request_json.size(); i++) {
+                const json& update = request_json[i];
+
+                if (!update.is_object() || !update.contains("processor") || !update.contains("parameter") || !update.contains("value")) {
+                    reply(400, { {"error", "Each update must contain processor, parameter and value."}, {"index", i} });
+                    return;
+                }
+
+                try {
+                    values.push_back(json_to_var(update["value"]));
+                }
+                catch (json::exception& e) {
+                    reply(400, { {"error", e.what()}, {"index", i} });
+                    return;
+                }
+
+                if (values.back().isUndefined()) {
+                    reply(400, { {"error", "Value could not be converted."}, {"index", i} });
+                    return;
+                }
+            }
+
+            const int64 start_ticks = Time::getHighResolutionTicks();
+
+            std::vector<json> errors;
+            int error_status = 400;
+            json results = json::array();
+
+            {
+                const MessageManagerLock mml;
+
+                std::map<int, GenericProcessor*> processors;
+                for (auto processor : graph_->getListOfProcessors())
+                    processors[processor->getNodeId()] = processor;
+
+                std::vector<Parameter*> parameters;
+                parameters.reserve(request_json.size());
+
+                for (size_t i = 0; i < request_json.size(); i++) {
+                    const json& update = request_json[i];
+                    Parameter* parameter = nullptr;
+
+                    try {
+                        auto it = processors.find(update["processor"].get<int>());
+
+                        if (it == processors.end()) {
+                            errors.push_back({ {"error", "Processor not found."}, {"index", i} });
+                            error_status = 404;
+                            continue;
+                        }
+
+                        GenericProcessor* processor = it->second;
+                        const std::string name = update["parameter"].get<std::string>();
+
+                        if (update.contains("stream")) {
+                            const int stream_index = update["stream"].get<int>();
+                            const auto streams = processor->getDataStreams();
+
+                            if (stream_index >= 0 && stream_index < streams.size())
+                                parameter = find_parameter(processor, streams[stream_index]->getStreamId(), name);
+                        }
+                        else {
+                            parameter = find_parameter(processor, name);
+                        }
+                    }
+                    catch (json::exception& e) {
+                        errors.push_back({ {"error", e.what()}, {"index", i} });
+                        continue;
+                    }
+
+                    if (parameter == nullptr) {
+                        errors.push_back({ {"error", "Parameter not found."}, {"index", i} });
+                        error_status = 404;
+                        continue;
+                    }
+
+                    const std::string error = check_value(parameter, values[i]);
+
+                    if (!error.empty()) {
+                        errors.push_back({ {"error", error}, {"index", i} });
+                        continue;
+                    }
+
+                    parameters.push_back(parameter);
+                }
+
+                if (errors.empty()) {
+                    /* Each editor is refreshed once, after all of its parameters have changed */
+                    for (auto& entry : processors)
+                        entry.second->setEditorUpdatesDeferred(true);
+
+                    for (size_t i = 0; i < parameters.size(); i++)
+                        parameters[i]->setNextValue(values[i]);
+
+                    for (auto& entry : processors)
+                        entry.second->setEditorUpdatesDeferred(false);
+
+                    for (size_t i = 0; i < parameters.size(); i++)
+                        results.push_back({ {"index", i}, {"value", parameters[i]->getValueAsString().toStdString()} });
+                }
+            }
+
+            if (!errors.empty()) {
+                json ret;
+                ret["errors"] = errors;
+                reply(error_status, ret);
+                return;
+            }
+
+            const double elapsed = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start_ticks);
+
+            LOGD("Applied ", values.size(), " parameter updates in ", elapsed * 1000.0, " ms");
+
+            json ret;
+            ret["applied"] = values.size();
+            ret["results"] = results;
+            ret["elapsed_us"] = int64(elapsed * 1e6);
+            reply(200, ret);
+            });
         
         svr_->Put("/api/status", [this](const httplib::Request& req, httplib::Response& res) 
         {
@@ -881,18 +1127,37 @@ public:
 
             });
                    
-        LOGC("Beginning HTTP server on port ", PORT);
-        svr_->listen("0.0.0.0", PORT);
+        LOGC("Beginning HTTP server on port ", port_);
+        svr_->listen("0.0.0.0", port_);
     }
 
     void start() {
         if (!svr_) {
             svr_ = std::make_unique<httplib::Server>();
+
+            // Event streams can't take all the workers from the control endpoints
+            svr_->new_task_queue = [] { return new httplib::ThreadPool(MAX_EVENT_STREAMS + NUM_CONTROL_WORKERS); };
+
+            // Clients that send many requests can keep one connection open,
+            // but an idle connection releases its worker after a few seconds
+            svr_->set_keep_alive_max_count(1000);
+            svr_->set_keep_alive_timeout(5);
         }
+
+        events_.reopen();
+        Parameter::addListener(this);
+        status_monitor_.startThread();
+
         startThread();
     }
 
     void stop() {
+        Parameter::removeListener(this);
+        status_monitor_.stopThread(1000);
+
+        // lets open event streams finish, so the server can shut down
+        events_.close();
+
         if (svr_) {
             LOGC("Shutting down HTTP server");
             svr_->stop();
@@ -900,10 +1165,160 @@ public:
         stopThread(5000);
     }
 
+    /** Publishes parameter changes to the event stream */
+    void parameterChanged(Parameter* parameter) override {
+        GenericProcessor* processor = parameter->getProcessor();
+
+        if (processor == nullptr)
+            return;
+
+        json event;
+        event["processor"] = processor->getNodeId();
+        event["stream"] = json::value_t::null;
+
+        if (parameter->getScope() != Parameter::GLOBAL_SCOPE) {
+            const uint16 streamId = parameter->getStreamId();
+            const auto streams = processor->getDataStreams();
+
+            for (int i = 0; i < streams.size(); i++) {
+                if (streams[i]->getStreamId() == streamId) {
+                    event["stream"] = i;
+                    break;
+                }
+            }
+        }
+
+        parameter_to_json(parameter, &event);
+        events_.publish("parameter", event.dump());
+    }
+
 private:
+
+    /** Samples the GUI's status in the background and publishes what changed */
+    class StatusMonitor : public juce::Thread {
+    public:
+        explicit StatusMonitor(OpenEphysHttpServer& server) :
+            juce::Thread("HttpServerStatus"),
+            server_(server) {}
+
+        void run() override {
+            while (!threadShouldExit()) {
+                server_.publish_status_changes();
+                wait(100);
+            }
+        }
+
+    private:
+        OpenEphysHttpServer& server_;
+    };
+
     std::unique_ptr<httplib::Server> svr_;
     MainWindow* main_;
     ProcessorGraph* graph_;
+    int port_;
+
+    EventStream events_;
+    StatusMonitor status_monitor_;
+    std::atomic<int> open_streams_{ 0 };
+
+    /* Last published values, only accessed by the status monitor */
+    std::string last_mode_;
+    std::map<std::string, double> last_stats_;
+    int64 next_stats_time_ = 0;
+
+    /** Called every 100 ms by the status monitor. The mode is checked every time,
+        the buffer, disk and latency statistics every 500 ms. */
+    void publish_status_changes() {
+        json status;
+        status_to_json(graph_, &status);
+
+        const std::string mode = status["mode"];
+
+        if (mode != last_mode_) {
+            last_mode_ = mode;
+            events_.publish("status", status.dump());
+        }
+
+        const int64 now = Time::currentTimeMillis();
+
+        if (now < next_stats_time_)
+            return;
+
+        next_stats_time_ = now + 500;
+
+        const bool acquiring = mode != "IDLE";
+
+        struct Sample { std::string key; std::string type; json event; double value; double threshold; };
+        std::vector<Sample> samples;
+        std::vector<std::pair<int, File>> directories;
+
+        {
+            // the graph is only walked under the lock; events are built afterwards
+            const MessageManagerLock mml(Thread::getCurrentThread());
+
+            if (!mml.lockWasGained())
+                return;
+
+            for (auto node : graph_->getRecordNodes()) {
+                directories.emplace_back(node->getNodeId(), node->getDataDirectory());
+
+                if (!acquiring)
+                    continue;
+
+                const auto streams = node->getDataStreams();
+
+                for (int i = 0; i < streams.size(); i++) {
+                    auto fill = node->fifoUsage.find(streams[i]->getStreamId());
+
+                    if (fill == node->fifoUsage.end())
+                        continue;
+
+                    samples.push_back({ "fill/" + std::to_string(node->getNodeId()) + "/" + std::to_string(i),
+                                        "record_buffer",
+                                        { {"node", node->getNodeId()}, {"stream", i}, {"fill", fill->second} },
+                                        fill->second, 0.01 });
+                }
+            }
+
+            if (acquiring) {
+                for (auto processor : graph_->getListOfProcessors()) {
+                    const auto streams = processor->getDataStreams();
+
+                    for (int i = 0; i < streams.size(); i++) {
+                        const float latency = processor->getMeanLatency(streams[i]->getStreamId());
+
+                        samples.push_back({ "latency/" + std::to_string(processor->getNodeId()) + "/" + std::to_string(i),
+                                            "latency",
+                                            { {"processor", processor->getNodeId()}, {"stream", i}, {"latency_ms", latency} },
+                                            latency, 0.1 });
+                    }
+                }
+            }
+        }
+
+        for (const auto& directory : directories) {
+            const double bytes_free = (double) directory.second.getBytesFreeOnVolume();
+            const double bytes_total = (double) directory.second.getVolumeTotalSize();
+
+            samples.push_back({ "disk/" + std::to_string(directory.first),
+                                "disk_space",
+                                { {"node", directory.first},
+                                  {"directory", directory.second.getFullPathName().toStdString()},
+                                  {"bytes_free", bytes_free},
+                                  {"fraction_free", bytes_total > 0 ? bytes_free / bytes_total : 0.0} },
+                                bytes_free, 16.0 * 1024 * 1024 });
+        }
+
+        for (auto& sample : samples) {
+            auto last = last_stats_.find(sample.key);
+
+            if (last != last_stats_.end() && std::abs(sample.value - last->second) < sample.threshold)
+                continue;
+
+            last_stats_[sample.key] = sample.value;
+            events_.publish(sample.type, sample.event.dump());
+        }
+    }
 
     var json_to_var(const json& value) {
         if (value.is_number_integer()) {
@@ -1087,6 +1502,56 @@ private:
         return nullptr;
     }
 
+    /** Returns why setNextValue() would ignore or clamp a value, or an empty string if it would
+        accept it. Integer values for float parameters are converted in place. */
+    static std::string check_value(Parameter* parameter, var& value)
+    {
+        if (dynamic_cast<BooleanParameter*>(parameter) != nullptr) {
+            if (!value.isBool())
+                return "Value must be a boolean.";
+        }
+        else if (auto p = dynamic_cast<IntParameter*>(parameter)) {
+            if (!value.isInt() && !value.isInt64())
+                return "Value must be an integer.";
+
+            if ((int64) value < p->getMinValue() || (int64) value > p->getMaxValue())
+                return "Value must be between " + std::to_string(p->getMinValue()) + " and " + std::to_string(p->getMaxValue()) + ".";
+        }
+        else if (auto p = dynamic_cast<FloatParameter*>(parameter)) {
+            if (!value.isDouble() && !value.isInt() && !value.isInt64())
+                return "Value must be a number.";
+
+            value = (double) value;
+
+            if ((double) value < p->getMinValue() || (double) value > p->getMaxValue())
+                return "Value must be between " + String(p->getMinValue()).toStdString() + " and " + String(p->getMaxValue()).toStdString() + ".";
+        }
+        else if (auto p = dynamic_cast<CategoricalParameter*>(parameter)) {
+            if (!value.isInt() && !value.isInt64())
+                return "Value must be a category index.";
+
+            if ((int64) value < 0 || (int64) value >= p->getCategories().size())
+                return "Value must be between 0 and " + std::to_string(p->getCategories().size() - 1) + ".";
+        }
+        else if (dynamic_cast<StringParameter*>(parameter) != nullptr) {
+            if (!value.isString())
+                return "Value must be a string.";
+        }
+        else if (auto p = dynamic_cast<SelectedChannelsParameter*>(parameter)) {
+            if (!value.isArray())
+                return "Value must be an array of channel indices.";
+
+            if (value.getArray()->size() > p->getMaxSelectableChannels())
+                return "At most " + std::to_string(p->getMaxSelectableChannels()) + " channels can be selected.";
+        }
+        else if (dynamic_cast<MaskChannelsParameter*>(parameter) != nullptr) {
+            if (!value.isArray())
+                return "Value must be an array of channel indices.";
+        }
+
+        return "";
+    }
+
     static inline Parameter* find_parameter(GenericProcessor* processor, const std::string& parameter_name)
     {
         Parameter* parameter = processor->getParameter(juce::String(parameter_name));